@@ -0,0 +1,82 @@
+# Profile guided optimization workflow, run by the pgo_report target:
+#   1. baseline build and benchmark
+#   2. instrumented build and training run on synthetic embeddings
+#   3. optimized rebuild with the profiles and the same benchmark
+#   4. before/after report
+#
+# cmake -DSOURCE_DIR=<repo> -DWORK_DIR=<dir> -DGENERATOR=<generator> -DCXX_COMPILER=<path> -DCXX_COMPILER_ID=<id>
+#       [-DPGO_LTO=ON] [-DPGO_NATIVE_ARCH=ON] [-DPGO_MULTIVERSION=ON] [-DBENCHMARK_ARGS="--n 10000 ..."]
+#       [-DTRAINING_POINTS=20000] -P PGOWorkflow.cmake
+cmake_minimum_required(VERSION 3.16)
+
+foreach(required SOURCE_DIR WORK_DIR GENERATOR CXX_COMPILER)
+    if(NOT DEFINED ${required})
+        message(FATAL_ERROR "PGOWorkflow.cmake: ${required} is not set")
+    endif()
+endforeach()
+if(NOT DEFINED BENCHMARK_ARGS)
+    set(BENCHMARK_ARGS "--n 10000,100000 --d 2,64,384 --k 8,64 --repeats 5 --seed 7")
+endif()
+if(NOT DEFINED TRAINING_POINTS)
+    set(TRAINING_POINTS 20000)
+endif()
+separate_arguments(BENCHMARK_ARGS UNIX_COMMAND "${BENCHMARK_ARGS}")
+
+set(PROFILE_DIR ${WORK_DIR}/profiles)
+set(TRAINING_DIR ${WORK_DIR}/training)
+set(BASELINE_DIR ${WORK_DIR}/baseline)
+# gcc names the profiles after the object files, so the optimized build has to reuse the instrumented build tree
+set(OPTIMIZED_DIR ${WORK_DIR}/optimized)
+set(TARGETS CLustering BenchmarkCore GenerateEmbeddings CompareBenchmarks)
+
+function(run_step description)
+    message(STATUS "PGO: ${description}")
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "PGO: ${description} failed (${result})")
+    endif()
+endfunction()
+
+function(build_variant dir pgo)
+    set(options -DCMAKE_BUILD_TYPE=Release -DCMAKE_CXX_COMPILER=${CXX_COMPILER} -DCLUSTERING_BUILD_TESTS=OFF -DCLUSTERING_BUILD_TOOLS=OFF
+                -DCLUSTERING_BUILD_BENCHMARKS=ON -DCLUSTERING_PGO=${pgo} -DCLUSTERING_PGO_DIR=${PROFILE_DIR})
+    foreach(option LTO NATIVE_ARCH MULTIVERSION)
+        if(PGO_${option})
+            list(APPEND options -DCLUSTERING_${option}=${PGO_${option}})
+        endif()
+    endforeach()
+    run_step("configure ${dir} (CLUSTERING_PGO=${pgo})" ${CMAKE_COMMAND} -S ${SOURCE_DIR} -B ${dir} -G ${GENERATOR} ${options})
+    run_step("build ${dir}" ${CMAKE_COMMAND} --build ${dir} --target ${TARGETS})
+endfunction()
+
+file(REMOVE_RECURSE ${PROFILE_DIR} ${TRAINING_DIR})
+file(MAKE_DIRECTORY ${PROFILE_DIR} ${TRAINING_DIR})
+
+# 1. baseline
+build_variant(${BASELINE_DIR} OFF)
+run_step("baseline benchmark" ${BASELINE_DIR}/BenchmarkCore ${BENCHMARK_ARGS} --out ${WORK_DIR}/before.json --tmp ${TRAINING_DIR})
+
+# 2. training: a CLustering run on embeddings shaped like all-minilm ones, and the benchmark kernels on a small grid
+build_variant(${OPTIMIZED_DIR} GENERATE)
+run_step("generate training embeddings" ${OPTIMIZED_DIR}/GenerateEmbeddings ${TRAINING_DIR}/embeddings.npy ${TRAINING_POINTS} 384 25)
+run_step("training run: CLustering" ${OPTIMIZED_DIR}/CLustering ${TRAINING_DIR}/embeddings.npy ${TRAINING_DIR}/rowClustered.csv
+         ${TRAINING_DIR}/rowCentroids.csv 25 50)
+run_step("training run: BenchmarkCore" ${OPTIMIZED_DIR}/BenchmarkCore --n 20000 --d 2,64,384 --k 8,64 --repeats 1
+         --out ${TRAINING_DIR}/training.json --tmp ${TRAINING_DIR})
+
+if(CXX_COMPILER_ID MATCHES "Clang")
+    find_program(LLVM_PROFDATA NAMES llvm-profdata HINTS ${CXX_COMPILER}/..)
+    if(NOT LLVM_PROFDATA)
+        message(FATAL_ERROR "PGO: llvm-profdata not found, it is needed to merge Clang profiles")
+    endif()
+    file(GLOB raw_profiles ${PROFILE_DIR}/*.profraw)
+    run_step("merge profiles" ${LLVM_PROFDATA} merge -o ${PROFILE_DIR}/default.profdata ${raw_profiles})
+endif()
+
+# 3. optimized rebuild
+build_variant(${OPTIMIZED_DIR} USE)
+run_step("optimized benchmark" ${OPTIMIZED_DIR}/BenchmarkCore ${BENCHMARK_ARGS} --out ${WORK_DIR}/after.json --tmp ${TRAINING_DIR})
+
+# 4. report
+run_step("report" ${OPTIMIZED_DIR}/CompareBenchmarks ${WORK_DIR}/before.json ${WORK_DIR}/after.json ${WORK_DIR}/pgo_report.md baseline pgo)
+message(STATUS "PGO: optimized CLustering and BenchmarkCore are in ${OPTIMIZED_DIR}, report in ${WORK_DIR}/pgo_report.md")
@@ -0,0 +1,169 @@
+#include "commentstore.h"
+#include "../src/data_processing/DatasetBundle.hpp"
+#include "../src/data_processing/TimeCube.hpp"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QtConcurrent/QtConcurrent>
+#include <QDebug>
+#include <cmath>
+
+CommentStore::CommentStore(QObject *parent)
+    : QObject(parent)
+{
+    // an encoder process starts loading its model now, while the comments load
+    m_encoders = QueryEncoder::fromSettings();
+    // the processes are stopped while the application still exists, not by the static destructor
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this]() { m_encoders.clear(); });
+
+    connect(&m_watcher, &QFutureWatcher<Data>::finished, this, [this]() {
+        // the worker only fills its own copy, the shared data is swapped in on the GUI thread
+        m_data = m_watcher.result();
+        m_loaded = m_data.error.isEmpty();
+        m_loading = false;
+        emit progressChanged(100);
+        emit loaded();
+    });
+}
+
+CommentStore &CommentStore::instance()
+{
+    static CommentStore store;
+    return store;
+}
+
+void CommentStore::loadAsync()
+{
+    if (m_loaded || m_loading)
+        return;
+    m_loading = true;
+    m_watcher.setFuture(QtConcurrent::run([this]() { return load(); }));
+}
+
+CommentStore::Data CommentStore::load()
+{
+    Data data;
+
+    // the bundle lives on disk so the data can be updated without rebuilding the app
+    QSettings settings("clustering_tweets", "qt_project");
+    QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    if (!loadBundle(settings.value("data/bundle", dataDir + "/dataset.bundle").toString(), data)) {
+        qDebug() << data.error;
+        return data;
+    }
+    loadSearchIndex(data);
+
+    // written by BuildSemanticIndex from the clustering outputs
+    data.semanticSearcher->open(settings.value("semantic/index", dataDir + "/embeddings.sem").toString());
+    return data;
+}
+
+// Columns are copied out of the mapped file; texts are decoded in one call and addressed by UTF-16 offsets.
+bool CommentStore::loadBundle(const QString &path, Data &data)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        data.error = QString("Could not open the dataset bundle %1.\nBuild it with BuildDatasetBundle, "
+                             "or point data/bundle in the settings to it.").arg(QDir::toNativeSeparators(path));
+        return false;
+    }
+    QByteArray buffer;
+    const char *bytes = reinterpret_cast<const char *>(file.map(0, file.size()));
+    if (!bytes) {
+        buffer = file.readAll();
+        bytes = buffer.constData();
+    }
+    DatasetBundleView view;
+    if (!view.open(bytes, static_cast<size_t>(file.size())) || !view.verifyChecksum()) {
+        data.error = QString("The dataset bundle %1 is invalid or corrupted.\nRebuild it with BuildDatasetBundle.")
+                         .arg(QDir::toNativeSeparators(path));
+        return false;
+    }
+    emit progressChanged(10);
+
+    const int rows = static_cast<int>(view.numRows());
+    const double *utc = view.column<double>(BUNDLE_UTC);
+    const float *score = view.column<float>(BUNDLE_SCORE);
+    const float *sentiment = view.column<float>(BUNDLE_SENTIMENT);
+    const int32_t *clusterId = view.column<int32_t>(BUNDLE_CLUSTER_ID);
+    const float *distance = view.column<float>(BUNDLE_DISTANCE);
+    const float *x = view.column<float>(BUNDLE_X);
+    const float *y = view.column<float>(BUNDLE_Y);
+
+    CommentTable &table = data.comments;
+    table.year.resize(rows);
+    table.day.resize(rows);
+    table.clusterId.resize(rows);
+    table.distance.resize(rows);
+    table.score.resize(rows);
+    table.sentiment.resize(rows);
+    for (int row = 0; row < rows; ++row) {
+        int days = 0, year = -1, month, day;
+        if (utc && utc[row] > 0) {
+            days = static_cast<int>(std::floor(utc[row] / 86400.0));
+            civilFromDays(days, year, month, day);
+        }
+        table.year[row] = year;
+        table.day[row] = days;
+        table.clusterId[row] = clusterId ? clusterId[row] : -1;
+        table.distance[row] = distance ? distance[row] : 0.0;
+        table.score[row] = score ? score[row] : 0.0;
+        table.sentiment[row] = sentiment ? sentiment[row] : 0.0;
+    }
+    if (x && y) {
+        table.x = QVector<float>(x, x + rows);
+        table.y = QVector<float>(y, y + rows);
+    }
+    emit progressChanged(30);
+
+    table.textOffset.resize(rows);
+    table.textLength.resize(rows);
+    if (view.hasTexts()) {
+        std::string_view text = view.textData();
+        const uint64_t *offsets = view.textOffsets();
+        data.arena = QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size()));
+
+        // UTF-16 length of every text from its UTF-8 lead bytes; 4-byte sequences are surrogate pairs
+        qsizetype units = 0;
+        for (int row = 0; row < rows; ++row) {
+            table.textOffset[row] = static_cast<int>(units);
+            for (uint64_t i = offsets[row]; i < offsets[row + 1]; ++i) {
+                uchar c = static_cast<uchar>(text[i]);
+                if ((c & 0xC0) != 0x80)
+                    units += c >= 0xF0 ? 2 : 1;
+            }
+            table.textLength[row] = static_cast<int>(units) - table.textOffset[row];
+        }
+        // invalid UTF-8 decodes to replacement characters and shifts the count: decode text by text instead
+        if (units != data.arena.size()) {
+            qDebug() << "Dataset bundle has invalid UTF-8, decoding texts one by one";
+            data.arena.clear();
+            for (int row = 0; row < rows; ++row) {
+                std::string_view rowText = view.text(row);
+                table.textOffset[row] = static_cast<int>(data.arena.size());
+                data.arena.append(QString::fromUtf8(rowText.data(), static_cast<qsizetype>(rowText.size())));
+                table.textLength[row] = static_cast<int>(data.arena.size()) - table.textOffset[row];
+            }
+        }
+    }
+    data.checksum = view.checksum();
+    emit progressChanged(80);
+    return true;
+}
+
+// The index is cached next to the other application caches and rebuilt when the bundle changes.
+void CommentStore::loadSearchIndex(Data &data)
+{
+    quint64 fingerprint = data.checksum ^ quint64(data.comments.size());
+    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    QString cachePath = cacheDir + "/search_index.bin";
+    if (data.searchIndex.load(cachePath, fingerprint))
+        return;
+
+    data.searchIndex.build(data.comments, data.arena);
+    emit progressChanged(95);
+    if (!QDir().mkpath(cacheDir) || !data.searchIndex.save(cachePath, fingerprint))
+        qDebug() << "Could not write search index cache" << cachePath;
+}
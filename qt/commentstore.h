@@ -0,0 +1,88 @@
+#ifndef COMMENTSTORE_H
+#define COMMENTSTORE_H
+
+#include "invertedindex.h"
+#include "queryencoder.h"
+#include "semanticsearcher.h"
+#include <QFutureWatcher>
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+// Columnar table of comments. Texts live in the store's shared arena and are addressed by offset/length.
+struct CommentTable
+{
+    QVector<int> year;       // -1 when the row has no year
+    QVector<int> day;        // days since 1970-01-01, only meaningful when year is set
+    QVector<int> clusterId;
+    QVector<double> distance;// distance to the cluster center, 0 when unknown
+    QVector<double> score;   // 0 when unknown
+    QVector<double> sentiment;// 0 when unknown
+    QVector<int> textOffset;
+    QVector<int> textLength;
+    QVector<float> x;        // t-SNE coordinates, empty when the bundle has none
+    QVector<float> y;
+
+    int size() const { return clusterId.size(); }
+};
+
+// Application-wide comment data, loaded once on a background thread and shared by all windows.
+class CommentStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    static CommentStore &instance();
+
+    void loadAsync();
+    // false until the bundle loaded; after a failed load loadError() says why
+    bool isLoaded() const { return m_loaded; }
+    QString loadError() const { return m_data.error; }
+
+    // rows of the dataset bundle written by BuildDatasetBundle
+    const CommentTable &comments() const { return m_data.comments; }
+
+    QStringView text(const CommentTable &table, int row) const
+    {
+        return QStringView(m_data.arena).mid(table.textOffset[row], table.textLength[row]);
+    }
+
+    // full-text index over comments(), rows are ranked by score or sentiment
+    const InvertedIndex &searchIndex() const { return m_data.searchIndex; }
+    // embedding index over comments(), not open when no index file is configured
+    const SemanticSearcher &semanticSearcher() const { return *m_data.semanticSearcher; }
+    // query encoders of the settings, created once for the whole app; windows share them
+    const QList<QSharedPointer<QueryEncoder>> &queryEncoders() const { return m_encoders; }
+
+signals:
+    void progressChanged(int percent);
+    // loading finished, also when it failed; isLoaded() tells which
+    void loaded();
+
+private:
+    struct Data
+    {
+        CommentTable comments;
+        QString arena;
+        quint64 checksum = 0; // of the bundle, identifies the data for caches
+        QString error;        // why the bundle could not be loaded, empty on success
+        InvertedIndex searchIndex;
+        QSharedPointer<SemanticSearcher> semanticSearcher = QSharedPointer<SemanticSearcher>::create();
+    };
+
+    explicit CommentStore(QObject *parent = nullptr);
+
+    Data load();
+    bool loadBundle(const QString &path, Data &data);
+    void loadSearchIndex(Data &data);
+
+    Data m_data;
+    QList<QSharedPointer<QueryEncoder>> m_encoders;
+    bool m_loaded = false;
+    bool m_loading = false;
+    QFutureWatcher<Data> m_watcher;
+};
+
+#endif // COMMENTSTORE_H
@@ -1,23 +1,49 @@
 #include "infowindow.h"
 #include "ui_infowindow.h"
-#include <QFile>
-#include <QTextStream>
+#include "commentstore.h"
 #include <QDebug>
 #include <QListWidgetItem>
+#include <QSettings>
+#include <QStandardPaths>
 #include <algorithm>
 
 infowindow::infowindow(QWidget *parent)
     : QDialog(parent)
     , ui(new Ui::infowindow)
+    , runner(new QueryRunner(this))
 
 {
     ui->setupUi(this);
     setWindowTitle("Info Window");
+    openTopComments();
+    connect(runner, &QueryRunner::batchReady, this, &infowindow::appendResults);
+}
+
+// The table is written offline by BuildTopComments; the mapped file is read in place on every click.
+void infowindow::openTopComments()
+{
+    QSettings settings("clustering_tweets", "qt_project");
+    QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/top_comments.bin";
+    topCommentsFile.setFileName(settings.value("info/topComments", defaultPath).toString());
+    if (!topCommentsFile.open(QIODevice::ReadOnly)) {
+        qDebug() << "No top comments table at" << topCommentsFile.fileName() << ", ranking by distance only";
+        return;
+    }
+
+    const char *data = reinterpret_cast<const char *>(topCommentsFile.map(0, topCommentsFile.size()));
+    if (!data) {
+        topCommentsBuffer = topCommentsFile.readAll();
+        data = topCommentsBuffer.constData();
+    }
+    if (!topComments.open(data, static_cast<size_t>(topCommentsFile.size()))) {
+        qDebug() << "Invalid top comments table" << topCommentsFile.fileName();
+    }
 }
 
 
 infowindow::~infowindow()
 {
+    runner->cancel();
     delete ui;
 }
 
@@ -25,9 +51,11 @@ void infowindow::on_showButton_clicked()
 {
     int cluster_id = getSelectedClusterId();
     if (ui->upvoteRadioButton->isChecked()) {
-        loadAndDisplayData(cluster_id, true);
-    } else if (ui->repostRadioButton->isChecked()) {
-        loadAndDisplayData(cluster_id, false);
+        loadAndDisplayData(cluster_id, BY_SCORE);
+    } else if (ui->controversyRadioButton->isChecked()) {
+        loadAndDisplayData(cluster_id, BY_CONTROVERSY);
+    } else if (ui->distanceRadioButton->isChecked()) {
+        loadAndDisplayData(cluster_id, BY_DISTANCE);
     }
 }
 
@@ -37,57 +65,61 @@ int infowindow::getSelectedClusterId()
     return index ;  // Assuming cluster IDs start from 1
 }
 
-void infowindow::loadAndDisplayData(int cluster_id, bool showFirst10)
+void infowindow::loadAndDisplayData(int cluster_id, TopCommentsOrder order)
 {
-    QFile file(":/tsne.csv");
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qDebug() << "Could not open the file!";
+    const int shown = 10;
+    ui->tableWidget->clearContents();
+    ui->tableWidget->setRowCount(shown);
+    ui->tableWidget->setColumnCount(1);
+    ui->tableWidget->setHorizontalHeaderLabels(QStringList() << "Most popular comments");
+    ui->tableWidget->setColumnWidth(0, 500);
+    filledRows = 0;
+
+    if (topComments.isOpen()) {
+        // a handful of reads by offset, cheap enough for the GUI thread
+        runner->cancel();
+        QStringList comments;
+        int count = qMin(topComments.count(cluster_id, order), shown);
+        for (int i = 0; i < count; ++i) {
+            std::string_view text = topComments.text(topComments.entry(cluster_id, order, i));
+            comments.append(QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size())));
+        }
+        appendResults(comments);
         return;
     }
 
-    QTextStream in(&file);
-    QVector<QPair<QString, double>> comments;
-
-    QRegularExpression re("(\\d+),(\\d+\\.\\d+),\"(.*)\"");
-
-    while (!in.atEnd()) {
-        QString line = in.readLine();
-        QRegularExpressionMatch match = re.match(line);
-        if (!match.hasMatch()) {
-            qDebug() << "Skipping invalid line:" << line;
-            continue;
+    // without the table only distances are known: closest comments of the whole cluster, scanned on the thread pool
+    runner->start([cluster_id, shown](const QueryRunner::Token &token) {
+        const CommentStore &store = CommentStore::instance();
+        const CommentTable &table = store.comments();
+        QVector<int> rows;
+        for (int row = 0; row < table.size(); ++row) {
+            if (row % 4096 == 0 && token.isCancelled())
+                return;
+            if (table.clusterId[row] == cluster_id) {
+                rows.append(row);
+            }
         }
-
-        int id = match.captured(1).toInt();
-        double distance = match.captured(2).toDouble();
-        QString comment = match.captured(3);
-
-        if (id == cluster_id) {
-            comments.append(qMakePair(comment, distance));
-        }
-        if (comments.size() ==25){
-            break;
+        int count = qMin(static_cast<int>(rows.size()), shown);
+        std::partial_sort(rows.begin(), rows.begin() + count, rows.end(), [&table](int a, int b) {
+            return table.distance[a] < table.distance[b];
+        });
+        QStringList comments;
+        for (int i = 0; i < count; ++i) {
+            comments.append(store.text(table, rows[i]).toString());
         }
-    }
-
-    std::sort(comments.begin(), comments.end(), [](const QPair<QString, double> &a, const QPair<QString, double> &b) {
-        return a.second < b.second;
+        token.deliver(comments);
     });
+}
 
-    ui->tableWidget->setRowCount(10);
-    ui->tableWidget->setColumnCount(1);
-    ui->tableWidget->setHorizontalHeaderLabels(QStringList() << "Most popular comments");
-    ui->tableWidget->setColumnWidth(0, 500);
-
-    int start = showFirst10 ? 0 : 10;
-    int end = qMin(start + 10, comments.size());
-
-    for (int i = start; i < end; ++i) {
-        QTableWidgetItem *commentItem = new QTableWidgetItem(comments[i].first);
+void infowindow::appendResults(const QStringList &comments)
+{
+    for (const QString &comment : comments) {
+        if (filledRows >= ui->tableWidget->rowCount())
+            break;
+        QTableWidgetItem *commentItem = new QTableWidgetItem(comment);
         commentItem->setFlags(commentItem->flags() & ~Qt::ItemIsEditable); // Make the item read-only
 
-        ui->tableWidget->setItem(i - start, 0, commentItem);
+        ui->tableWidget->setItem(filledRows++, 0, commentItem);
     }
-
-    file.close();
 }
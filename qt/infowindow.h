@@ -6,6 +6,10 @@
 #include <QPair>
 #include <QDialog>
 #include <QRadioButton>
+#include <QFile>
+#include <QByteArray>
+#include "../src/data_processing/TopComments.hpp"
+#include "queryrunner.h"
 
 namespace Ui {
 class infowindow;
@@ -24,10 +28,15 @@ private slots:
 
 private:
     Ui::infowindow *ui;
-    QRadioButton *upvoteRadioButton;
-    QRadioButton *repostRadioButton;
+    QFile topCommentsFile;
+    QByteArray topCommentsBuffer; // only used when the file cannot be mapped
+    TopCommentsView topComments;
+    QueryRunner *runner;
+    int filledRows = 0;
     int getSelectedClusterId();
-    void loadAndDisplayData(int cluster_id, bool showFirst10);
+    void openTopComments();
+    void loadAndDisplayData(int cluster_id, TopCommentsOrder order);
+    void appendResults(const QStringList &comments);
 };
 
 #endif // infowindow_H
@@ -0,0 +1,435 @@
+#include "invertedindex.h"
+#include "commentstore.h"
+#include <QDataStream>
+#include <QFile>
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <vector>
+
+namespace {
+
+void appendVarint(QByteArray &out, quint32 value)
+{
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+quint32 readVarint(const QByteArray &data, int &pos)
+{
+    quint32 value = 0;
+    int shift = 0;
+    while (pos < data.size()) {
+        quint8 byte = static_cast<quint8>(data[pos++]);
+        value |= static_cast<quint32>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            break;
+        shift += 7;
+    }
+    return value;
+}
+
+// a query is a list of groups: a single term, or several terms that must appear as a phrase
+QVector<QStringList> parseQuery(const QString &query)
+{
+    QVector<QStringList> groups;
+    const QStringList parts = query.split('"');
+    for (int i = 0; i < parts.size(); ++i) {
+        QStringList terms = InvertedIndex::tokenize(parts[i]);
+        if (terms.isEmpty())
+            continue;
+        if (i % 2 == 1) {
+            groups.append(terms);
+        } else {
+            for (const QString &term : terms)
+                groups.append(QStringList{term});
+        }
+    }
+    return groups;
+}
+
+} // namespace
+
+PostingCursor::PostingCursor(const QByteArray &data, const QVector<PostingSkip> &skips)
+    : m_data(&data)
+    , m_skips(&skips)
+{
+}
+
+bool PostingCursor::next()
+{
+    if (atEnd())
+        return false;
+    m_pos = m_positionsStart + m_positionsLength;
+    if (m_pos >= m_data->size()) {
+        m_doc = INT_MAX;
+        return false;
+    }
+    m_doc += static_cast<int>(readVarint(*m_data, m_pos));
+    m_ordinal += 1;
+    m_frequency = static_cast<int>(readVarint(*m_data, m_pos));
+    m_positionsLength = static_cast<int>(readVarint(*m_data, m_pos));
+    m_positionsStart = m_pos;
+    return true;
+}
+
+bool PostingCursor::advanceTo(int target)
+{
+    if (m_doc >= target)
+        return !atEnd();
+
+    // jump to the last block that starts before the target, if it is ahead of us
+    auto it = std::lower_bound(m_skips->begin(), m_skips->end(), target,
+                               [](const PostingSkip &skip, int value) { return skip.previousDoc < value; });
+    if (it != m_skips->begin()) {
+        --it;
+        if (it->offset > m_positionsStart + m_positionsLength) {
+            m_doc = it->previousDoc;
+            m_ordinal = static_cast<int>(it - m_skips->begin() + 1) * PostingBlockSize - 1;
+            m_positionsStart = it->offset;
+            m_positionsLength = 0;
+        }
+    }
+    while (m_doc < target) {
+        if (!next())
+            return false;
+    }
+    return true;
+}
+
+bool PostingCursor::nextBlock()
+{
+    if (atEnd())
+        return false;
+    // skip b starts block b + 1
+    int nextBlock = block() + 1;
+    if (nextBlock > m_skips->size()) {
+        m_doc = INT_MAX;
+        return false;
+    }
+    const PostingSkip &skip = (*m_skips)[nextBlock - 1];
+    m_doc = skip.previousDoc;
+    m_ordinal = nextBlock * PostingBlockSize - 1;
+    m_positionsStart = skip.offset;
+    m_positionsLength = 0;
+    return next();
+}
+
+QVector<int> PostingCursor::positions() const
+{
+    QVector<int> result;
+    result.reserve(m_frequency);
+    int pos = m_positionsStart;
+    int position = 0;
+    for (int i = 0; i < m_frequency; ++i) {
+        position += static_cast<int>(readVarint(*m_data, pos));
+        result.append(position);
+    }
+    return result;
+}
+
+QStringList InvertedIndex::tokenize(QStringView text)
+{
+    QStringList tokens;
+    QString current;
+    for (QChar c : text) {
+        if (c.isLetterOrNumber()) {
+            current.append(c.toLower());
+        } else if (!current.isEmpty()) {
+            tokens.append(current);
+            current.clear();
+        }
+    }
+    if (!current.isEmpty())
+        tokens.append(current);
+    return tokens;
+}
+
+void InvertedIndex::build(const CommentTable &table, const QString &arena)
+{
+    m_terms.clear();
+    m_postings.clear();
+    m_skips.clear();
+    m_documentFrequency.clear();
+    m_documentCount = table.size();
+    for (int key = 0; key < RankKeyCount; ++key) {
+        const QVector<double> &column = key == RankByScore ? table.score : table.sentiment;
+        m_rank[key].resize(m_documentCount);
+        for (int row = 0; row < m_documentCount; ++row) {
+            // unknown keys rank as 0, a NaN would break the ordering of the results
+            float value = row < column.size() ? static_cast<float>(column[row]) : 0.0f;
+            m_rank[key][row] = std::isnan(value) ? 0.0f : value;
+        }
+        m_blockMax[key].clear();
+    }
+
+    QVector<int> lastDoc;
+    for (int row = 0; row < table.size(); ++row) {
+        QStringList tokens = tokenize(QStringView(arena).mid(table.textOffset[row], table.textLength[row]));
+
+        // positions of every distinct term of this document, in token order
+        QHash<int, QVector<int>> termPositions;
+        for (int position = 0; position < tokens.size(); ++position) {
+            auto it = m_terms.constFind(tokens[position]);
+            int termId;
+            if (it == m_terms.constEnd()) {
+                termId = m_terms.size();
+                m_terms.insert(tokens[position], termId);
+                m_postings.append(QByteArray());
+                m_skips.append(QVector<PostingSkip>());
+                m_documentFrequency.append(0);
+                for (int key = 0; key < RankKeyCount; ++key)
+                    m_blockMax[key].append(QVector<float>());
+                lastDoc.append(-1);
+            } else {
+                termId = it.value();
+            }
+            termPositions[termId].append(position);
+        }
+
+        for (auto it = termPositions.constBegin(); it != termPositions.constEnd(); ++it) {
+            int termId = it.key();
+            QByteArray &postings = m_postings[termId];
+            if (m_documentFrequency[termId] % PostingBlockSize == 0 && m_documentFrequency[termId] > 0)
+                m_skips[termId].append(PostingSkip{lastDoc[termId], static_cast<qint32>(postings.size())});
+            for (int key = 0; key < RankKeyCount; ++key) {
+                QVector<float> &blockMax = m_blockMax[key][termId];
+                if (m_documentFrequency[termId] % PostingBlockSize == 0)
+                    blockMax.append(m_rank[key][row]);
+                else
+                    blockMax.last() = std::max(blockMax.last(), m_rank[key][row]);
+            }
+
+            QByteArray positions;
+            int previous = 0;
+            for (int position : it.value()) {
+                appendVarint(positions, position - previous);
+                previous = position;
+            }
+            appendVarint(postings, row - lastDoc[termId]);
+            appendVarint(postings, it.value().size());
+            appendVarint(postings, positions.size());
+            postings.append(positions);
+
+            lastDoc[termId] = row;
+            m_documentFrequency[termId] += 1;
+        }
+    }
+    for (QByteArray &postings : m_postings)
+        postings.squeeze();
+}
+
+bool InvertedIndex::matchesPhrase(const QVector<const PostingCursor *> &cursors) const
+{
+    QVector<int> candidates = cursors[0]->positions();
+    for (int i = 1; i < cursors.size() && !candidates.isEmpty(); ++i) {
+        QVector<int> positions = cursors[i]->positions();
+        QVector<int> kept;
+        for (int start : candidates) {
+            if (std::binary_search(positions.begin(), positions.end(), start + i))
+                kept.append(start);
+        }
+        candidates = kept;
+    }
+    return !candidates.isEmpty();
+}
+
+QVector<int> InvertedIndex::search(const QString &query, int limit, RankKey key) const
+{
+    QVector<int> result;
+    QVector<QStringList> groups = parseQuery(query);
+    if (groups.isEmpty() || limit <= 0)
+        return result;
+
+    // one cursor per distinct term, every term must be present
+    QHash<QString, int> cursorOf;
+    std::vector<PostingCursor> cursors;
+    QVector<int> termIds;
+    for (const QStringList &group : groups) {
+        for (const QString &term : group) {
+            if (cursorOf.contains(term))
+                continue;
+            auto it = m_terms.constFind(term);
+            if (it == m_terms.constEnd())
+                return result;
+            cursorOf.insert(term, static_cast<int>(cursors.size()));
+            cursors.emplace_back(m_postings[it.value()], m_skips[it.value()]);
+            termIds.append(it.value());
+        }
+    }
+
+    // the rarest term leads, the others only have to confirm its documents
+    QVector<int> order;
+    for (int i = 0; i < static_cast<int>(cursors.size()); ++i)
+        order.append(i);
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return m_documentFrequency[termIds[a]] < m_documentFrequency[termIds[b]]; });
+
+    for (PostingCursor &cursor : cursors)
+        cursor.next();
+    PostingCursor &lead = cursors[order[0]];
+    const QVector<float> &leadBlockMax = m_blockMax[key][termIds[order[0]]];
+    const QVector<float> &rank = m_rank[key];
+
+    // the best `limit` matches so far, the worst one on top: higher key first, then lower row
+    auto better = [](const std::pair<float, int> &a, const std::pair<float, int> &b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    };
+    std::priority_queue<std::pair<float, int>, std::vector<std::pair<float, int>>, decltype(better)> best(better);
+
+    bool exhausted = false;
+    while (!lead.atEnd() && !exhausted) {
+        int candidate = lead.doc();
+        if (candidate < 0 || candidate >= m_documentCount)
+            break;
+        // a block whose largest key can not beat the worst kept match holds nothing better
+        if (static_cast<int>(best.size()) == limit && leadBlockMax.value(lead.block(), 0.0f) <= best.top().first) {
+            lead.nextBlock();
+            continue;
+        }
+        bool aligned = true;
+        for (int i = 1; i < order.size(); ++i) {
+            PostingCursor &cursor = cursors[order[i]];
+            if (!cursor.advanceTo(candidate)) {
+                exhausted = true;
+                break;
+            }
+            if (cursor.doc() != candidate) {
+                lead.advanceTo(cursor.doc());
+                aligned = false;
+                break;
+            }
+        }
+        if (exhausted || !aligned)
+            continue;
+
+        bool phrasesMatch = true;
+        for (const QStringList &group : groups) {
+            if (group.size() < 2)
+                continue;
+            QVector<const PostingCursor *> phrase;
+            for (const QString &term : group)
+                phrase.append(&cursors[cursorOf.value(term)]);
+            if (!matchesPhrase(phrase)) {
+                phrasesMatch = false;
+                break;
+            }
+        }
+        if (phrasesMatch) {
+            std::pair<float, int> match(rank[candidate], candidate);
+            if (static_cast<int>(best.size()) < limit) {
+                best.push(match);
+            } else if (better(match, best.top())) {
+                best.pop();
+                best.push(match);
+            }
+        }
+        lead.next();
+    }
+
+    result.resize(static_cast<int>(best.size()));
+    for (int i = result.size() - 1; i >= 0; --i, best.pop())
+        result[i] = best.top().second;
+    return result;
+}
+
+// Cache layout: magic, version, fingerprint of the indexed data, then the dictionary, posting lists,
+// skips, and the rank keys per row and per block.
+bool InvertedIndex::save(const QString &path, quint64 fingerprint) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << quint32(0x49445831) << quint32(2) << fingerprint << qint32(m_documentCount);
+    out << m_terms << m_postings << m_documentFrequency;
+    out << qint32(m_skips.size());
+    for (const QVector<PostingSkip> &skips : m_skips) {
+        out << qint32(skips.size());
+        for (const PostingSkip &skip : skips)
+            out << skip.previousDoc << skip.offset;
+    }
+    for (int key = 0; key < RankKeyCount; ++key)
+        out << m_rank[key] << m_blockMax[key];
+    return out.status() == QDataStream::Ok;
+}
+
+bool InvertedIndex::load(const QString &path, quint64 fingerprint)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_12);
+    quint32 magic = 0, version = 0;
+    quint64 storedFingerprint = 0;
+    qint32 documentCount = 0;
+    in >> magic >> version >> storedFingerprint >> documentCount;
+    if (magic != 0x49445831 || version != 2 || storedFingerprint != fingerprint || documentCount < 0)
+        return false;
+
+    // read everything into a scratch index, the members only change once it checks out
+    InvertedIndex loaded;
+    loaded.m_documentCount = documentCount;
+    in >> loaded.m_terms >> loaded.m_postings >> loaded.m_documentFrequency;
+    qint32 lists = 0;
+    in >> lists;
+    if (in.status() != QDataStream::Ok || lists != loaded.m_postings.size())
+        return false;
+    loaded.m_skips.resize(lists);
+    for (QVector<PostingSkip> &skips : loaded.m_skips) {
+        qint32 size = 0;
+        in >> size;
+        // every skip takes 8 bytes of the file
+        if (in.status() != QDataStream::Ok || size < 0 || size > (file.size() - file.pos()) / 8)
+            return false;
+        skips.resize(size);
+        for (PostingSkip &skip : skips)
+            in >> skip.previousDoc >> skip.offset;
+    }
+    for (int key = 0; key < RankKeyCount; ++key)
+        in >> loaded.m_rank[key] >> loaded.m_blockMax[key];
+    if (in.status() != QDataStream::Ok || !in.atEnd())
+        return false;
+
+    if (loaded.m_documentFrequency.size() != lists)
+        return false;
+    for (auto it = loaded.m_terms.constBegin(); it != loaded.m_terms.constEnd(); ++it) {
+        if (it.value() < 0 || it.value() >= lists)
+            return false;
+    }
+    for (int key = 0; key < RankKeyCount; ++key) {
+        if (loaded.m_rank[key].size() != documentCount || loaded.m_blockMax[key].size() != lists)
+            return false;
+    }
+    for (int term = 0; term < lists; ++term) {
+        const QVector<PostingSkip> &skips = loaded.m_skips[term];
+        int frequency = loaded.m_documentFrequency[term];
+        if (frequency < 0 || frequency > documentCount || skips.size() != (frequency > 0 ? (frequency - 1) / PostingBlockSize : 0))
+            return false;
+        qint32 offset = 0;
+        for (const PostingSkip &skip : skips) {
+            if (skip.offset <= offset || skip.offset > loaded.m_postings[term].size() || skip.previousDoc < 0 || skip.previousDoc >= documentCount)
+                return false;
+            offset = skip.offset;
+        }
+        for (int key = 0; key < RankKeyCount; ++key) {
+            if (loaded.m_blockMax[key][term].size() != (frequency + PostingBlockSize - 1) / PostingBlockSize)
+                return false;
+        }
+    }
+
+    std::swap(m_terms, loaded.m_terms);
+    std::swap(m_postings, loaded.m_postings);
+    std::swap(m_skips, loaded.m_skips);
+    std::swap(m_documentFrequency, loaded.m_documentFrequency);
+    for (int key = 0; key < RankKeyCount; ++key) {
+        std::swap(m_rank[key], loaded.m_rank[key]);
+        std::swap(m_blockMax[key], loaded.m_blockMax[key]);
+    }
+    m_documentCount = documentCount;
+    return true;
+}
@@ -0,0 +1,87 @@
+#ifndef INVERTEDINDEX_H
+#define INVERTEDINDEX_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+#include <climits>
+
+struct CommentTable;
+
+// postings per block of a posting list; every block after the first has a skip pointer
+const int PostingBlockSize = 64;
+
+// Skip pointer into a posting list: the block starting at byte `offset` is delta-coded from `previousDoc`.
+struct PostingSkip
+{
+    qint32 previousDoc;
+    qint32 offset;
+};
+
+// Reads one posting list: per document varint(doc delta), varint(term frequency),
+// varint(position bytes) followed by the delta/varint coded positions.
+class PostingCursor
+{
+public:
+    PostingCursor(const QByteArray &data, const QVector<PostingSkip> &skips);
+
+    bool next();
+    bool advanceTo(int target);
+    // moves to the first document of the next block, false if there is none
+    bool nextBlock();
+    bool atEnd() const { return m_doc == INT_MAX; }
+    int doc() const { return m_doc; }
+    // block of the current posting, index into the per-block maxima
+    int block() const { return m_ordinal / PostingBlockSize; }
+    int termFrequency() const { return m_frequency; }
+    QVector<int> positions() const;
+
+private:
+    const QByteArray *m_data;
+    const QVector<PostingSkip> *m_skips;
+    int m_pos = 0;
+    int m_doc = -1;
+    int m_ordinal = -1; // number of the current posting in the list
+    int m_frequency = 0;
+    int m_positionsStart = 0;
+    int m_positionsLength = 0;
+};
+
+// Tokenized inverted index over comment texts with positional, delta/varint compressed posting lists.
+// Supports multi-term AND queries and "quoted phrases"; results are ranked by score or by sentiment.
+// Every block of a posting list keeps the largest rank key of its documents, so a search skips the blocks
+// that can not beat the results it already has, and keeps only the best `limit` matches.
+class InvertedIndex
+{
+public:
+    enum RankKey { RankByScore, RankBySentiment, RankKeyCount };
+
+    void build(const CommentTable &table, const QString &arena);
+    bool save(const QString &path, quint64 fingerprint) const;
+    // false, with the index unchanged, if the cache is missing, of another version or data, or damaged
+    bool load(const QString &path, quint64 fingerprint);
+
+    // the best `limit` matches by `key`, highest first, ties in row order
+    QVector<int> search(const QString &query, int limit, RankKey key) const;
+
+    int documentCount() const { return m_documentCount; }
+    int termCount() const { return m_terms.size(); }
+
+    static QStringList tokenize(QStringView text);
+
+private:
+    QHash<QString, int> m_terms;
+    QVector<QByteArray> m_postings;
+    QVector<QVector<PostingSkip>> m_skips;
+    QVector<int> m_documentFrequency;
+    QVector<float> m_rank[RankKeyCount];                // per row
+    QVector<QVector<float>> m_blockMax[RankKeyCount];   // per term and block: largest key of its documents
+    int m_documentCount = 0;
+
+    bool matchesPhrase(const QVector<const PostingCursor *> &cursors) const;
+};
+
+#endif // INVERTEDINDEX_H
@@ -2,7 +2,6 @@
 
 #include <QApplication>
 
-#include <QWebEngineView>
 #include <QVBoxLayout>
 #include <QWidget>
 #include <QIcon>
@@ -1,6 +1,9 @@
 #include "mainwindow.h"
 #include "./ui_mainwindow.h"
 #include "yearwindow.h"
+#include "commentstore.h"
+#include <QMessageBox>
+#include <QStatusBar>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -8,6 +11,37 @@ MainWindow::MainWindow(QWidget *parent)
 {
     ui->setupUi(this);
     setWindowTitle("Main Window");
+
+    // all windows read from the shared store, so they are enabled once it is loaded
+    ui->yearButton->setEnabled(false);
+    ui->searchButton->setEnabled(false);
+    ui->infoButton->setEnabled(false);
+    ui->mapButton->setEnabled(false);
+
+    loadingBar = new QProgressBar(this);
+    loadingBar->setRange(0, 100);
+    statusBar()->addPermanentWidget(loadingBar);
+    statusBar()->showMessage("Loading comments...");
+
+    CommentStore &store = CommentStore::instance();
+    connect(&store, &CommentStore::progressChanged, loadingBar, &QProgressBar::setValue);
+    connect(&store, &CommentStore::loaded, this, [this]() {
+        statusBar()->removeWidget(loadingBar);
+        loadingBar->deleteLater();
+        // without a bundle every window would be empty, so they stay disabled
+        const CommentStore &store = CommentStore::instance();
+        if (!store.isLoaded()) {
+            statusBar()->showMessage("No comments loaded");
+            QMessageBox::critical(this, "Error", store.loadError());
+            return;
+        }
+        statusBar()->showMessage("Comments loaded", 3000);
+        ui->yearButton->setEnabled(true);
+        ui->searchButton->setEnabled(true);
+        ui->infoButton->setEnabled(true);
+        ui->mapButton->setEnabled(true);
+    });
+    store.loadAsync();
 }
 
 MainWindow::~MainWindow()
@@ -20,6 +54,7 @@ void MainWindow::on_yearButton_clicked()
 {
 
     Ywindow = new yearwindow(this);
+    Ywindow->setAttribute(Qt::WA_DeleteOnClose);
 
     Ywindow -> show();
 }
@@ -29,6 +64,7 @@ void MainWindow::on_searchButton_clicked()
 {
 
     Swindow = new searchwindow(this);
+    Swindow->setAttribute(Qt::WA_DeleteOnClose);
 
     Swindow -> show();
 }
@@ -38,7 +74,17 @@ void MainWindow::on_infoButton_clicked()
 {
 
     Iwindow = new infowindow(this);
+    Iwindow->setAttribute(Qt::WA_DeleteOnClose);
 
     Iwindow -> show();
 }
 
+
+void MainWindow::on_mapButton_clicked()
+{
+
+    Mwindow = new mapwindow(this);
+    Mwindow->setAttribute(Qt::WA_DeleteOnClose);
+
+    Mwindow -> show();
+}
@@ -5,7 +5,9 @@
 #include "yearwindow.h"
 #include "searchwindow.h"
 #include "infowindow.h"
+#include "mapwindow.h"
 #include <QListWidget>
+#include <QProgressBar>
 
 
 QT_BEGIN_NAMESPACE
@@ -30,12 +32,16 @@ private slots:
 
     void on_infoButton_clicked();
 
+    void on_mapButton_clicked();
+
 private:
     Ui::MainWindow *ui;
 
     yearwindow *Ywindow;
     infowindow *Iwindow;
     searchwindow *Swindow;
+    mapwindow *Mwindow;
+    QProgressBar *loadingBar;
 
 
 
@@ -0,0 +1,89 @@
+#include "mapwindow.h"
+#include "ui_mapwindow.h"
+#include "commentstore.h"
+#include <QSettings>
+#include <QStandardPaths>
+#include <QToolTip>
+#include <algorithm>
+#include <QtConcurrent/QtConcurrent>
+
+mapwindow::mapwindow(QWidget *parent)
+    : QDialog(parent)
+    , ui(new Ui::mapwindow)
+{
+    ui->setupUi(this);
+    setWindowTitle("Map Window");
+
+    QStringList names = {"Skepticism", "Fatalism", "Politics", "Natural Disasters", "Renewable Energy", "Wildlife", "Agriculture",
+                         "Health", "Technology", "Economics", "Activism", "Education", "Policy", "Transportation",
+                         "Personal Responsibility", "Media", "Water Resources", "Urban Planning", "Historical Context",
+                         "International Relations", "Indigenous Perspectives", "Gender", "Youth", "Art", "Religion"};
+    for (int i = 0; i < names.size(); ++i)
+        clusterNames.insert(i, names[i]);
+
+    // building the density levels of a million points takes a moment, keep the dialog responsive
+    connect(&loadWatcher, &QFutureWatcher<QSharedPointer<ScatterPlotData>>::finished, this, [this]() {
+        QSharedPointer<ScatterPlotData> data = loadWatcher.result();
+        ui->plotWidget->setData(data);
+        ui->statusLabel->setText(
+            QString("%1 comments. Drag to pan, wheel to zoom, shift + drag to select, right click to reset.").arg(data->size()));
+    });
+    const CommentTable &table = CommentStore::instance().comments();
+    if (!table.x.isEmpty()) {
+        // coordinates come with the dataset bundle, rows line up with the store
+        ui->statusLabel->setText("Building map...");
+        loadWatcher.setFuture(QtConcurrent::run(&ScatterPlotData::build, table.x, table.y, table.clusterId));
+    } else {
+        QSettings settings("clustering_tweets", "qt_project");
+        QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/tsneClustered.csv";
+        QString path = settings.value("map/points", defaultPath).toString();
+        ui->statusLabel->setText("Loading " + path + "...");
+        loadWatcher.setFuture(QtConcurrent::run(&ScatterPlotData::loadClusteredCsv, path));
+    }
+
+    connect(ui->plotWidget, &ScatterPlotWidget::pointHovered, this, &mapwindow::showPoint);
+    connect(ui->plotWidget, &ScatterPlotWidget::selectionChanged, this, &mapwindow::showSelection);
+}
+
+mapwindow::~mapwindow()
+{
+    loadWatcher.waitForFinished();
+    delete ui;
+}
+
+void mapwindow::showPoint(int index)
+{
+    if (index < 0) {
+        QToolTip::hideText();
+        return;
+    }
+    const CommentStore &store = CommentStore::instance();
+    const CommentTable &table = store.comments();
+    int cluster = ui->plotWidget->data()->cluster[index];
+    QString text = clusterNames.value(cluster, QString::number(cluster));
+    if (index < table.size())
+        text += "\n" + store.text(table, index).left(300).toString();
+    QToolTip::showText(QCursor::pos(), text, ui->plotWidget);
+}
+
+// size of the lasso selection and the clusters it mostly covers
+void mapwindow::showSelection(const QVector<int> &indices)
+{
+    if (indices.isEmpty()) {
+        ui->statusLabel->setText("No comments selected.");
+        return;
+    }
+    const QVector<int> &cluster = ui->plotWidget->data()->cluster;
+    QMap<int, int> counts;
+    for (int i : indices)
+        counts[cluster[i]] += 1;
+    QVector<QPair<int, int>> byCount;
+    for (auto it = counts.constBegin(); it != counts.constEnd(); ++it)
+        byCount.append(qMakePair(it.value(), it.key()));
+    std::sort(byCount.begin(), byCount.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+
+    QStringList top;
+    for (int i = 0; i < std::min(3, static_cast<int>(byCount.size())); ++i)
+        top.append(QString("%1 (%2)").arg(clusterNames.value(byCount[i].second, QString::number(byCount[i].second))).arg(byCount[i].first));
+    ui->statusLabel->setText(QString("%1 comments selected: %2").arg(indices.size()).arg(top.join(", ")));
+}
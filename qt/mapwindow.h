@@ -0,0 +1,32 @@
+#ifndef MAPWINDOW_H
+#define MAPWINDOW_H
+
+#include "scatterplotwidget.h"
+#include <QDialog>
+#include <QFutureWatcher>
+#include <QMap>
+
+namespace Ui {
+class mapwindow;
+}
+
+// Interactive t-SNE map of all comments, colored by cluster.
+class mapwindow : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit mapwindow(QWidget *parent = nullptr);
+    ~mapwindow();
+
+private slots:
+    void showPoint(int index);
+    void showSelection(const QVector<int> &indices);
+
+private:
+    Ui::mapwindow *ui;
+    QFutureWatcher<QSharedPointer<ScatterPlotData>> loadWatcher;
+    QMap<int, QString> clusterNames;
+};
+
+#endif // MAPWINDOW_H
@@ -0,0 +1,163 @@
+#include "queryencoder.h"
+#include <QDeadlineTimer>
+#include <QDebug>
+#include <QFile>
+#include <QProcess>
+#include <QSettings>
+#include <QTextStream>
+
+namespace {
+
+QVector<double> parseVector(QStringView line)
+{
+    QVector<double> values;
+    for (QStringView field : line.split(',')) {
+        bool ok = false;
+        double value = field.trimmed().toDouble(&ok);
+        if (!ok)
+            return {};
+        values.append(value);
+    }
+    return values;
+}
+
+} // namespace
+
+// semantic/queryEmbeddings = path of an embedding file
+// semantic/encoderCommand  = program and arguments of a local encoder, e.g. "python3 encode_query.py"
+QList<QSharedPointer<QueryEncoder>> QueryEncoder::fromSettings()
+{
+    QList<QSharedPointer<QueryEncoder>> encoders;
+    QSettings settings("clustering_tweets", "qt_project");
+    QString embeddingFile = settings.value("semantic/queryEmbeddings").toString();
+    if (!embeddingFile.isEmpty())
+        encoders.append(QSharedPointer<EmbeddingFileEncoder>::create(embeddingFile));
+
+    QStringList command = QProcess::splitCommand(settings.value("semantic/encoderCommand").toString());
+    if (!command.isEmpty()) {
+        QString program = command.takeFirst();
+        encoders.append(QSharedPointer<ProcessEncoder>::create(program, command));
+    }
+    return encoders;
+}
+
+EmbeddingFileEncoder::EmbeddingFileEncoder(const QString &path)
+    : m_path(path)
+{
+}
+
+QVector<double> EmbeddingFileEncoder::encode(const QString &text)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_loaded) {
+        m_loaded = true;
+        QFile file(m_path);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            qDebug() << "Could not open query embeddings" << m_path;
+            return {};
+        }
+        QTextStream in(&file);
+        while (!in.atEnd()) {
+            QString line = in.readLine();
+            int tab = line.lastIndexOf('\t');
+            if (tab < 0)
+                continue;
+            QVector<double> embedding = parseVector(QStringView(line).mid(tab + 1));
+            if (!embedding.isEmpty())
+                m_embeddings.insert(line.left(tab).trimmed().toLower(), embedding);
+        }
+    }
+    return m_embeddings.value(text.trimmed().toLower());
+}
+
+ProcessEncoder::ProcessEncoder(const QString &program, const QStringList &arguments, int timeoutMs, int startTimeoutMs)
+    : m_program(program)
+    , m_arguments(arguments)
+    , m_timeoutMs(timeoutMs)
+    , m_startTimeoutMs(startTimeoutMs)
+    , m_context(new QObject)
+{
+    m_context->moveToThread(&m_thread);
+    QObject::connect(&m_thread, &QThread::finished, m_context, &QObject::deleteLater);
+    m_thread.start();
+    // the model loads in the background now; a query that comes earlier waits behind this call on m_thread
+    QMetaObject::invokeMethod(m_context, [this]() { ensureStarted(); }, Qt::QueuedConnection);
+}
+
+ProcessEncoder::~ProcessEncoder()
+{
+    QMetaObject::invokeMethod(m_context, [this]() { stop(); }, Qt::BlockingQueuedConnection);
+    m_thread.quit();
+    m_thread.wait();
+}
+
+QVector<double> ProcessEncoder::encode(const QString &text)
+{
+    QString line = text.simplified();
+    if (line.isEmpty())
+        return {};
+    QMutexLocker locker(&m_mutex);
+    QVector<double> embedding;
+    QMetaObject::invokeMethod(m_context, [this, &line]() { return request(line); }, Qt::BlockingQueuedConnection, &embedding);
+    return embedding;
+}
+
+// runs in m_thread
+QVector<double> ProcessEncoder::request(const QString &line)
+{
+    if (!ensureStarted())
+        return {};
+    m_process->write(line.toUtf8() + '\n');
+    QString output;
+    if (!readLine(m_timeoutMs, output)) {
+        qDebug() << "Query encoder timed out or exited, restarting it on the next query";
+        stop();
+        return {};
+    }
+    return output.isEmpty() ? QVector<double>() : parseVector(output);
+}
+
+// runs in m_thread; false if no whole line arrived within timeoutMs
+bool ProcessEncoder::readLine(int timeoutMs, QString &line)
+{
+    QDeadlineTimer deadline(timeoutMs);
+    while (!m_process->canReadLine()) {
+        if (deadline.hasExpired() || !m_process->waitForReadyRead(static_cast<int>(deadline.remainingTime())))
+            return false;
+    }
+    line = QString::fromUtf8(m_process->readLine()).trimmed();
+    return true;
+}
+
+bool ProcessEncoder::ensureStarted()
+{
+    if (m_process && m_process->state() == QProcess::Running)
+        return true;
+    stop();
+    m_process = new QProcess(m_context);
+    m_process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    m_process->start(m_program, m_arguments);
+    QString ready;
+    if (!m_process->waitForStarted(m_startTimeoutMs) || !readLine(m_startTimeoutMs, ready) || ready != "ready") {
+        qDebug() << "Query encoder" << m_program << "did not start or did not report ready";
+        stop();
+        return false;
+    }
+    return true;
+}
+
+void ProcessEncoder::stop()
+{
+    if (!m_process)
+        return;
+    if (m_process->state() != QProcess::NotRunning) {
+        // the encoder exits at the end of its input, a hung one is killed
+        m_process->closeWriteChannel();
+        if (!m_process->waitForFinished(1000)) {
+            m_process->kill();
+            m_process->waitForFinished(1000);
+        }
+    }
+    delete m_process;
+    m_process = nullptr;
+}
@@ -0,0 +1,69 @@
+#ifndef QUERYENCODER_H
+#define QUERYENCODER_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+
+class QProcess;
+
+// Turns a query text into an embedding of the same model that embedded the comments.
+// encode() returns an empty vector when the encoder has no embedding for the text.
+// Encoders are called from query worker threads and must be thread-safe.
+class QueryEncoder
+{
+public:
+    virtual ~QueryEncoder() = default;
+    virtual QVector<double> encode(const QString &text) = 0;
+
+    // encoders configured in the "semantic" settings group, in the order they should be tried
+    static QList<QSharedPointer<QueryEncoder>> fromSettings();
+};
+
+// Precomputed query embeddings, one per line: text<TAB>x0,x1,...
+class EmbeddingFileEncoder : public QueryEncoder
+{
+public:
+    explicit EmbeddingFileEncoder(const QString &path);
+    QVector<double> encode(const QString &text) override;
+
+private:
+    QString m_path;
+    QMutex m_mutex;
+    bool m_loaded = false;
+    QHash<QString, QVector<double>> m_embeddings;
+};
+
+// Local encoder process, started when the encoder is created and kept running. Once its model is loaded it
+// prints "ready"; then every query is one line on its stdin and is answered by x0,x1,... on one line of stdout
+// (an empty line if it has no embedding). `startTimeoutMs` covers the start up to "ready", `timeoutMs` each
+// query after it. The process is restarted only after it failed or timed out, so the model is loaded once.
+class ProcessEncoder : public QueryEncoder
+{
+public:
+    ProcessEncoder(const QString &program, const QStringList &arguments, int timeoutMs = 5000, int startTimeoutMs = 120000);
+    ~ProcessEncoder() override;
+    QVector<double> encode(const QString &text) override;
+
+private:
+    QVector<double> request(const QString &line);
+    bool ensureStarted();
+    bool readLine(int timeoutMs, QString &line);
+    void stop();
+
+    QString m_program;
+    QStringList m_arguments;
+    int m_timeoutMs;
+    int m_startTimeoutMs;
+    QMutex m_mutex;                // one query at a time on the pipe
+    QThread m_thread;              // QProcess must be used from one thread, queries come from the worker pool
+    QObject *m_context;            // lives in m_thread, the queries run there
+    QProcess *m_process = nullptr; // child of m_context
+};
+
+#endif // QUERYENCODER_H
@@ -0,0 +1,65 @@
+#include "queryrunner.h"
+#include <QMetaObject>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+
+void QueryRunner::Token::deliver(const QStringList &batch) const
+{
+    if (isCancelled())
+        return;
+    QueryRunner *runner = m_runner;
+    quint64 generation = m_generation;
+    QMetaObject::invokeMethod(runner, [runner, generation, batch]() { runner->deliverBatch(generation, batch); }, Qt::QueuedConnection);
+}
+
+QueryRunner::QueryRunner(QObject *parent)
+    : QObject(parent)
+    , m_generation(std::make_shared<std::atomic<quint64>>(0))
+{
+}
+
+// workers may still hold a pointer to this runner, so they all have to end first
+QueryRunner::~QueryRunner()
+{
+    cancel();
+    for (QFuture<void> &future : m_futures)
+        future.waitForFinished();
+}
+
+void QueryRunner::start(Work work)
+{
+    m_futures.erase(std::remove_if(m_futures.begin(), m_futures.end(), [](const QFuture<void> &future) { return future.isFinished(); }),
+                    m_futures.end());
+
+    Token token;
+    token.m_runner = this;
+    token.m_generation = ++(*m_generation);
+    token.m_current = m_generation;
+    m_running = true;
+
+    m_futures.append(QtConcurrent::run([this, token, work]() {
+        work(token);
+        quint64 generation = token.m_generation;
+        QMetaObject::invokeMethod(this, [this, generation]() { finish(generation); }, Qt::QueuedConnection);
+    }));
+}
+
+void QueryRunner::cancel()
+{
+    ++(*m_generation);
+    m_running = false;
+}
+
+void QueryRunner::deliverBatch(quint64 generation, const QStringList &batch)
+{
+    if (generation == m_generation->load())
+        emit batchReady(batch);
+}
+
+void QueryRunner::finish(quint64 generation)
+{
+    if (generation != m_generation->load())
+        return;
+    m_running = false;
+    emit finished();
+}
@@ -0,0 +1,55 @@
+#ifndef QUERYRUNNER_H
+#define QUERYRUNNER_H
+
+#include <QFuture>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+// Runs one query at a time of a window on the global thread pool.
+// Starting a new query cancels the previous one: the worker sees isCancelled() and anything it still
+// delivers is dropped, so only batches of the latest query reach batchReady().
+class QueryRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    class Token
+    {
+    public:
+        bool isCancelled() const { return m_generation != m_current->load(); }
+        // queues a batch of results for the GUI thread, a no-op once the query is cancelled
+        void deliver(const QStringList &batch) const;
+
+    private:
+        friend class QueryRunner;
+        QueryRunner *m_runner = nullptr;
+        quint64 m_generation = 0;
+        std::shared_ptr<std::atomic<quint64>> m_current;
+    };
+    using Work = std::function<void(const Token &token)>;
+
+    explicit QueryRunner(QObject *parent = nullptr);
+    ~QueryRunner();
+
+    void start(Work work);
+    void cancel();
+    bool isRunning() const { return m_running; }
+
+signals:
+    void batchReady(const QStringList &batch);
+    void finished();
+
+private:
+    std::shared_ptr<std::atomic<quint64>> m_generation;
+    QList<QFuture<void>> m_futures;
+    bool m_running = false;
+
+    void deliverBatch(quint64 generation, const QStringList &batch);
+    void finish(quint64 generation);
+};
+
+#endif // QUERYRUNNER_H
@@ -0,0 +1,386 @@
+#include "scatterplotwidget.h"
+#include "../src/clustering_core/modules/ReadData.hpp"
+#include <QDebug>
+#include <QFile>
+#include <QLineF>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
+
+int ScatterPlotData::cellColumn(double px) const
+{
+    return std::clamp(static_cast<int>((px - bounds.left()) / cellWidth()), 0, GridSize - 1);
+}
+
+int ScatterPlotData::cellRow(double py) const
+{
+    return std::clamp(static_cast<int>((py - bounds.top()) / cellHeight()), 0, GridSize - 1);
+}
+
+QSharedPointer<ScatterPlotData> ScatterPlotData::build(QVector<float> x, QVector<float> y, QVector<int> cluster)
+{
+    auto data = QSharedPointer<ScatterPlotData>::create();
+    data->x = std::move(x);
+    data->y = std::move(y);
+    data->cluster = std::move(cluster);
+    const int n = data->x.size();
+
+    float left = 0, right = 1, top = 0, bottom = 1;
+    if (n > 0) {
+        auto [minX, maxX] = std::minmax_element(data->x.cbegin(), data->x.cend());
+        auto [minY, maxY] = std::minmax_element(data->y.cbegin(), data->y.cend());
+        left = *minX;
+        right = std::max(*maxX, left + 1e-6f);
+        top = *minY;
+        bottom = std::max(*maxY, top + 1e-6f);
+    }
+    data->bounds = QRectF(left, top, right - left, bottom - top);
+    data->tree.build(data->x.constData(), data->y.constData(), n);
+    for (int c : data->cluster)
+        data->numClusters = std::max(data->numClusters, c + 1);
+
+    // counting sort of the points by grid cell
+    const int cells = GridSize * GridSize;
+    QVector<int> cellOf(n);
+    data->cellStart.fill(0, cells + 1);
+    for (int i = 0; i < n; ++i) {
+        cellOf[i] = data->cellRow(data->y[i]) * GridSize + data->cellColumn(data->x[i]);
+        data->cellStart[cellOf[i] + 1] += 1;
+    }
+    for (int c = 0; c < cells; ++c)
+        data->cellStart[c + 1] += data->cellStart[c];
+    data->order.resize(n);
+    QVector<int> next(data->cellStart.cbegin(), data->cellStart.cend() - 1);
+    for (int i = 0; i < n; ++i)
+        data->order[next[cellOf[i]]++] = i;
+
+    // level 0 sums of count and cluster colors, each next level sums 2x2 cells of the previous one
+    int size = GridSize;
+    QVector<float> count(cells, 0.0f), red(cells, 0.0f), green(cells, 0.0f), blue(cells, 0.0f);
+    for (int i = 0; i < n; ++i) {
+        QColor color = ScatterPlotWidget::clusterColor(data->cluster[i]);
+        count[cellOf[i]] += 1;
+        red[cellOf[i]] += color.red();
+        green[cellOf[i]] += color.green();
+        blue[cellOf[i]] += color.blue();
+    }
+    while (size >= 16) {
+        float maxCount = *std::max_element(count.cbegin(), count.cend());
+        float logMax = std::log1p(std::max(maxCount, 1.0f));
+        QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+        for (int row = 0; row < size; ++row) {
+            QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(row));
+            for (int column = 0; column < size; ++column) {
+                int c = row * size + column;
+                if (count[c] == 0)
+                    continue;
+                int alpha = 70 + static_cast<int>(185 * std::log1p(count[c]) / logMax);
+                line[column] = qPremultiply(qRgba(static_cast<int>(red[c] / count[c]), static_cast<int>(green[c] / count[c]),
+                                                  static_cast<int>(blue[c] / count[c]), alpha));
+            }
+        }
+        data->levels.append(image);
+
+        int half = size / 2;
+        QVector<float> count2(half * half), red2(half * half), green2(half * half), blue2(half * half);
+        for (int row = 0; row < half; ++row) {
+            for (int column = 0; column < half; ++column) {
+                int a = 2 * row * size + 2 * column;
+                int sum[4] = {a, a + 1, a + size, a + size + 1};
+                int c = row * half + column;
+                for (int s : sum) {
+                    count2[c] += count[s];
+                    red2[c] += red[s];
+                    green2[c] += green[s];
+                    blue2[c] += blue[s];
+                }
+            }
+        }
+        count.swap(count2);
+        red.swap(red2);
+        green.swap(green2);
+        blue.swap(blue2);
+        size = half;
+    }
+    return data;
+}
+
+QSharedPointer<ScatterPlotData> ScatterPlotData::loadClusteredCsv(const QString &path)
+{
+    QVector<float> x, y;
+    QVector<int> cluster;
+    if (!QFile::exists(path)) {
+        qDebug() << "Could not open" << path;
+        return build(x, y, cluster);
+    }
+    // "cluster_id,distance,x,y" as written by CLustering --tsne
+    std::vector<Point> points = read_from_csv(QFile::encodeName(path).toStdString());
+    x.reserve(static_cast<int>(points.size()));
+    y.reserve(static_cast<int>(points.size()));
+    cluster.reserve(static_cast<int>(points.size()));
+    for (const Point &point : points) {
+        if (point.coords.size() < 2)
+            continue;
+        cluster.append(point.cluster_id);
+        x.append(static_cast<float>(point.coords[0]));
+        y.append(static_cast<float>(point.coords[1]));
+    }
+    return build(x, y, cluster);
+}
+
+ScatterPlotWidget::ScatterPlotWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    setMouseTracking(true);
+    setMinimumSize(200, 200);
+}
+
+void ScatterPlotWidget::setData(QSharedPointer<const ScatterPlotData> data)
+{
+    m_data = data;
+    m_hovered = -1;
+    m_selection.clear();
+    resetView();
+}
+
+void ScatterPlotWidget::clearSelection()
+{
+    if (m_selection.isEmpty())
+        return;
+    m_selection.clear();
+    update();
+    emit selectionChanged(m_selection);
+}
+
+void ScatterPlotWidget::resetView()
+{
+    m_viewMoved = false;
+    if (m_data && width() > 0 && height() > 0) {
+        m_center = m_data->bounds.center();
+        m_scale = 0.95 * std::min(width() / m_data->bounds.width(), height() / m_data->bounds.height());
+    }
+    update();
+}
+
+// evenly spread hues, points without a cluster are grey
+QColor ScatterPlotWidget::clusterColor(int cluster)
+{
+    if (cluster < 0)
+        return QColor(150, 150, 150);
+    return QColor::fromHsv((cluster * 137) % 360, 200, 220);
+}
+
+QPointF ScatterPlotWidget::toScreen(double x, double y) const
+{
+    return QPointF((x - m_center.x()) * m_scale + width() / 2.0, (y - m_center.y()) * m_scale + height() / 2.0);
+}
+
+QPointF ScatterPlotWidget::toWorld(const QPointF &screen) const
+{
+    return QPointF((screen.x() - width() / 2.0) / m_scale + m_center.x(), (screen.y() - height() / 2.0) / m_scale + m_center.y());
+}
+
+// range of grid cells (columns x rows) covered by the widget
+QRect ScatterPlotWidget::visibleCells() const
+{
+    QPointF topLeft = toWorld(QPointF(0, 0));
+    QPointF bottomRight = toWorld(QPointF(width(), height()));
+    return QRect(QPoint(m_data->cellColumn(topLeft.x()), m_data->cellRow(topLeft.y())),
+                 QPoint(m_data->cellColumn(bottomRight.x()), m_data->cellRow(bottomRight.y())));
+}
+
+void ScatterPlotWidget::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+    if (!m_data || m_data->size() == 0) {
+        painter.drawText(rect(), Qt::AlignCenter, "No points loaded");
+        return;
+    }
+
+    if (!drawPoints(painter))
+        drawDensity(painter);
+
+    if (!m_selection.isEmpty() && m_selection.size() <= MaxDrawnPoints) {
+        QVector<QPointF> selected;
+        selected.reserve(m_selection.size());
+        for (int i : m_selection)
+            selected.append(toScreen(m_data->x[i], m_data->y[i]));
+        painter.setPen(QPen(palette().highlight().color(), 3));
+        painter.drawPoints(selected.constData(), selected.size());
+    }
+
+    if (m_lassoing) {
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setPen(QPen(palette().text().color(), 1, Qt::DashLine));
+        painter.setBrush(Qt::NoBrush);
+        painter.drawPolygon(m_lasso);
+    }
+
+    if (m_hovered >= 0) {
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setPen(QPen(palette().text().color(), 2));
+        painter.setBrush(Qt::NoBrush);
+        painter.drawEllipse(toScreen(m_data->x[m_hovered], m_data->y[m_hovered]), HoverRadius, HoverRadius);
+    }
+}
+
+// one pixel of the chosen level covers at least one screen pixel, so at most one image is scaled per frame
+void ScatterPlotWidget::drawDensity(QPainter &painter)
+{
+    double cellPixels = m_scale * std::min(m_data->cellWidth(), m_data->cellHeight());
+    int level = 0;
+    while (level + 1 < m_data->levels.size() && cellPixels * (1 << level) < 1.0)
+        ++level;
+    const QImage &image = m_data->levels[level];
+
+    const QRectF &bounds = m_data->bounds;
+    QRectF view(toWorld(QPointF(0, 0)), toWorld(QPointF(width(), height())));
+    QRectF world = view.intersected(bounds);
+    if (world.isEmpty())
+        return;
+    QRectF source((world.left() - bounds.left()) / bounds.width() * image.width(), (world.top() - bounds.top()) / bounds.height() * image.height(),
+                  world.width() / bounds.width() * image.width(), world.height() / bounds.height() * image.height());
+    // whole pixels only, otherwise the image is resampled at fractional offsets and blocks shimmer while panning
+    QRectF aligned(QPointF(std::floor(source.left()), std::floor(source.top())), QPointF(std::ceil(source.right()), std::ceil(source.bottom())));
+    QPointF topLeft(bounds.left() + aligned.left() / image.width() * bounds.width(), bounds.top() + aligned.top() / image.height() * bounds.height());
+    QPointF bottomRight(bounds.left() + aligned.right() / image.width() * bounds.width(), bounds.top() + aligned.bottom() / image.height() * bounds.height());
+    painter.drawImage(QRectF(toScreen(topLeft.x(), topLeft.y()), toScreen(bottomRight.x(), bottomRight.y())), image, aligned);
+}
+
+// draws every visible point, or returns false when the view is too far out for that
+bool ScatterPlotWidget::drawPoints(QPainter &painter)
+{
+    double cellPixels = m_scale * std::min(m_data->cellWidth(), m_data->cellHeight());
+    if (cellPixels < 4.0)
+        return false;
+
+    // cells of one grid row are contiguous in `order`
+    QRect cells = visibleCells();
+    const int grid = ScatterPlotData::GridSize;
+    qsizetype visible = 0;
+    for (int row = cells.top(); row <= cells.bottom(); ++row)
+        visible += m_data->cellStart[row * grid + cells.right() + 1] - m_data->cellStart[row * grid + cells.left()];
+    if (visible > MaxDrawnPoints)
+        return false;
+
+    QVector<QVector<QPointF>> byCluster(m_data->numClusters + 1);
+    for (int row = cells.top(); row <= cells.bottom(); ++row) {
+        for (int k = m_data->cellStart[row * grid + cells.left()]; k < m_data->cellStart[row * grid + cells.right() + 1]; ++k) {
+            int i = m_data->order[k];
+            byCluster[m_data->cluster[i] < 0 ? m_data->numClusters : m_data->cluster[i]].append(toScreen(m_data->x[i], m_data->y[i]));
+        }
+    }
+    for (int c = 0; c < byCluster.size(); ++c) {
+        if (byCluster[c].isEmpty())
+            continue;
+        painter.setPen(QPen(clusterColor(c == m_data->numClusters ? -1 : c), 3));
+        painter.drawPoints(byCluster[c].constData(), byCluster[c].size());
+    }
+    return true;
+}
+
+// nearest point within HoverRadius pixels of `screen`
+int ScatterPlotWidget::pointAt(const QPointF &screen) const
+{
+    if (!m_data || m_data->size() == 0)
+        return -1;
+    QPointF world = toWorld(screen);
+    return m_data->tree.nearest(world.x(), world.y(), HoverRadius / m_scale);
+}
+
+// points inside the lasso, tested in world coordinates against the tree
+void ScatterPlotWidget::finishLasso()
+{
+    m_lassoing = false;
+    std::vector<KDTree2D::Vertex> polygon;
+    polygon.reserve(m_lasso.size());
+    for (const QPointF &vertex : std::as_const(m_lasso)) {
+        QPointF world = toWorld(vertex);
+        polygon.push_back({static_cast<float>(world.x()), static_cast<float>(world.y())});
+    }
+    m_lasso.clear();
+    std::vector<int> inside = m_data ? m_data->tree.inPolygon(polygon) : std::vector<int>();
+    m_selection = QVector<int>(inside.cbegin(), inside.cend());
+    update();
+    emit selectionChanged(m_selection);
+}
+
+void ScatterPlotWidget::setHovered(int index)
+{
+    if (index == m_hovered)
+        return;
+    m_hovered = index;
+    update();
+    emit pointHovered(index);
+}
+
+// zoom around the cursor: the world point under it stays in place
+void ScatterPlotWidget::wheelEvent(QWheelEvent *event)
+{
+    QPointF anchor = toWorld(event->position());
+    m_scale *= std::pow(1.0015, event->angleDelta().y());
+    m_viewMoved = true;
+    QPointF offset = event->position() - QPointF(width() / 2.0, height() / 2.0);
+    m_center = anchor - offset / m_scale;
+    update();
+}
+
+void ScatterPlotWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton && (event->modifiers() & Qt::ShiftModifier)) {
+        m_lassoing = true;
+        m_lasso = QPolygonF({event->position()});
+        setHovered(-1);
+    } else if (event->button() == Qt::LeftButton) {
+        m_dragging = true;
+        m_lastDrag = event->position().toPoint();
+    } else if (event->button() == Qt::RightButton) {
+        resetView();
+    }
+}
+
+void ScatterPlotWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if (m_lassoing) {
+        // skip vertices closer than a few pixels, a slow drag would otherwise add one per mouse event
+        if (QLineF(m_lasso.last(), event->position()).length() >= 3.0) {
+            m_lasso.append(event->position());
+            update();
+        }
+        return;
+    }
+    if (m_dragging) {
+        QPoint delta = event->position().toPoint() - m_lastDrag;
+        m_lastDrag = event->position().toPoint();
+        m_center -= QPointF(delta) / m_scale;
+        m_viewMoved = true;
+        update();
+        return;
+    }
+    setHovered(pointAt(event->position()));
+}
+
+void ScatterPlotWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton)
+        return;
+    m_dragging = false;
+    if (m_lassoing)
+        finishLasso();
+}
+
+void ScatterPlotWidget::leaveEvent(QEvent *)
+{
+    setHovered(-1);
+}
+
+// the whole plot stays fitted to the widget until the user pans or zooms
+void ScatterPlotWidget::resizeEvent(QResizeEvent *)
+{
+    if (!m_viewMoved)
+        resetView();
+}
@@ -0,0 +1,103 @@
+#ifndef SCATTERPLOTWIDGET_H
+#define SCATTERPLOTWIDGET_H
+
+#include "../src/index_core/KDTree2D.hpp"
+#include <QColor>
+#include <QImage>
+#include <QPolygonF>
+#include <QRectF>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+#include <QWidget>
+
+// Points of a 2D projection prepared for drawing at any zoom level.
+// Points are bucketed into a GridSize x GridSize grid over their bounds (sorted by cell, so the points of a
+// cell are contiguous), and every pyramid level holds a density image where one pixel is one cell,
+// levels[0] at the grid resolution and each next level half the size. Hover and lasso queries go through
+// a k-d tree over the same points.
+struct ScatterPlotData
+{
+    static const int GridSize = 1024;
+
+    QVector<float> x;
+    QVector<float> y;
+    QVector<int> cluster;
+    int numClusters = 0;
+    QRectF bounds;
+
+    QVector<int> cellStart; // points of cell c are order[cellStart[c] .. cellStart[c + 1])
+    QVector<int> order;
+    QVector<QImage> levels;
+    KDTree2D tree;
+
+    int size() const { return x.size(); }
+    double cellWidth() const { return bounds.width() / GridSize; }
+    double cellHeight() const { return bounds.height() / GridSize; }
+    int cellColumn(double px) const;
+    int cellRow(double py) const;
+
+    static QSharedPointer<ScatterPlotData> build(QVector<float> x, QVector<float> y, QVector<int> cluster);
+    // tsneClustered.csv written by clusterTSNE: cluster_id,distance,x0,x1
+    static QSharedPointer<ScatterPlotData> loadClusteredCsv(const QString &path);
+};
+
+// Pan (drag), zoom (wheel), hover and lasso (shift + drag) view of a ScatterPlotData.
+// Far out the density image of the matching pyramid level is drawn, so the cost does not depend on the
+// number of points; once few enough points are visible they are drawn one by one.
+class ScatterPlotWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ScatterPlotWidget(QWidget *parent = nullptr);
+
+    void setData(QSharedPointer<const ScatterPlotData> data);
+    QSharedPointer<const ScatterPlotData> data() const { return m_data; }
+    void resetView();
+    const QVector<int> &selection() const { return m_selection; }
+    void clearSelection();
+
+    static QColor clusterColor(int cluster);
+
+signals:
+    // index of the point under the cursor, -1 when there is none
+    void pointHovered(int index);
+    // indices of the points inside a finished lasso, ascending
+    void selectionChanged(const QVector<int> &indices);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void leaveEvent(QEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    static const int MaxDrawnPoints = 150000;
+    static const int HoverRadius = 6;
+
+    QSharedPointer<const ScatterPlotData> m_data;
+    QPointF m_center;      // world coordinates at the middle of the widget
+    double m_scale = 1.0;  // pixels per world unit
+    QPoint m_lastDrag;
+    bool m_dragging = false;
+    bool m_viewMoved = false;
+    int m_hovered = -1;
+    QPolygonF m_lasso;     // screen vertices while a lasso is drawn
+    bool m_lassoing = false;
+    QVector<int> m_selection;
+
+    QPointF toScreen(double x, double y) const;
+    QPointF toWorld(const QPointF &screen) const;
+    QRect visibleCells() const;
+    void drawDensity(QPainter &painter);
+    bool drawPoints(QPainter &painter);
+    int pointAt(const QPointF &screen) const;
+    void finishLasso();
+    void setHovered(int index);
+};
+
+#endif // SCATTERPLOTWIDGET_H
@@ -1,22 +1,81 @@
 #include "searchwindow.h"
 #include "ui_searchwindow.h"
-#include <QFile>
-#include <QTextStream>
+#include "commentstore.h"
 #include <QDebug>
 #include <QListWidgetItem>
 
 
+namespace {
+
+const int ResultLimit = 30;
+const int BatchSize = 10;
+
+// hands the texts of `rows` to the window in small batches, so the first ones show up right away
+void deliverRows(const QueryRunner::Token &token, const QVector<int> &rows)
+{
+    const CommentStore &store = CommentStore::instance();
+    const CommentTable &table = store.comments();
+    QStringList batch;
+    for (int row : rows) {
+        if (token.isCancelled())
+            return;
+        if (row < table.size())
+            batch.append(store.text(table, row).toString());
+        if (batch.size() == BatchSize) {
+            token.deliver(batch);
+            batch.clear();
+        }
+    }
+    if (!batch.isEmpty())
+        token.deliver(batch);
+}
+
+// nearest comments by embedding; only the clusters closest to the query are scanned
+QVector<int> findSimilar(const QString &text, const QList<QSharedPointer<QueryEncoder>> &encoders, const QueryRunner::Token &token)
+{
+    const SemanticSearcher &searcher = CommentStore::instance().semanticSearcher();
+    QVector<int> rows;
+    QVector<double> query;
+    for (const QSharedPointer<QueryEncoder> &encoder : encoders) {
+        if (token.isCancelled())
+            return rows;
+        query = encoder->encode(text);
+        if (!query.isEmpty())
+            break;
+    }
+    if (query.size() != searcher.dimension()) {
+        qDebug() << "No query embedding of dimension" << searcher.dimension() << "for" << text;
+        return rows;
+    }
+    for (const auto &hit : searcher.search(query, ResultLimit, 8))
+        rows.append(hit.first);
+    return rows;
+}
+
+} // namespace
+
 searchwindow::searchwindow(QWidget *parent)
     : QDialog(parent)
     , ui(new Ui::searchwindow)
+    , runner(new QueryRunner(this))
 
 {
     ui->setupUi(this);
     setWindowTitle("Search Window");
+
+    const CommentStore &store = CommentStore::instance();
+    ui->semanticCheckBox->setEnabled(store.semanticSearcher().isOpen() && !store.queryEncoders().isEmpty());
+
+    connect(runner, &QueryRunner::batchReady, this, &searchwindow::appendResults);
+    connect(runner, &QueryRunner::finished, this, [this]() {
+        if (ui->resultsListWidget->count() == 0)
+            ui->resultsListWidget->addItem(new QListWidgetItem("No comments found"));
+    });
 }
 
 searchwindow::~searchwindow()
 {
+    runner->cancel();
     delete ui;
 }
 
@@ -26,48 +85,33 @@ void searchwindow::on_searchButton_clicked()
     loadAndDisplayData(searchTerm);
 }
 
+// Queries run on the thread pool; a new search cancels the one still running.
 void searchwindow::loadAndDisplayData(const QString &searchTerm)
 
 {
-    QFile file(":/smalldata.csv");
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qDebug() << "Could not open the file!";
-        return;
-    }
-
-    QTextStream in(&file);
-    QVector<QString> comments;
-
-    while (!in.atEnd()) {
-        QString line = in.readLine();
-        int firstCommaIndex = line.indexOf(',');
-        // if (firstCommaIndex == -1) {
-        //     qDebug() << "Skipping invalid line:" << line;
-        //     continue;
-        // }
+    ui->resultsListWidget->clear(); // Clear the previous list
 
-        QString comment = line.mid(firstCommaIndex + 1); // Capture the comment after the first comma
-        if (comment.contains(searchTerm, Qt::CaseInsensitive)) {
-            comments.append(comment);
-        }
-        if (comments.size() >= 30) {
-            break;
+    bool semantic = ui->semanticCheckBox->isChecked();
+    InvertedIndex::RankKey rankKey = ui->rankComboBox->currentIndex() == 1 ? InvertedIndex::RankBySentiment : InvertedIndex::RankByScore;
+    QList<QSharedPointer<QueryEncoder>> queryEncoders = CommentStore::instance().queryEncoders();
+    runner->start([searchTerm, semantic, rankKey, queryEncoders](const QueryRunner::Token &token) {
+        const CommentStore &store = CommentStore::instance();
+        QVector<int> rows;
+        if (semantic) {
+            rows = findSimilar(searchTerm, queryEncoders, token);
+        } else {
+            // all terms must match, "quoted words" must appear as a phrase; best scored (or most positive) comments first
+            rows = store.searchIndex().search(searchTerm, ResultLimit, rankKey);
         }
-    }
-
-    file.close();
-
-    qDebug() << "Found comments:" << comments;
-
-    ui->resultsListWidget->clear(); // Clear the previous list
-    int i = 0;
+        deliverRows(token, rows);
+    });
+}
 
+void searchwindow::appendResults(const QStringList &comments)
+{
     for (const QString &comment : comments) {
         QListWidgetItem *item = new QListWidgetItem(comment);
         item->setFlags(item->flags() & ~Qt::ItemIsEditable); // Make the item read-only
         ui->resultsListWidget->addItem(item);
-        qDebug() << i++;
     }
-
-    qDebug() << "Displayed comments in the list widget.";
 }
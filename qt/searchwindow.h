@@ -1,6 +1,7 @@
 #ifndef searchwindow_H
 #define searchwindow_H
 
+#include "queryrunner.h"
 #include <QDialog>
 
 namespace Ui {
@@ -20,7 +21,9 @@ private slots:
 
 private:
     Ui::searchwindow *ui;
+    QueryRunner *runner;
     void loadAndDisplayData(const QString &searchTerm);
+    void appendResults(const QStringList &comments);
 };
 
 #endif // searchwindow_H
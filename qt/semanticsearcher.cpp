@@ -0,0 +1,34 @@
+#include "semanticsearcher.h"
+#include "../src/data_processing/SemanticSearch.hpp"
+#include <QDebug>
+
+SemanticSearcher::SemanticSearcher() = default;
+SemanticSearcher::~SemanticSearcher() = default;
+
+bool SemanticSearcher::open(const QString &path)
+{
+    // tryLoad checks the whole file and never exits, a bad index only turns the semantic search off
+    auto index = std::make_unique<SemanticIndex>();
+    std::string error;
+    if (!index->tryLoad(path.toStdString(), &error)) {
+        qDebug() << "No semantic index:" << QString::fromStdString(error);
+        return false;
+    }
+    m_index = std::move(index);
+    return true;
+}
+
+int SemanticSearcher::dimension() const
+{
+    return m_index ? m_index->dimension() : 0;
+}
+
+QVector<QPair<int, double>> SemanticSearcher::search(const QVector<double> &query, int k, int nprobe) const
+{
+    QVector<QPair<int, double>> result;
+    if (!m_index || query.size() != m_index->dimension())
+        return result;
+    for (const auto &hit : m_index->search(Point(std::vector<double>(query.begin(), query.end())), k, nprobe))
+        result.append(qMakePair(hit.first, hit.second));
+    return result;
+}
@@ -0,0 +1,30 @@
+#ifndef SEMANTICSEARCHER_H
+#define SEMANTICSEARCHER_H
+
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+class SemanticIndex;
+
+// Qt side of the core SemanticIndex (src/data_processing/SemanticSearch.hpp): nearest centroids first,
+// then an exact scan of those clusters' embeddings. Rows are rows of CommentStore::comments().
+class SemanticSearcher
+{
+public:
+    SemanticSearcher();
+    ~SemanticSearcher();
+
+    bool open(const QString &path);
+    bool isOpen() const { return m_index != nullptr; }
+    int dimension() const;
+
+    // (row, distance) of the k nearest comments, scanning the nprobe nearest clusters
+    QVector<QPair<int, double>> search(const QVector<double> &query, int k, int nprobe) const;
+
+private:
+    std::unique_ptr<SemanticIndex> m_index;
+};
+
+#endif // SEMANTICSEARCHER_H
@@ -0,0 +1,134 @@
+#include "yearmaprenderer.h"
+#include <QFont>
+#include <QFontMetrics>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QPainterPath>
+#include <algorithm>
+#include <cmath>
+
+YearMapRenderer::YearMapRenderer(QSharedPointer<const ScatterPlotData> points, const QVector<int> &day, const QVector<int> &year,
+                                 const QMap<int, QString> &clusterNames)
+    : m_points(points)
+    , m_clusterNames(clusterNames)
+    , m_cache(64 * 1024 * 1024) // bytes of cached images
+{
+    const int rows = std::min({static_cast<int>(points->size()), static_cast<int>(day.size()), static_cast<int>(year.size())});
+    QVector<QPair<int, int>> dated;
+    dated.reserve(rows);
+    for (int row = 0; row < rows; ++row) {
+        if (year[row] >= 0)
+            dated.append(qMakePair(day[row], row));
+    }
+    std::sort(dated.begin(), dated.end());
+    m_order.reserve(dated.size());
+    m_days.reserve(dated.size());
+    for (const auto &entry : std::as_const(dated)) {
+        m_days.append(entry.first);
+        m_order.append(entry.second);
+    }
+
+    // every range is drawn over the faint map of all points, taken from the density pyramid
+    m_background = QImage(ImageSize, ImageSize, QImage::Format_ARGB32_Premultiplied);
+    m_background.fill(Qt::white);
+    if (points->levels.size() > 1) {
+        QPainter painter(&m_background);
+        painter.setOpacity(0.2);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        painter.drawImage(QRect(0, 0, ImageSize, ImageSize), points->levels[1]);
+    }
+}
+
+QImage YearMapRenderer::render(int fromDay, int toDay, const QVector<int> &labelled)
+{
+    QPair<int, int> key(fromDay, toDay);
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        if (QImage *cached = m_cache.object(key))
+            return *cached;
+    }
+    QImage image = draw(fromDay, toDay, labelled);
+    QMutexLocker locker(&m_cacheMutex);
+    m_cache.insert(key, new QImage(image), image.sizeInBytes());
+    return image;
+}
+
+// one pass over the points of the range: per pixel count and summed cluster colors, per cluster the center
+QImage YearMapRenderer::draw(int fromDay, int toDay, const QVector<int> &labelled) const
+{
+    const ScatterPlotData &data = *m_points;
+    const int from = std::lower_bound(m_days.cbegin(), m_days.cend(), fromDay) - m_days.cbegin();
+    const int to = std::lower_bound(m_days.cbegin(), m_days.cend(), toDay) - m_days.cbegin();
+
+    const int pixels = ImageSize * ImageSize;
+    QVector<float> count(pixels, 0.0f), red(pixels, 0.0f), green(pixels, 0.0f), blue(pixels, 0.0f);
+    QVector<QColor> colors(data.numClusters + 1);
+    for (int c = 0; c <= data.numClusters; ++c)
+        colors[c] = ScatterPlotWidget::clusterColor(c == data.numClusters ? -1 : c);
+    QVector<double> sumX(data.numClusters, 0.0), sumY(data.numClusters, 0.0);
+    QVector<int> clusterCount(data.numClusters, 0);
+
+    const double scaleX = ImageSize / data.bounds.width(), scaleY = ImageSize / data.bounds.height();
+    for (int k = from; k < to; ++k) {
+        int i = m_order[k];
+        int column = std::clamp(static_cast<int>((data.x[i] - data.bounds.left()) * scaleX), 0, ImageSize - 1);
+        int row = std::clamp(static_cast<int>((data.y[i] - data.bounds.top()) * scaleY), 0, ImageSize - 1);
+        int p = row * ImageSize + column;
+        int c = data.cluster[i] < 0 ? data.numClusters : data.cluster[i];
+        count[p] += 1;
+        red[p] += colors[c].red();
+        green[p] += colors[c].green();
+        blue[p] += colors[c].blue();
+        if (c < data.numClusters) {
+            sumX[c] += data.x[i];
+            sumY[c] += data.y[i];
+            clusterCount[c] += 1;
+        }
+    }
+
+    QImage density(ImageSize, ImageSize, QImage::Format_ARGB32_Premultiplied);
+    density.fill(Qt::transparent);
+    float logMax = std::log1p(std::max(*std::max_element(count.cbegin(), count.cend()), 1.0f));
+    for (int row = 0; row < ImageSize; ++row) {
+        QRgb *line = reinterpret_cast<QRgb *>(density.scanLine(row));
+        for (int column = 0; column < ImageSize; ++column) {
+            int p = row * ImageSize + column;
+            if (count[p] == 0)
+                continue;
+            int alpha = 110 + static_cast<int>(145 * std::log1p(count[p]) / logMax);
+            line[column] = qPremultiply(qRgba(static_cast<int>(red[p] / count[p]), static_cast<int>(green[p] / count[p]),
+                                              static_cast<int>(blue[p] / count[p]), alpha));
+        }
+    }
+
+    QImage image = m_background.copy();
+    QPainter painter(&image);
+    painter.drawImage(0, 0, density);
+
+    // labels at the center of each cluster's points in the range, with a halo so they read over the points
+    painter.setRenderHint(QPainter::Antialiasing);
+    QFont font = painter.font();
+    font.setPointSize(13);
+    font.setBold(true);
+    QFontMetrics metrics(font);
+    for (int rank = 0; rank < labelled.size(); ++rank) {
+        int c = labelled[rank];
+        if (c < 0 || c >= data.numClusters || clusterCount[c] == 0)
+            continue;
+        // elided to the image width minus the margins, so the clamp below always has lo <= hi
+        QString text = metrics.elidedText(QString("%1. %2").arg(rank + 1).arg(m_clusterNames.value(c, QString::number(c))), Qt::ElideRight,
+                                          ImageSize - 8);
+        QPointF center((sumX[c] / clusterCount[c] - data.bounds.left()) * scaleX, (sumY[c] / clusterCount[c] - data.bounds.top()) * scaleY);
+        int width = metrics.horizontalAdvance(text);
+        QPointF baseline(std::clamp(center.x() - width / 2.0, 4.0, ImageSize - width - 4.0),
+                         std::clamp(center.y(), static_cast<double>(metrics.ascent() + 4), ImageSize - metrics.descent() - 4.0));
+        QPainterPath path;
+        path.addText(baseline, font, text);
+        painter.strokePath(path, QPen(Qt::white, 4));
+        painter.fillPath(path, Qt::black);
+    }
+
+    painter.setPen(Qt::black);
+    painter.drawText(QPointF(8, 8 + QFontMetrics(painter.font()).ascent()), QString("%1 comments").arg(to - from));
+    return image;
+}
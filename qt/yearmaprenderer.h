@@ -0,0 +1,46 @@
+#ifndef YEARMAPRENDERER_H
+#define YEARMAPRENDERER_H
+
+#include "scatterplotwidget.h"
+#include <QCache>
+#include <QImage>
+#include <QMap>
+#include <QMutex>
+#include <QPair>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+// Draws the cluster map of any range of days from the 2D points, replacing pre-rendered year images.
+// Rows are sorted by day once, so a range is one contiguous slice and rendering only touches its points;
+// finished images are cached per range. render() may be called from any thread.
+class YearMapRenderer
+{
+public:
+    static const int ImageSize = 768;
+
+    // row i of `points` has `day[i]` (days since 1970-01-01), rows with `year[i] < 0` have no date
+    YearMapRenderer(QSharedPointer<const ScatterPlotData> points, const QVector<int> &day, const QVector<int> &year,
+                    const QMap<int, QString> &clusterNames);
+
+    // points of days [fromDay, toDay) over the faint map of all points, `labelled` clusters named in rank order;
+    // a range is cached with the labels of its first render
+    QImage render(int fromDay, int toDay, const QVector<int> &labelled);
+
+    int firstDay() const { return m_days.isEmpty() ? 0 : m_days.first(); }
+    int lastDay() const { return m_days.isEmpty() ? -1 : m_days.last(); }
+
+private:
+    QSharedPointer<const ScatterPlotData> m_points;
+    QMap<int, QString> m_clusterNames;
+    QVector<int> m_order; // dated rows sorted by day
+    QVector<int> m_days;  // day of m_order[k]
+    QImage m_background;
+
+    QMutex m_cacheMutex;
+    QCache<QPair<int, int>, QImage> m_cache;
+
+    QImage draw(int fromDay, int toDay, const QVector<int> &labelled) const;
+};
+
+#endif // YEARMAPRENDERER_H
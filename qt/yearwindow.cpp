@@ -1,5 +1,6 @@
 #include "yearwindow.h"
 #include "ui_yearwindow.h"
+#include "commentstore.h"
 #include <QFile>
 #include <QTextStream>
 #include <QHeaderView>
@@ -9,6 +10,9 @@
 #include <QDateTime>
 #include <algorithm>
 #include <QDebug>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QtConcurrent/QtConcurrent>
 
 yearwindow::yearwindow(QWidget *parent)
     : QDialog(parent)
@@ -16,14 +20,33 @@ yearwindow::yearwindow(QWidget *parent)
 {
     ui->setupUi(this);
     setWindowTitle("Year Window");
-    loadData();
     initializeClusterNames();
-
+    connect(&countWatcher, &QFutureWatcher<YearClusterCounts>::finished, this, [this]() {
+        yearClusterData = countWatcher.result();
+        ui->showHtmlButton->setEnabled(true);
+    });
+    connect(&rendererWatcher, &QFutureWatcher<QSharedPointer<YearMapRenderer>>::finished, this, [this]() {
+        mapRenderer = rendererWatcher.result();
+        if (pendingMapYear >= 0)
+            showMap(pendingMapYear, topClusters(pendingMapYear, 5));
+    });
+    connect(&imageWatcher, &QFutureWatcher<QImage>::finished, this, [this]() {
+        QPixmap pixmap = QPixmap::fromImage(imageWatcher.result());
+        ui->imageLabel->setPixmap(pixmap.scaled(ui->imageLabel->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
+    });
+    ui->imageLabel->setAlignment(Qt::AlignCenter);
+    ui->imageLabel->clear();
+    if (!openTimeCube())
+        loadData();
+    populateYears();
+    startMapRenderer();
 }
 
 yearwindow::~yearwindow()
 
 {
+    rendererWatcher.waitForFinished();
+    imageWatcher.waitForFinished();
     delete ui;
 }
 
@@ -56,50 +79,129 @@ void yearwindow::initializeClusterNames()
     clusterNames.insert(24, "Religion");
 }
 
-void yearwindow::loadData()
+// The cube is written offline by BuildTimeCube; any year is two rows of its prefix sums.
+bool yearwindow::openTimeCube()
 {
-    QFile file(":/smalldata.csv");
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    QSettings settings("clustering_tweets", "qt_project");
+    QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/time_cube.bin";
+    timeCubeFile.setFileName(settings.value("year/timeCube", defaultPath).toString());
+    if (!timeCubeFile.open(QIODevice::ReadOnly))
     {
-        QMessageBox::critical(this, "Error", "Could not open CSV file.");
-        return;
+        qDebug() << "No time cube at" << timeCubeFile.fileName() << ", counting comments per year";
+        return false;
     }
 
-    QTextStream in(&file);
-    while (!in.atEnd())
+    const char *data = reinterpret_cast<const char *>(timeCubeFile.map(0, timeCubeFile.size()));
+    if (!data)
     {
-        QString line = in.readLine();
-        QStringList fields = line.split(',');
-        if (fields.size() < 3)
-            continue;
-
-        int year = static_cast<int>(fields[0].toFloat());
-        int clusterId = fields[2].toInt();
+        timeCubeBuffer = timeCubeFile.readAll();
+        data = timeCubeBuffer.constData();
+    }
+    if (!timeCube.open(data, static_cast<size_t>(timeCubeFile.size())))
+    {
+        qDebug() << "Invalid time cube" << timeCubeFile.fileName();
+        return false;
+    }
+    return true;
+}
 
+// Fallback without a time cube: count the loaded comments per year on the thread pool.
+void yearwindow::loadData()
+{
+    const CommentStore &store = CommentStore::instance();
+    if (!store.isLoaded())
+    {
+        QMessageBox::critical(this, "Error", "Comments are not loaded yet.");
+        return;
+    }
 
+    ui->showHtmlButton->setEnabled(false);
+    countWatcher.setFuture(QtConcurrent::run(&yearwindow::countYearClusters));
+}
 
-        yearClusterData[year].append(qMakePair(clusterId, 1));
+yearwindow::YearClusterCounts yearwindow::countYearClusters()
+{
+    const CommentTable &comments = CommentStore::instance().comments();
+    QMap<int, QMap<int, int>> clusterCounts;
+    for (int row = 0; row < comments.size(); ++row)
+    {
+        if (comments.year[row] < 0)
+            continue;
+        clusterCounts[comments.year[row]][comments.clusterId[row]] += 1;
     }
-    file.close();
 
-    for (auto &yearClusters : yearClusterData)
+    YearClusterCounts result;
+    for (auto yearIt = clusterCounts.constBegin(); yearIt != clusterCounts.constEnd(); ++yearIt)
     {
-        QMap<int, int> clusterCounts;
-        for (const auto &cluster : yearClusters)
+        QVector<QPair<int, int>> &yearClusters = result[yearIt.key()];
+        for (auto it = yearIt.value().constBegin(); it != yearIt.value().constEnd(); ++it)
         {
-            clusterCounts[cluster.first] += cluster.second;
+            yearClusters.append(qMakePair(it.key(), it.value()));
         }
-        yearClusters.clear();
-        for (auto it = clusterCounts.begin(); it != clusterCounts.end(); ++it)
+    }
+    return result;
+}
+
+// every year the data covers, so new data needs no change to the window
+void yearwindow::populateYears()
+{
+    int firstYear = 0, lastYear = -1, month, day;
+    if (timeCube.isOpen() && timeCube.numDays() > 0)
+    {
+        civilFromDays(timeCube.firstDay(), firstYear, month, day);
+        civilFromDays(timeCube.firstDay() + timeCube.numDays() - 1, lastYear, month, day);
+    }
+    else
+    {
+        const CommentTable &comments = CommentStore::instance().comments();
+        for (int year : comments.year)
         {
-            yearClusters.append(qMakePair(it.key(), it.value()));
+            if (year < 0)
+                continue;
+            firstYear = lastYear < firstYear ? year : std::min(firstYear, year);
+            lastYear = std::max(lastYear, year);
         }
     }
+    if (lastYear < firstYear)
+        return;
+    ui->yearComboBox->clear();
+    for (int year = firstYear; year <= lastYear; ++year)
+        ui->yearComboBox->addItem(QString::number(year));
+}
+
+// Sorting the rows by day and preparing the background map takes a moment, so it runs on the thread pool.
+void yearwindow::startMapRenderer()
+{
+    if (CommentStore::instance().comments().x.isEmpty())
+        return;
+    QMap<int, QString> names = clusterNames;
+    rendererWatcher.setFuture(QtConcurrent::run([names]() {
+        const CommentTable &comments = CommentStore::instance().comments();
+        QSharedPointer<ScatterPlotData> points = ScatterPlotData::build(comments.x, comments.y, comments.clusterId);
+        return QSharedPointer<YearMapRenderer>::create(points, comments.day, comments.year, names);
+    }));
+}
 
-    for (auto it = yearClusterData.constBegin(); it != yearClusterData.constEnd(); ++it)
+void yearwindow::showMap(int year, const QVector<int> &clusters)
+{
+    pendingMapYear = -1;
+    if (!mapRenderer)
     {
-        qDebug() << "Year:" << it.key() << "Clusters:" << it.value();
+        if (rendererWatcher.isRunning())
+        {
+            pendingMapYear = year;
+            ui->imageLabel->setText("Preparing the map...");
+        }
+        else
+        {
+            ui->imageLabel->setText("No map: the dataset bundle has no t-SNE coordinates.");
+        }
+        return;
     }
+    QSharedPointer<YearMapRenderer> renderer = mapRenderer;
+    imageWatcher.setFuture(QtConcurrent::run([renderer, year, clusters]() {
+        return renderer->render(TimeCubeView::yearStart(year), TimeCubeView::yearStart(year + 1), clusters);
+    }));
 }
 
 void yearwindow::on_showHtmlButton_clicked()
@@ -109,9 +211,29 @@ void yearwindow::on_showHtmlButton_clicked()
     updateTableAndImage(year);
 }
 
+QVector<int> yearwindow::topClusters(int year, int count)
+{
+    QVector<int> result;
+    if (timeCube.isOpen())
+    {
+        for (int cluster : timeCube.topClusters(TimeCubeView::yearStart(year), TimeCubeView::yearStart(year + 1), count))
+            result.append(cluster);
+        return result;
+    }
+
+    auto clusters = yearClusterData.value(year);
+    std::sort(clusters.begin(), clusters.end(), [](const auto &a, const auto &b) {
+        return a.second > b.second;
+    });
+    for (int i = 0; i < std::min(count, static_cast<int>(clusters.size())); ++i)
+        result.append(clusters[i].first);
+    return result;
+}
+
 void yearwindow::updateTableAndImage(int year)
 {
-    if (!yearClusterData.contains(year) || yearClusterData[year].isEmpty())
+    QVector<int> clusters = topClusters(year, 5);
+    if (clusters.isEmpty())
     {
         ui->tableWidget->setRowCount(0);
         ui->imageLabel->clear();
@@ -119,12 +241,7 @@ void yearwindow::updateTableAndImage(int year)
         return;
     }
 
-    auto clusters = yearClusterData[year];
-    std::sort(clusters.begin(), clusters.end(), [](const auto &a, const auto &b) {
-        return a.second > b.second;
-    });
-
-    int rowCount = std::min(5, static_cast<int>(clusters.size()));
+    int rowCount = static_cast<int>(clusters.size());
     ui->tableWidget->setRowCount(rowCount);
     ui->tableWidget->setColumnCount(1);
     ui->tableWidget->setColumnWidth(0, 600);
@@ -132,21 +249,9 @@ void yearwindow::updateTableAndImage(int year)
 
     for (int i = 0; i < rowCount; ++i)
     {
-        QString clusterName = clusterNames.value(clusters[i].first, QString::number(clusters[i].first));
+        QString clusterName = clusterNames.value(clusters[i], QString::number(clusters[i]));
         ui->tableWidget->setItem(i, 0, new QTableWidgetItem(clusterName));
     }
 
-    QString imagePath = QString(":/photos/%1.png").arg(year);
-    if (QFile::exists(imagePath))
-    {
-        QPixmap pixmap(imagePath);
-
-        ui->imageLabel->setPixmap(pixmap.scaled(width(), height(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
-        ui->imageLabel->setScaledContents(true);
-    }
-    else
-    {
-        ui->imageLabel->clear();
-        QMessageBox::warning(this, "Image not found", QString("No image found for year %1").arg(year));
-    }
+    showMap(year, clusters);
 }
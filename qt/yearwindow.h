@@ -10,6 +10,13 @@
 #include <QMap>
 #include <QVector>
 #include <QPair>
+#include <QFile>
+#include <QByteArray>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QSharedPointer>
+#include "yearmaprenderer.h"
+#include "../src/data_processing/TimeCube.hpp"
 
 namespace Ui {
 class layout;
@@ -37,10 +44,25 @@ private:
     QLabel *imageLabel;
     QTableWidget *tableWidget;
 
-    QMap<int, QVector<QPair<int, int>>> yearClusterData;
+    using YearClusterCounts = QMap<int, QVector<QPair<int, int>>>;
+    YearClusterCounts yearClusterData;
+    QFutureWatcher<YearClusterCounts> countWatcher;
     QMap<int, QString> clusterNames;
+    QFile timeCubeFile;
+    QByteArray timeCubeBuffer; // only used when the file cannot be mapped
+    TimeCubeView timeCube;
+    QSharedPointer<YearMapRenderer> mapRenderer;
+    QFutureWatcher<QSharedPointer<YearMapRenderer>> rendererWatcher;
+    QFutureWatcher<QImage> imageWatcher;
+    int pendingMapYear = -1; // asked for before the renderer was ready
 
+    bool openTimeCube();
     void loadData();
+    void populateYears();
+    void startMapRenderer();
+    void showMap(int year, const QVector<int> &clusters);
+    static YearClusterCounts countYearClusters();
+    QVector<int> topClusters(int year, int count);
     void updateTableAndImage(int year);
     void initializeClusterNames();
 };
@@ -0,0 +1,168 @@
+#include "../clustering_core/modules/ReadData.hpp"
+#include "CentroidAssigner.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Long-running assigner for new comments.
+ *
+ * Loads the centroids once and answers requests on stdin, one per line:
+ *     <request id>,<x0>,<x1>,...,<xD-1>
+ * and replies on stdout, in request order:
+ *     <request id>,<cluster_id>,<distance>,<next cluster_id>,<next distance>,...
+ * or "<request id>,error,<message>" for malformed requests.
+ *
+ * Requests arriving close together are coalesced into one batch (up to --batch requests, waiting at most
+ * --wait-us microseconds after the first one), so the centroid matrix is streamed once per batch.
+ * Throughput and latency percentiles (over the last 65536 requests) are printed to stderr on end of input.
+ *
+ * usage: AssignService [centroids path] [--neighbors N] [--batch B] [--wait-us W]
+ */
+
+typedef std::chrono::steady_clock Clock;
+
+struct Request
+{
+    std::string line;
+    Clock::time_point arrival;
+};
+
+int main(int argc, char* argv[])
+{
+    std::string centroidsPath = "../../data/big_data/rowCentroids.csv";
+    int numNearest = 3;
+    size_t maxBatch = 256;
+    int waitMicros = 200;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--neighbors" && i + 1 < argc) { numNearest = std::stoi(argv[++i]); }
+        else if (arg == "--batch" && i + 1 < argc) { maxBatch = std::stoul(argv[++i]); }
+        else if (arg == "--wait-us" && i + 1 < argc) { waitMicros = std::stoi(argv[++i]); }
+        else { centroidsPath = arg; }
+    }
+
+    std::vector<Point> loaded = read_data(centroidsPath);
+    if (loaded.empty())
+    {
+        std::cerr << "File " << centroidsPath << " has no centroids" << std::endl;
+        exit(1);
+    }
+    CentroidMatrix centroids(loaded);
+    std::cerr << "Loaded " << centroids.rows() << " centroids of dimension " << centroids.dimension() << std::endl;
+
+    std::deque<Request> queue;
+    std::mutex queueLock;
+    std::condition_variable queueReady;
+    bool inputClosed = false;
+
+    std::thread reader([&]() {
+        std::string line;
+        while (std::getline(std::cin, line))
+        {
+            if (line.empty()) { continue; }
+            std::lock_guard<std::mutex> guard(queueLock);
+            queue.push_back({line, Clock::now()});
+            queueReady.notify_one();
+        }
+        std::lock_guard<std::mutex> guard(queueLock);
+        inputClosed = true;
+        queueReady.notify_one();
+    });
+
+    LatencyStats latency;
+    size_t batches = 0;
+    Clock::time_point firstArrival;
+    std::vector<Request> batch;
+    std::vector<double> queries;
+    std::vector<std::string> ids;
+    std::vector<std::string> errors;
+
+    while (true)
+    {
+        batch.clear();
+        {
+            std::unique_lock<std::mutex> guard(queueLock);
+            queueReady.wait(guard, [&]() { return !queue.empty() || inputClosed; });
+            if (queue.empty()) { break; }
+            // coalesce: give followers a short window to join the batch of the first request
+            auto deadline = queue.front().arrival + std::chrono::microseconds(waitMicros);
+            queueReady.wait_until(guard, deadline, [&]() { return queue.size() >= maxBatch || inputClosed; });
+            while (!queue.empty() && batch.size() < maxBatch)
+            {
+                batch.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+        }
+        if (batches == 0) { firstArrival = batch.front().arrival; }
+
+        queries.assign(batch.size() * centroids.stride(), 0.0);
+        ids.assign(batch.size(), "");
+        errors.assign(batch.size(), "");
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            std::istringstream iss(batch[i].line);
+            std::string value;
+            std::getline(iss, ids[i], ',');
+            int count = 0;
+            try
+            {
+                while (std::getline(iss, value, ','))
+                {
+                    if (count < centroids.dimension()) { queries[i * centroids.stride() + count] = std::stod(value); }
+                    count++;
+                }
+            }
+            catch (const std::exception&)
+            {
+                errors[i] = "not a number: " + value;
+                continue;
+            }
+            if (count != centroids.dimension())
+            {
+                errors[i] = "expected " + std::to_string(centroids.dimension()) + " values, got " + std::to_string(count);
+            }
+        }
+
+        std::vector<Assignment> result = centroids.assignBatch(queries.data(), batch.size(), numNearest);
+
+        // 9 significant digits like the iteration metrics; to_string would keep only 6 decimals
+        std::ostringstream out;
+        out << std::setprecision(9);
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            out << ids[i];
+            if (!errors[i].empty()) { out << ",error," << errors[i]; }
+            else
+            {
+                for (const auto& nearest: result[i].nearest) { out << "," << nearest.first << "," << nearest.second; }
+            }
+            out << "\n";
+        }
+        std::cout << out.str() << std::flush;
+
+        auto done = Clock::now();
+        for (const auto& request: batch) { latency.add(std::chrono::duration<double, std::micro>(done - request.arrival).count()); }
+        batches++;
+    }
+    reader.join();
+
+    if (latency.count() > 0)
+    {
+        double seconds = std::chrono::duration<double>(Clock::now() - firstArrival).count();
+        std::cerr << "Requests: " << latency.count() << ", batches: " << batches
+                  << ", mean batch: " << (double) latency.count() / batches << "\n"
+                  << "Throughput: " << latency.count() / seconds << " requests/s\n"
+                  << "Latency (us): p50 " << latency.percentile(50) << ", p90 " << latency.percentile(90)
+                  << ", p99 " << latency.percentile(99) << ", max " << latency.percentile(100) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+// CentroidAssigner.hpp
+#pragma once
+#include "../clustering_core/modules/structPoint.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Result of assigning one query: the nearest clusters sorted by distance, nearest[0] is the assigned cluster.
+ */
+struct Assignment
+{
+    std::vector<std::pair<int, double>> nearest;// (cluster_id, distance)
+
+    int cluster() const { return nearest.empty() ? -1 : nearest[0].first; }
+    double distance() const { return nearest.empty() ? 0.0 : nearest[0].second; }
+};
+
+/**
+ * @class CentroidMatrix
+ * @brief Centroids stored once in a dense row-major matrix for fast batched assignment.
+ *
+ * Rows are padded with zeros to a multiple of 8 doubles so the inner product loop runs over whole
+ * vector registers, and squared centroid norms are precomputed, so a distance costs a single dot product:
+ * |q - c|^2 = |q|^2 - 2 q.c + |c|^2.
+ */
+class CentroidMatrix
+{
+public:
+    static constexpr int ROW_ALIGNMENT = 8;
+
+    CentroidMatrix() : _rows(0), _dim(0), _stride(0) {}
+    CentroidMatrix(const std::vector<Point>& centroids)
+        : _rows(centroids.size()), _dim(centroids.empty() ? 0 : centroids[0].coords.size())
+    {
+        _stride = (_dim + ROW_ALIGNMENT - 1) / ROW_ALIGNMENT * ROW_ALIGNMENT;
+        _data.assign((size_t) _rows * _stride, 0.0);
+        _norms.resize(_rows);
+        _ids.resize(_rows);
+        for (int i = 0; i < _rows; i++)
+        {
+            std::copy(centroids[i].coords.begin(), centroids[i].coords.end(), _data.begin() + (size_t) i * _stride);
+            _norms[i] = dot(row(i), row(i));
+            _ids[i] = centroids[i].cluster_id >= 0 ? centroids[i].cluster_id : i;
+        }
+    }
+
+    int rows() const { return _rows; }
+    int dimension() const { return _dim; }
+    int stride() const { return _stride; }
+    const double* row(int i) const { return _data.data() + (size_t) i * _stride; }
+
+    /**
+     * Assigns `count` queries stored row-major with `stride()` doubles per row (padding must be zero).
+     * Every result holds the `numNearest` closest clusters.
+     */
+    std::vector<Assignment> assignBatch(const double* queries, size_t count, int numNearest) const
+    {
+        std::vector<Assignment> result(count);
+        // without centroids every result stays empty (cluster() == -1)
+        if (_rows == 0) { return result; }
+        numNearest = std::max(1, std::min(numNearest, _rows));
+        std::vector<std::pair<double, int>> distances(_rows);
+        for (size_t q = 0; q < count; q++)
+        {
+            const double* query = queries + q * _stride;
+            double queryNorm = dot(query, query);
+            for (int c = 0; c < _rows; c++)
+            {
+                distances[c] = {std::max(0.0, queryNorm - 2 * dot(query, row(c)) + _norms[c]), c};
+            }
+            std::partial_sort(distances.begin(), distances.begin() + numNearest, distances.end());
+            result[q].nearest.resize(numNearest);
+            for (int i = 0; i < numNearest; i++) { result[q].nearest[i] = {_ids[distances[i].second], sqrt(distances[i].first)}; }
+        }
+        return result;
+    }
+
+    Assignment assign(const Point& point, int numNearest) const
+    {
+        std::vector<double> query(_stride, 0.0);
+        std::copy(point.coords.begin(), point.coords.end(), query.begin());
+        return assignBatch(query.data(), 1, numNearest)[0];
+    }
+
+protected:
+    int _rows;
+    int _dim;
+    int _stride;
+    std::vector<double> _data;
+    std::vector<double> _norms;
+    std::vector<int> _ids;
+
+    // four independent accumulators let the compiler keep several multiply-adds in flight
+    double dot(const double* a, const double* b) const
+    {
+        double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        for (int i = 0; i < _stride; i += 4)
+        {
+            s0 += a[i] * b[i];
+            s1 += a[i + 1] * b[i + 1];
+            s2 += a[i + 2] * b[i + 2];
+            s3 += a[i + 3] * b[i + 3];
+        }
+        return (s0 + s1) + (s2 + s3);
+    }
+};
+
+/**
+ * @brief Collects per-request latencies and reports percentiles over the most recent ones.
+ *
+ * The samples are kept in a ring of `capacity` entries, so a long-running service uses fixed memory and a
+ * percentile costs at most one pass over the ring, however many requests it has answered.
+ */
+class LatencyStats
+{
+public:
+    explicit LatencyStats(size_t capacity = 1 << 16) : _capacity(std::max<size_t>(capacity, 1)) { _samples.reserve(std::min<size_t>(_capacity, 1024)); }
+
+    void add(double micros)
+    {
+        if (_samples.size() < _capacity) { _samples.push_back(micros); }
+        else { _samples[_count % _capacity] = micros; }
+        _count++;
+    }
+    // all samples added so far, the percentiles cover the last min(count, capacity) of them
+    size_t count() const { return _count; }
+
+    // nearest-rank percentile, p in [0, 100]
+    double percentile(double p) const
+    {
+        if (_samples.empty()) { return 0.0; }
+        std::vector<double> sorted = _samples;
+        size_t rank = (size_t) std::ceil(p / 100.0 * sorted.size());
+        rank = std::min(std::max<size_t>(rank, 1), sorted.size());
+        std::nth_element(sorted.begin(), sorted.begin() + rank - 1, sorted.end());
+        return sorted[rank - 1];
+    }
+
+protected:
+    size_t _capacity;
+    size_t _count = 0;
+    std::vector<double> _samples;
+};
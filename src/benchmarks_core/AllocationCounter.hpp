@@ -0,0 +1,44 @@
+// AllocationCounter.hpp
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+/**
+ * Counts the heap allocations of the whole program by replacing the global operator new. Include it in exactly
+ * one translation unit of a benchmark executable, never in the library or the tests.
+ * allocationCount() before and after a call gives the allocations it made, those of other threads meanwhile
+ * included. The counter is one relaxed atomic addition per allocation.
+ */
+inline std::atomic<size_t> allocationCounter{0};
+
+inline size_t allocationCount() { return allocationCounter.load(std::memory_order_relaxed); }
+
+void* operator new(size_t size)
+{
+    allocationCounter.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) { return memory; }
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    allocationCounter.fetch_add(1, std::memory_order_relaxed);
+    size_t align = (size_t) alignment;
+    // aligned_alloc wants a multiple of the alignment
+    if (void* memory = std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align)) { return memory; }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new[](size_t size, std::align_val_t alignment) { return operator new(size, alignment); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { std::free(memory); }
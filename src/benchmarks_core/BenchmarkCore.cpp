@@ -0,0 +1,358 @@
+#include "../clustering_core/KmeansND.hpp"
+#include "../data_processing/modules/ClusterRelevantInfo.hpp"
+#include "AllocationCounter.hpp"
+#include "SyntheticData.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * One measurement. `perUnitNs` is the median time divided by `units` (e.g. point x centroid pairs),
+ * `gbPerSecond` the bytes the kernel has to read (see documentation/Benchmarks.md) over the median time, 0 when
+ * there is no fixed byte count. `allocations` counts the heap allocations of the last run (see AllocationCounter.hpp).
+ * A case that does not fit the memory or work budget is kept with `skipped` set, so result files line up.
+ */
+struct BenchmarkResult
+{
+    std::string name;
+    size_t n;
+    int d;
+    int k;
+    std::string unit;
+    int repeats;
+    double medianSeconds;
+    double minSeconds;
+    double perUnitNs;
+    double gbPerSecond;
+    std::string skipped;
+    int iterations = -1;// iterations of a KMeansND::Cluster run, -1 for the other benchmarks
+    long long allocations = -1;
+};
+
+struct BenchmarkConfig
+{
+    std::vector<size_t> sizes = {1000, 10000, 100000};
+    std::vector<int> dims = {2, 64};
+    std::vector<int> ks = {8, 64};
+    int repeats = 3;
+    int maxIter = 10;
+    int neighbors = 10;
+    unsigned seed = 42;
+    int threads = 1;// of the k-means kernels, 0 for one per core
+    double maxMemoryMB = 2048;
+    double maxWork = 2e10;// point x centroid x dimension products per measurement
+    std::string outPath = "benchmark_results.json";
+    std::string tmpDir = std::filesystem::temp_directory_path().string();
+};
+
+BenchmarkConfig parseArguments(int argc, char* argv[]);
+std::vector<BenchmarkResult> runCase(const BenchmarkConfig& config, size_t n, int d, int k, bool withIo);
+void writeJson(const std::string& path, const BenchmarkConfig& config, const std::vector<BenchmarkResult>& results);
+
+// usage: BenchmarkCore [--full] [--n 1000,100000] [--d 2,64] [--k 8,64] [--repeats 3] [--max-iter 10] [--seed 42]
+//                      [--threads 1] [--max-memory-mb 2048] [--max-work 2e10] [--out benchmark_results.json] [--tmp dir]
+int main(int argc, char* argv[])
+{
+    BenchmarkConfig config = parseArguments(argc, argv);
+    std::vector<BenchmarkResult> results;
+
+    std::cout << std::left << std::setw(26) << "benchmark" << std::right << std::setw(10) << "N" << std::setw(6) << "D" << std::setw(6) << "K"
+              << std::setw(14) << "median s" << std::setw(14) << "ns/unit" << std::setw(10) << "GB/s" << std::setw(10) << "allocs"
+              << "  unit" << std::endl;
+    for (size_t n: config.sizes)
+    {
+        for (int d: config.dims)
+        {
+            for (size_t ki = 0; ki < config.ks.size(); ki++)
+            {
+                // file I/O and getNeighbors do not depend on K, they run with the first K only
+                for (const BenchmarkResult& r: runCase(config, n, d, config.ks[ki], ki == 0))
+                {
+                    std::cout << std::left << std::setw(26) << r.name << std::right << std::setw(10) << r.n << std::setw(6) << r.d << std::setw(6)
+                              << r.k;
+                    if (!r.skipped.empty()) { std::cout << "  skipped: " << r.skipped << std::endl; }
+                    else
+                    {
+                        std::cout << std::setw(14) << std::setprecision(4) << r.medianSeconds << std::setw(14) << r.perUnitNs << std::setw(10);
+                        if (r.gbPerSecond > 0) { std::cout << r.gbPerSecond; }
+                        else { std::cout << "-"; }
+                        std::cout << std::setw(10) << r.allocations << "  " << r.unit << std::endl;
+                    }
+                    results.push_back(r);
+                }
+            }
+        }
+    }
+    writeJson(config.outPath, config, results);
+    std::cout << "Wrote " << results.size() << " results to " << config.outPath << std::endl;
+    return 0;
+}
+
+std::vector<size_t> parseSizes(const std::string& list)
+{
+    std::vector<size_t> values;
+    std::stringstream stream(list);
+    std::string value;
+    while (std::getline(stream, value, ',')) { values.push_back((size_t) std::stod(value)); }
+    return values;
+}
+
+std::vector<int> parseInts(const std::string& list)
+{
+    std::vector<int> values;
+    for (size_t value: parseSizes(list)) { values.push_back((int) value); }
+    return values;
+}
+
+BenchmarkConfig parseArguments(int argc, char* argv[])
+{
+    BenchmarkConfig config;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--full")
+        {
+            config.sizes = {1000, 10000, 100000, 1000000, 10000000};
+            config.dims = {2, 64, 384, 768};
+            config.ks = {8, 64, 256, 1024};
+        }
+        else if (arg == "--n" && hasValue) { config.sizes = parseSizes(argv[++i]); }
+        else if (arg == "--d" && hasValue) { config.dims = parseInts(argv[++i]); }
+        else if (arg == "--k" && hasValue) { config.ks = parseInts(argv[++i]); }
+        else if (arg == "--repeats" && hasValue) { config.repeats = std::max(1, std::stoi(argv[++i])); }
+        else if (arg == "--max-iter" && hasValue) { config.maxIter = std::stoi(argv[++i]); }
+        else if (arg == "--seed" && hasValue) { config.seed = (unsigned) std::stoul(argv[++i]); }
+        else if (arg == "--threads" && hasValue) { config.threads = std::stoi(argv[++i]); }
+        else if (arg == "--max-memory-mb" && hasValue) { config.maxMemoryMB = std::stod(argv[++i]); }
+        else if (arg == "--max-work" && hasValue) { config.maxWork = std::stod(argv[++i]); }
+        else if (arg == "--out" && hasValue) { config.outPath = argv[++i]; }
+        else if (arg == "--tmp" && hasValue) { config.tmpDir = argv[++i]; }
+        else
+        {
+            std::cout << "Unknown argument " << arg << std::endl;
+            exit(1);
+        }
+    }
+    return config;
+}
+
+// median and minimum wall time of `repeats` runs of `body`, `setup` runs untimed before each;
+// `allocations` gets the heap allocations of the last run, when scratch buffers have reached their size
+void timeRuns(int repeats, const std::function<void()>& setup, const std::function<void()>& body, double& median, double& minimum,
+              long long& allocations)
+{
+    std::vector<double> seconds;
+    seconds.reserve(repeats);
+    for (int r = 0; r < repeats; r++)
+    {
+        setup();
+        size_t allocationsBefore = allocationCount();
+        auto start = std::chrono::steady_clock::now();
+        body();
+        seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        allocations = (long long) (allocationCount() - allocationsBefore);
+    }
+    std::sort(seconds.begin(), seconds.end());
+    median = seconds[seconds.size() / 2];
+    minimum = seconds[0];
+}
+
+BenchmarkResult measure(const BenchmarkConfig& config, const std::string& name, size_t n, int d, int k, const std::string& unit, double units,
+                        double bytes, const std::function<void()>& setup, const std::function<void()>& body)
+{
+    BenchmarkResult result{name, n, d, k, unit, config.repeats, 0, 0, 0, 0, ""};
+    timeRuns(config.repeats, setup, body, result.medianSeconds, result.minSeconds, result.allocations);
+    result.perUnitNs = result.medianSeconds * 1e9 / units;
+    result.gbPerSecond = bytes > 0 ? bytes / result.medianSeconds / 1e9 : 0;
+    return result;
+}
+
+BenchmarkResult skippedResult(const std::string& name, size_t n, int d, int k, const std::string& reason)
+{
+    return BenchmarkResult{name, n, d, k, "", 0, 0, 0, 0, 0, reason};
+}
+
+std::vector<BenchmarkResult> runCase(const BenchmarkConfig& config, size_t n, int d, int k, bool withIo)
+{
+    std::vector<BenchmarkResult> results;
+    // a Point owns a heap vector of coordinates: the vector header and allocation overhead come on top
+    double memoryMB = n * (d * sizeof(double) + sizeof(Point) + 16.0) / (1024.0 * 1024.0);
+    double work = (double) n * k * d;
+    if (memoryMB > config.maxMemoryMB || k > (int) n)
+    {
+        std::string reason = k > (int) n ? "K > N" : "needs ~" + std::to_string((int) memoryMB) + " MB of points";
+        for (const char* name: {"calcDist", "assignPointsToCentroids", "recalculateCentroids", "returnClusters", "KMeansND::Cluster"})
+        {
+            results.push_back(skippedResult(name, n, d, k, reason));
+        }
+        if (withIo)
+        {
+            for (const char* name: {"save_result csv", "read_data csv", "read_data npy", "getNeighbors"})
+            {
+                results.push_back(skippedResult(name, n, d, k, reason));
+            }
+        }
+        return results;
+    }
+
+    std::vector<Point> blobCenters;
+    std::vector<Point> points = gaussian_blobs(n, d, k, 1.0, config.seed, &blobCenters);
+    // the first K points as centroids: deterministic and one per blob, since point i belongs to blob i % K
+    std::vector<Point> centroids(points.begin(), points.begin() + k);
+    for (int j = 0; j < k; j++) { centroids[j].cluster_id = j; }
+
+    double pairs = (double) n * k;
+    double pairBytes = pairs * 2.0 * d * sizeof(double);
+    auto nothing = []() {};
+    KMeansParallel parallel{config.threads, true};
+    if (work > config.maxWork)
+    {
+        std::string reason = "work N*K*D above --max-work";
+        results.push_back(skippedResult("calcDist", n, d, k, reason));
+        results.push_back(skippedResult("assignPointsToCentroids", n, d, k, reason));
+    }
+    else
+    {
+        volatile double sink = 0;
+        results.push_back(measure(config, "calcDist", n, d, k, "ns/distance", pairs, pairBytes, nothing, [&]() {
+            double sum = 0;
+            for (const Point& point: points)
+            {
+                for (const Point& centroid: centroids) { sum += point.calcDist(centroid); }
+            }
+            sink = sum;
+        }));
+        results.push_back(measure(
+            config, "assignPointsToCentroids", n, d, k, "ns/point/centroid", pairs, pairBytes,
+            [&]() {
+                for (Point& point: points) { point.cluster_id = -1; }
+            },
+            [&]() { assignPointsToCentroids(points, centroids, nullptr, parallel); }));
+    }
+
+    std::vector<Point> updated = centroids;
+    results.push_back(measure(config, "recalculateCentroids", n, d, k, "ns/point", (double) n, (double) n * d * sizeof(double), nothing,
+                              [&]() { recalculateCentroids(points, updated, parallel); }));
+
+    // the partition of ReduceClusterSize, by blob; the copy made in the setup is moved in
+    std::vector<Point> labeled = points;
+    for (size_t i = 0; i < labeled.size(); i++) { labeled[i].cluster_id = (int) (i % k); }
+    std::vector<Point> partitionInput;
+    results.push_back(measure(
+        config, "returnClusters", n, d, k, "ns/point", (double) n, 0, [&]() { partitionInput = labeled; },
+        [&]() { returnClusters(std::move(partitionInput), centroids); }));
+
+    if (work * config.maxIter > config.maxWork) { results.push_back(skippedResult("KMeansND::Cluster", n, d, k, "work N*K*D*iterations above --max-work")); }
+    else
+    {
+        // the whole run up to --max-iter iterations; it may converge earlier, so this is per run and not per iteration
+        KMeansND kmeans(k, config.maxIter);
+        kmeans.setThreads(config.threads);
+        results.push_back(measure(
+            config, "KMeansND::Cluster", n, d, k, "ns/point/centroid/run", pairs, 0,
+            [&]() {
+                // the other benchmarks leave the points assigned, a run starts from unassigned ones
+                for (Point& point: points) { point.cluster_id = -1; }
+                kmeans.setPoints(points);
+                kmeans.setCentroids(centroids);
+            },
+            [&]() { kmeans.Cluster(false); }));
+        results.back().iterations = (int) kmeans.getIterationMetrics().size() - 1;
+    }
+
+    if (!withIo) { return results; }
+
+    std::string base = (std::filesystem::path(config.tmpDir) / ("benchmark_core_" + std::to_string(n) + "_" + std::to_string(d))).string();
+    std::string csvPath = base + ".csv";
+    std::string npyPath = base + ".npy";
+    results.push_back(measure(config, "save_result csv", n, d, k, "ns/point", (double) n, 0, nothing,
+                              [&]() { save_result(csvPath, points, centroids, true); }));
+    double csvBytes = (double) std::filesystem::file_size(csvPath);
+    results.back().gbPerSecond = csvBytes / results.back().medianSeconds / 1e9;
+    results.push_back(measure(config, "read_data csv", n, d, k, "ns/point", (double) n, csvBytes, nothing, [&]() { read_data(csvPath); }));
+
+    npy::npy_data<double> matrix;
+    matrix.shape = {(unsigned long) n, (unsigned long) d};
+    matrix.data.reserve(n * d);
+    for (const Point& point: points) { matrix.data.insert(matrix.data.end(), point.coords.begin(), point.coords.end()); }
+    npy::write_npy(npyPath, matrix);
+    matrix = npy::npy_data<double>();
+    double npyBytes = (double) std::filesystem::file_size(npyPath);
+    results.push_back(measure(config, "read_data npy", n, d, k, "ns/point", (double) n, npyBytes, nothing, [&]() { read_data(npyPath); }));
+    std::remove(csvPath.c_str());
+    std::remove(npyPath.c_str());
+
+    // neighbors of blob 0 around its center: every round scans the whole cluster against the chosen ones
+    std::vector<Point> cluster;
+    for (size_t i = 0; i < points.size(); i += k) { cluster.push_back(points[i]); }
+    int m = config.neighbors;
+    double neighborWork = (double) cluster.size() * m * m / 2.0 * d;
+    if (neighborWork > config.maxWork) { results.push_back(skippedResult("getNeighbors", n, d, k, "work above --max-work")); }
+    else
+    {
+        results.push_back(measure(config, "getNeighbors", cluster.size(), d, m, "ns/point", (double) cluster.size(),
+                                  (double) cluster.size() * m * m / 2.0 * 2.0 * d * sizeof(double), nothing,
+                                  [&]() { getNeighbors(blobCenters[0], cluster, m); }));
+    }
+    return results;
+}
+
+std::string jsonString(const std::string& value)
+{
+    std::string escaped = "\"";
+    for (char c: value)
+    {
+        if (c == '"' || c == '\\') { escaped += '\\'; }
+        escaped += c;
+    }
+    return escaped + "\"";
+}
+
+void writeJson(const std::string& path, const BenchmarkConfig& config, const std::vector<BenchmarkResult>& results)
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        std::cout << "Saving error" << std::endl;
+        exit(1);
+    }
+    file << std::setprecision(9);
+    file << "{\n";
+    file << "  \"schema\": 1,\n";
+#ifdef __clang__
+    file << "  \"compiler\": " << jsonString(std::string("clang ") + __clang_version__) << ",\n";
+#else
+    file << "  \"compiler\": " << jsonString(std::string("gcc ") + __VERSION__) << ",\n";
+#endif
+    file << "  \"generator\": {\"name\": \"gaussian_blobs\", \"seed\": " << config.seed << ", \"spread\": 1.0},\n";
+    file << "  \"repeats\": " << config.repeats << ",\n";
+    file << "  \"threads\": " << config.threads << ",\n";
+    file << "  \"max_iter\": " << config.maxIter << ",\n";
+    file << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchmarkResult& r = results[i];
+        file << "    {\"benchmark\": " << jsonString(r.name) << ", \"n\": " << r.n << ", \"d\": " << r.d << ", \"k\": " << r.k;
+        if (!r.skipped.empty()) { file << ", \"skipped\": " << jsonString(r.skipped); }
+        else
+        {
+            file << ", \"unit\": " << jsonString(r.unit) << ", \"repeats\": " << r.repeats << ", \"median_s\": " << r.medianSeconds
+                 << ", \"min_s\": " << r.minSeconds << ", \"ns_per_unit\": " << r.perUnitNs << ", \"gb_per_s\": ";
+            if (r.gbPerSecond > 0) { file << r.gbPerSecond; }
+            else { file << "null"; }
+            if (r.iterations >= 0) { file << ", \"iterations\": " << r.iterations; }
+            file << ", \"allocations\": " << r.allocations;
+        }
+        file << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+}
@@ -0,0 +1,129 @@
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/**
+ * One result line of a BenchmarkCore JSON file. BenchmarkCore writes every result on its own line,
+ * so the fields are found by key without a JSON parser.
+ */
+struct BenchmarkEntry
+{
+    std::string name;
+    long long n;
+    int d;
+    int k;
+    double medianSeconds;
+    bool skipped;
+};
+
+typedef std::tuple<std::string, long long, int, int> BenchmarkKey;
+
+std::vector<BenchmarkEntry> readBenchmarkJson(const std::string& path);
+std::string compareBenchmarks(const std::vector<BenchmarkEntry>& before, const std::vector<BenchmarkEntry>& after, const std::string& beforeName,
+                              const std::string& afterName);
+
+// usage: CompareBenchmarks [before.json] [after.json] [report.md] [before name] [after name]
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cout << "usage: CompareBenchmarks before.json after.json [report.md] [before name] [after name]" << std::endl;
+        exit(1);
+    }
+    std::string beforeName = argc > 4 ? argv[4] : "before";
+    std::string afterName = argc > 5 ? argv[5] : "after";
+    std::string report = compareBenchmarks(readBenchmarkJson(argv[1]), readBenchmarkJson(argv[2]), beforeName, afterName);
+    std::cout << report;
+    if (argc > 3)
+    {
+        std::ofstream file(argv[3]);
+        if (!file.is_open())
+        {
+            std::cout << "Saving error" << std::endl;
+            exit(1);
+        }
+        file << report;
+    }
+    return 0;
+}
+
+std::string jsonField(const std::string& line, const std::string& key)
+{
+    std::string pattern = "\"" + key + "\": ";
+    size_t start = line.find(pattern);
+    if (start == std::string::npos) { return ""; }
+    start += pattern.size();
+    if (line[start] == '"') { return line.substr(start + 1, line.find('"', start + 1) - start - 1); }
+    return line.substr(start, line.find_first_of(",}", start) - start);
+}
+
+std::vector<BenchmarkEntry> readBenchmarkJson(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        std::cout << "File " << path << " not found" << std::endl;
+        exit(1);
+    }
+    std::vector<BenchmarkEntry> entries;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.find("\"benchmark\": ") == std::string::npos) { continue; }
+        BenchmarkEntry entry;
+        entry.name = jsonField(line, "benchmark");
+        entry.n = std::stoll(jsonField(line, "n"));
+        entry.d = std::stoi(jsonField(line, "d"));
+        entry.k = std::stoi(jsonField(line, "k"));
+        entry.skipped = !jsonField(line, "skipped").empty();
+        entry.medianSeconds = entry.skipped ? 0 : std::stod(jsonField(line, "median_s"));
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+// markdown table of the cases measured in both files, speedup = before / after, and their geometric mean
+std::string compareBenchmarks(const std::vector<BenchmarkEntry>& before, const std::vector<BenchmarkEntry>& after, const std::string& beforeName,
+                              const std::string& afterName)
+{
+    std::map<BenchmarkKey, double> afterSeconds;
+    for (const BenchmarkEntry& entry: after)
+    {
+        if (!entry.skipped) { afterSeconds[BenchmarkKey(entry.name, entry.n, entry.d, entry.k)] = entry.medianSeconds; }
+    }
+
+    std::ostringstream report;
+    report << std::setprecision(4);
+    report << "| benchmark | N | D | K | " << beforeName << " s | " << afterName << " s | speedup |\n";
+    report << "|---|---:|---:|---:|---:|---:|---:|\n";
+    double logSum = 0;
+    int compared = 0;
+    std::map<std::string, std::pair<double, int>> perBenchmark;
+    for (const BenchmarkEntry& entry: before)
+    {
+        auto it = afterSeconds.find(BenchmarkKey(entry.name, entry.n, entry.d, entry.k));
+        if (entry.skipped || it == afterSeconds.end() || entry.medianSeconds <= 0 || it->second <= 0) { continue; }
+        double speedup = entry.medianSeconds / it->second;
+        report << "| " << entry.name << " | " << entry.n << " | " << entry.d << " | " << entry.k << " | " << entry.medianSeconds << " | "
+               << it->second << " | " << speedup << "x |\n";
+        logSum += std::log(speedup);
+        compared++;
+        perBenchmark[entry.name].first += std::log(speedup);
+        perBenchmark[entry.name].second++;
+    }
+    if (compared == 0)
+    {
+        report << "\nNo case was measured in both files.\n";
+        return report.str();
+    }
+    report << "\n| benchmark | geometric mean speedup |\n|---|---:|\n";
+    for (const auto& [name, sums]: perBenchmark) { report << "| " << name << " | " << std::exp(sums.first / sums.second) << "x |\n"; }
+    report << "| all " << compared << " cases | " << std::exp(logSum / compared) << "x |\n";
+    return report.str();
+}
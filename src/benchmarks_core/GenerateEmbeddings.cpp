@@ -0,0 +1,26 @@
+#include "../clustering_core/include/npy.hpp"
+#include "SyntheticData.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+// usage: GenerateEmbeddings [output .npy] [n] [dim] [blobs] [seed]
+// Writes gaussian_blobs as an n x dim matrix of doubles, the layout of embeddings.npy. The defaults mirror a
+// CLustering run on all-minilm embeddings (384 dimensions, 25 clusters) at a size that trains PGO in seconds.
+int main(int argc, char* argv[])
+{
+    std::string outputPath = argc > 1 ? argv[1] : "synthetic_embeddings.npy";
+    size_t n = argc > 2 ? (size_t) std::stod(argv[2]) : 20000;
+    int dim = argc > 3 ? std::stoi(argv[3]) : 384;
+    int blobs = argc > 4 ? std::stoi(argv[4]) : 25;
+    unsigned seed = argc > 5 ? (unsigned) std::stoul(argv[5]) : 42;
+
+    std::vector<Point> points = gaussian_blobs(n, dim, blobs, 1.0, seed);
+    npy::npy_data<double> matrix;
+    matrix.shape = {(unsigned long) n, (unsigned long) dim};
+    matrix.data.reserve(n * dim);
+    for (const Point& point: points) { matrix.data.insert(matrix.data.end(), point.coords.begin(), point.coords.end()); }
+    npy::write_npy(outputPath, matrix);
+    std::cout << "Saved " << n << " x " << dim << " points around " << blobs << " blobs to " << outputPath << std::endl;
+    return 0;
+}
@@ -0,0 +1,41 @@
+// SyntheticData.hpp
+#pragma once
+#include "../clustering_core/modules/structPoint.hpp"
+#include <random>
+#include <vector>
+
+/**
+ * Generates `n` points of dimension `dim` around `numBlobs` Gaussian blobs.
+ * Blob centers are uniform in [-10, 10]^dim and every coordinate of a point is its center plus N(0, spread^2);
+ * point i belongs to blob i % numBlobs. The same seed always gives the same data, so benchmark runs compare.
+ * Points are unassigned (cluster_id -1). If `centers` is given it receives the blob centers.
+ */
+std::vector<Point> gaussian_blobs(size_t n, int dim, int numBlobs, double spread, unsigned seed, std::vector<Point>* centers = nullptr);
+
+// Implementations
+
+std::vector<Point> gaussian_blobs(size_t n, int dim, int numBlobs, double spread, unsigned seed, std::vector<Point>* centers)
+{
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<double> position(-10.0, 10.0);
+    std::normal_distribution<double> noise(0.0, spread);
+
+    std::vector<Point> blobCenters(numBlobs);
+    for (int b = 0; b < numBlobs; b++)
+    {
+        std::vector<double> coords(dim);
+        for (int j = 0; j < dim; j++) { coords[j] = position(gen); }
+        blobCenters[b] = Point(coords, b, 0);
+    }
+
+    std::vector<Point> points(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        const Point& center = blobCenters[i % numBlobs];
+        std::vector<double> coords(dim);
+        for (int j = 0; j < dim; j++) { coords[j] = center.coords[j] + noise(gen); }
+        points[i] = Point(coords);
+    }
+    if (centers) { *centers = blobCenters; }
+    return points;
+}
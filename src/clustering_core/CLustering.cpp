@@ -1,10 +1,47 @@
+#include "../tsne_core/BarnesHutTSNE.hpp"
 #include "KmeansND.hpp"
+#include <filesystem>
 #include <string>
 
 
-void clusterRow(const std::string& embPath, const std::string& saveToPath, const std::string& saveToCentroidsPath, int k, int maxIters);
-void clusterTSNE(const std::string& tsnePath, const std::string& saveToPath2D, const std::string& saveToCentroidsPath2D, int k, int maxIters);
-int main()
+void clusterRow(const std::string& embPath, const std::string& saveToPath, const std::string& saveToCentroidsPath, int k, int maxIters, bool resume);
+void clusterTSNE(const std::string& tsnePath, const std::string& saveToPath2D, const std::string& saveToCentroidsPath2D, int k, int maxIters,
+                 bool resume);
+// iteration metrics go next to the result: rowClustered.csv -> rowClustered.metrics.jsonl
+std::string metricsPathFor(const std::string& resultPath)
+{
+    return std::filesystem::path(resultPath).replace_extension(".metrics.jsonl").string();
+}
+// and the checkpoint too: rowClustered.csv -> rowClustered.checkpoint
+std::string checkpointPathFor(const std::string& resultPath)
+{
+    return std::filesystem::path(resultPath).replace_extension(".checkpoint").string();
+}
+// with --resume an existing checkpoint is continued, otherwise the run starts over
+void startOrResume(KMeansND& kmeans, const std::string& resultPath, bool resume)
+{
+    std::string checkpointPath = checkpointPathFor(resultPath);
+    if (resume && std::filesystem::exists(checkpointPath))
+    {
+        kmeans.resume(checkpointPath);
+        std::cout << "Resuming from " << checkpointPath << std::endl;
+    }
+    else if (resume) { std::cout << "No checkpoint " << checkpointPath << ", starting a new run" << std::endl; }
+    kmeans.setCheckpointPath(checkpointPath);
+}
+
+// the t-SNE layout of the embeddings, saved as the points of a --tsne run (t-SNE_projected.csv by default)
+void project(const std::string& embPath, const std::string& tsnePath)
+{
+    std::cout << "Projecting " << embPath << " with t-SNE..." << std::endl;
+    BarnesHutTSNE tsne;
+    std::vector<Point> layout = tsne.run(read_data(embPath));
+    save_points(tsnePath, layout);
+    std::cout << "saved to " << tsnePath << std::endl;
+}
+
+// usage: CLustering [--tsne] [--project=EMBEDDINGS] [--resume] [--quiet] [--memory-budget=MB] [points] [result csv] [centroids csv] [k] [max iterations]
+int main(int argc, char* argv[])
 {
     std::string embPath = "../../data/big_data/embeddings.npy";
     std::string tsnePath = "../../data/big_data/t-SNE_projected.csv";
@@ -18,17 +55,59 @@ int main()
     int k = 25;
     int maxIters = 50;
 
-    clusterRow(embPath, saveToPath, saveToCentroidsPath, k, maxIters);
-    // clusterTSNE(tsnePath, saveToPath2D, saveToCentroidsPath2D, k, maxIters);
+    // --tsne clusters the 2D projection instead of the embeddings, the other arguments replace its defaults
+    // --project=EMBEDDINGS computes the projection of EMBEDDINGS first (BarnesHutTSNE, replaces reduceDimentions.py), implies --tsne
+    // --resume continues from the checkpoint next to the result, written by an interrupted run
+    // --quiet turns off the progress lines, e.g. for batch runs whose logs are kept, and the memory report
+    // --memory-budget=MB replaces the default budget of 3/4 of the physical memory, 0 turns it off
+    bool tsne = false;
+    std::string projectFrom;
+    bool resume = false;
+    bool quiet = false;
+    int first = 1;
+    for (; first < argc && std::string(argv[first]).rfind("--", 0) == 0; first++)
+    {
+        std::string flag = argv[first];
+        if (flag == "--tsne") { tsne = true; }
+        else if (flag.rfind("--project=", 0) == 0)
+        {
+            projectFrom = flag.substr(10);
+            tsne = true;
+        }
+        else if (flag == "--resume") { resume = true; }
+        else if (flag == "--quiet")
+        {
+            quiet = true;
+            Progress::setEnabled(false);
+        }
+        else if (flag.rfind("--memory-budget=", 0) == 0) { MemoryBudget::setLimit((size_t) (std::stod(flag.substr(16)) * (1 << 20))); }
+        else
+        {
+            std::cout << "Unknown option " << flag << std::endl;
+            exit(1);
+        }
+    }
+    std::string pointsPath = argc > first ? argv[first] : (tsne ? tsnePath : embPath);
+    std::string resultPath = argc > first + 1 ? argv[first + 1] : (tsne ? saveToPath2D : saveToPath);
+    std::string centroidsPath = argc > first + 2 ? argv[first + 2] : (tsne ? saveToCentroidsPath2D : saveToCentroidsPath);
+    if (argc > first + 3) { k = std::stoi(argv[first + 3]); }
+    if (argc > first + 4) { maxIters = std::stoi(argv[first + 4]); }
+
+    if (!projectFrom.empty()) { project(projectFrom, pointsPath); }
+    if (tsne) { clusterTSNE(pointsPath, resultPath, centroidsPath, k, maxIters, resume); }
+    else { clusterRow(pointsPath, resultPath, centroidsPath, k, maxIters, resume); }
+    if (!quiet) { std::cout << "Memory per stage:" << std::endl << memoryReport(); }
 
     return 0;
 }
 
-void clusterRow(const std::string& embPath, const std::string& saveToPath, const std::string& saveToCentroidsPath, int k, int maxIters)
+void clusterRow(const std::string& embPath, const std::string& saveToPath, const std::string& saveToCentroidsPath, int k, int maxIters, bool resume)
 {
     std::cout << "Clustering rows..." << std::endl;
     KMeansND kmeans(k, maxIters, embPath, saveToCentroidsPath, saveToPath);
     kmeans.setWithCoordinates(false);
+    kmeans.setMetricsPath(metricsPathFor(saveToPath));
+    startOrResume(kmeans, saveToPath, resume);
     std::cout << "Initialization done. Starting clustering...";
 
     kmeans.Cluster(true);
@@ -37,7 +116,8 @@ void clusterRow(const std::string& embPath, const std::string& saveToPath, const
     std::cout << "saved to " << saveToPath << std::endl;
 }
 
-void clusterTSNE(const std::string& tsnePath, const std::string& saveToPath2D, const std::string& saveToCentroidsPath2D, int k, int maxIters)
+void clusterTSNE(const std::string& tsnePath, const std::string& saveToPath2D, const std::string& saveToCentroidsPath2D, int k, int maxIters,
+                 bool resume)
 {
     std::cout << "Clustering t-SNE..." << std::endl;
     std::cout << tsnePath << std::endl;
@@ -47,6 +127,8 @@ void clusterTSNE(const std::string& tsnePath, const std::string& saveToPath2D, c
     std::cout << maxIters << std::endl;
     KMeansND kmeans(k, maxIters, tsnePath, saveToCentroidsPath2D, saveToPath2D);
     kmeans.setWithCoordinates(true);
+    kmeans.setMetricsPath(metricsPathFor(saveToPath2D));
+    startOrResume(kmeans, saveToPath2D, resume);
     std::cout << "Initialization done. Starting clustering...";
     std::cout << kmeans.getPoints().size() << std::endl;
     std::cout << kmeans.getPoints()[0].coords.size() << std::endl;
@@ -0,0 +1,327 @@
+#include "KmeansND.hpp"
+#include "modules/parallel.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+
+void KMeansND::Cluster(bool showStatus)// run clustering algorithm
+{
+    typedef std::chrono::steady_clock Clock;
+    auto seconds = [](Clock::time_point from, Clock::time_point to) { return std::chrono::duration<double>(to - from).count(); };
+
+    bool resuming = _resumeIteration >= 0;
+    // the first run of an object starts the metrics file, later runs (e.g. from ClusterIncremental) and resumed ones append to it
+    std::ofstream metricsFile;
+    if (!_metricsPath.empty())
+    {
+        metricsFile.open(_metricsPath, _runs == 0 && !resuming ? std::ios::trunc : std::ios::app);
+        if (!metricsFile.is_open())
+        {
+            std::cout << "Saving error" << std::endl;
+            exit(1);
+        }
+    }
+    _metrics.clear();
+
+    MemoryStage stage("k-means");
+    // the writer thread saves the state while the next iteration runs, which needs room for two snapshots
+    // (the one being written and the next one); without that room every checkpoint is written in place
+    std::unique_ptr<CheckpointWriter> checkpoints;
+    MemoryReservation snapshotsMemory;
+    uint64_t pointsHash = 0;
+    if (!_checkpointPath.empty())
+    {
+        size_t snapshotBytes = _centroids.size() * (_points.empty() ? 0 : _points[0].coords.size()) * sizeof(double)
+                               + _points.size() * (sizeof(double) + sizeof(int32_t));
+        if (MemoryBudget::fits(2 * snapshotBytes))
+        {
+            snapshotsMemory = MemoryReservation("checkpoint snapshots", 2 * snapshotBytes);
+            checkpoints = std::make_unique<CheckpointWriter>(_checkpointPath);
+            stage.setStrategy("background checkpoints");
+        }
+        else
+        {
+            snapshotsMemory = MemoryReservation("checkpoint snapshot", snapshotBytes);
+            stage.setStrategy("synchronous checkpoints");
+        }
+        pointsHash = pointsFingerprint(_points);
+    }
+    auto saveCheckpoint = [&](int iteration, int changed) {
+        if (checkpoints) { checkpoints->submit(checkpoint(iteration, changed, pointsHash)); }
+        else { save_checkpoint(_checkpointPath, checkpoint(iteration, changed, pointsHash)); }
+    };
+
+    // with showStatus the assignments report their points; the total assumes all _max_iter iterations run
+    int iter = resuming ? _resumeIteration : 0;
+    KMeansParallel parallel = _parallel;
+    // the assignment and update of every iteration run on the same threads
+    WorkerPool pool(parallel.threads);
+    parallel.pool = &pool;
+    std::unique_ptr<Progress> progress;
+    if (showStatus)
+    {
+        size_t passes = std::max(0, _max_iter - iter) + (resuming ? 0 : 1);
+        progress = std::make_unique<Progress>("k-means", _points.size() * passes);
+        parallel.progress = progress.get();
+    }
+
+    int pointsChanged;
+    auto start = Clock::now();
+    double inertia = 0;
+    if (resuming)
+    {
+        // the points already carry the labels and distances of the checkpoint's last assignment
+        pointsChanged = _resumePointsChanged;
+        _resumeIteration = -1;
+    }
+    else
+    {
+        pointsChanged = assignPointsToCentroids(_points, _centroids, &inertia, parallel);
+        double assignSeconds = seconds(start, Clock::now());
+        recordIteration(0, assignSeconds, 0, assignSeconds, pointsChanged, inertia, 0, metricsFile);
+        if (!_checkpointPath.empty()) { saveCheckpoint(0, pointsChanged); }
+    }
+
+    std::vector<Point> previous;
+    while (pointsChanged && iter < _max_iter)
+    {
+        // debugShowFullData(_points, _centroids); // uncomment for debugging
+        start = Clock::now();
+        previous = _centroids;
+        recalculateCentroids(_points, _centroids, parallel);
+        auto assignStart = Clock::now();
+        inertia = 0;
+        pointsChanged = assignPointsToCentroids(_points, _centroids, &inertia, parallel);
+        auto assignEnd = Clock::now();
+        double shift = 0;
+        for (int j = 0; j < _centroids.size(); j++) { shift = std::max(shift, _centroids[j].calcDist(previous[j])); }
+        iter++;
+        recordIteration(iter, seconds(assignStart, assignEnd), seconds(start, assignStart), seconds(start, Clock::now()), pointsChanged, inertia,
+                        shift, metricsFile);
+        if (showStatus) { iterationStatus(iter, pointsChanged); }
+        if (!_checkpointPath.empty() && (iter % _checkpointEvery == 0 || !pointsChanged || iter == _max_iter))
+        {
+            saveCheckpoint(iter, pointsChanged);
+        }
+    }
+    // waits for the last checkpoint, the one of the final state
+    if (checkpoints) { checkpoints->finish(); }
+    if (progress) { progress->finish(); }
+    _runs++;
+    _clusterCounts = countPointsPerCluster();
+    _anchorCentroids = _centroids;
+    if (showStatus) { std::cout << "Clustering finished" << std::endl; }
+}
+
+void KMeansND::recordIteration(int iteration, double assignSeconds, double updateSeconds, double seconds, int pointsChanged, double inertia,
+                               double centroidShift, std::ofstream& metricsFile)
+{
+    size_t dim = _points.empty() ? 0 : _points[0].coords.size();
+    size_t pointBytes = _points.size() * dim * sizeof(double);
+    IterationMetrics metrics;
+    metrics.run = _runs;
+    metrics.iteration = iteration;
+    metrics.seconds = seconds;
+    metrics.assignSeconds = assignSeconds;
+    metrics.updateSeconds = updateSeconds;
+    metrics.distanceEvaluations = (long long) _points.size() * _centroids.size() + (iteration > 0 ? _centroids.size() : 0);
+    metrics.pointsChanged = pointsChanged;
+    metrics.inertia = inertia;
+    metrics.centroidShift = centroidShift;
+    metrics.bytesRead = iteration > 0 ? 2 * pointBytes : pointBytes;
+    metrics.peakRssBytes = peakResidentBytes();
+    _metrics.push_back(metrics);
+    if (metricsFile.is_open()) { metricsFile << iterationMetricsJson(metrics) << std::endl; }
+}
+
+/**
+ * Adds new points to an existing clustering without re-running it from scratch.
+ *
+ * Every new point is assigned to its nearest centroid, which is then moved by the running mean
+ * c += (x - c) / n, so the cost is O(new points * k). When some centroid has drifted further than
+ * `driftThreshold` from its position after the last full clustering, a full re-iteration over all
+ * loaded points is run. Returns true if the drift threshold was exceeded.
+ *
+ * The positions after the last full clustering (the anchors) are saved with the counts and read back by
+ * loadClusterCounts, so the drift adds up over daily runs. Without saved anchors the loaded centroids are used.
+ */
+bool KMeansND::ClusterIncremental(const std::vector<Point>& newPoints, double driftThreshold, bool showStatus)
+{
+    if (_centroids.empty())
+    {
+        std::cout << "Incremental clustering needs centroids, set them or run Cluster() first" << std::endl;
+        exit(1);
+    }
+    if (_clusterCounts.size() < _centroids.size()) { _clusterCounts.resize(_centroids.size(), 0); }
+    if (_anchorCentroids.size() != _centroids.size()) { _anchorCentroids = _centroids; }
+
+    _points.reserve(_points.size() + newPoints.size());
+    for (const auto& newPoint: newPoints)
+    {
+        Point point = newPoint;
+        double min_dist = __DBL_MAX__;
+        for (int j = 0; j < _centroids.size(); j++)
+        {
+            double dist = point.calcDist(_centroids[j]);
+            if (dist < min_dist)
+            {
+                min_dist = dist;
+                point.cluster_id = j;
+            }
+        }
+        point.distance = min_dist;
+
+        Point& centroid = _centroids[point.cluster_id];
+        int count = ++_clusterCounts[point.cluster_id];
+        for (int i = 0; i < centroid.coords.size(); i++) { centroid.coords[i] += (point.coords[i] - centroid.coords[i]) / count; }
+        _points.push_back(point);
+    }
+    accountMemory();
+
+    double drift = getCentroidDrift();
+    if (showStatus) { std::cout << "Added " << newPoints.size() << " points, max centroid drift: " << drift << std::endl; }
+    if (drift <= driftThreshold) { return false; }
+
+    // a full re-iteration is only meaningful if every counted point is in memory
+    int countedPoints = 0;
+    for (int count: _clusterCounts) { countedPoints += count; }
+    if (countedPoints != _points.size())
+    {
+        std::cout << "Centroid drift " << drift << " exceeds threshold " << driftThreshold
+                  << ", load all points to re-cluster (" << _points.size() << " of " << countedPoints << " loaded)" << std::endl;
+        return true;
+    }
+    if (showStatus) { std::cout << "Drift threshold exceeded, re-clustering all points" << std::endl; }
+    Cluster(showStatus);
+    return true;
+}
+
+double KMeansND::getCentroidDrift()
+{
+    double drift = 0;
+    for (int i = 0; i < _centroids.size() && i < _anchorCentroids.size(); i++)
+    {
+        drift = std::max(drift, _centroids[i].calcDist(_anchorCentroids[i]));
+    }
+    return drift;
+}
+
+std::vector<int> KMeansND::countPointsPerCluster() const
+{
+    std::vector<int> counts(_centroids.size(), 0);
+    for (const auto& point: _points)
+    {
+        if (point.cluster_id >= 0 && point.cluster_id < counts.size()) { counts[point.cluster_id]++; }
+    }
+    return counts;
+}
+
+void KMeansND::loadClusterCounts(std::string countsPath)
+{
+    _countsPath = countsPath;
+    _clusterCounts = read_cluster_counts(countsPath);
+    _clusterCounts.resize(_centroids.size(), 0);
+    std::vector<Point> anchors = read_cluster_anchors(countsPath);
+    // counts saved without anchors: the drift is measured from the centroids as loaded
+    _anchorCentroids = anchors.empty() ? _centroids : anchors;
+}
+
+void KMeansND::save()
+{
+    save_result(_resultPath, _points, _centroids, _with_coordinates);
+    save_centroids(_centroidsPath, _centroids);
+    if (!_countsPath.empty()) { save_cluster_counts(_countsPath, _clusterCounts, _anchorCentroids); }
+}
+
+void KMeansND::setPoints(std::vector<Point> points)
+{
+    _points = std::move(points);
+    _centroids = drawCentroids();
+    accountMemory();
+}
+
+// the reservation follows the loaded data; it is not required, the data exists already when it is counted
+void KMeansND::accountMemory()
+{
+    size_t dim = _points.empty() ? (_centroids.empty() ? 0 : _centroids[0].coords.size()) : _points[0].coords.size();
+    _memory = MemoryReservation("k-means data", pointsBytes(_points.capacity(), dim) + 2 * pointsBytes(_centroids.size(), dim), false);
+}
+
+// random initial centroids; the seed is kept (see getSeed), so a checkpointed run can be repeated
+std::vector<Point> KMeansND::drawCentroids()
+{
+    if (!_seeded) { _seed = std::random_device()(); }
+    return initialize_random_centroids(_points, _k, _seed);
+}
+
+/**
+ * Draws the initial centroids with `seed` from now on, and re-draws them if points are loaded already:
+ * call it before setCentroids. Together with the reproducible mode a run gives the same result every time.
+ */
+void KMeansND::setSeed(unsigned seed)
+{
+    _seeded = true;
+    _seed = seed;
+    if (!_points.empty() && _k > 0) { _centroids = initialize_random_centroids(_points, _k, _seed); }
+}
+
+KMeansCheckpoint KMeansND::checkpoint(int iteration, int pointsChanged, uint64_t pointsHash) const
+{
+    KMeansCheckpoint state;
+    state.run = _runs;
+    state.iteration = iteration;
+    state.pointsChanged = pointsChanged;
+    state.seed = _seed;
+    state.k = (int) _centroids.size();
+    state.dim = _centroids.empty() ? 0 : (int) _centroids[0].coords.size();
+    state.pointsHash = pointsHash;
+    state.centroids.reserve((size_t) state.k * state.dim);
+    for (const Point& centroid: _centroids) { state.centroids.insert(state.centroids.end(), centroid.coords.begin(), centroid.coords.end()); }
+    state.distances.resize(_points.size());
+    state.labels.resize(_points.size());
+    for (size_t i = 0; i < _points.size(); i++)
+    {
+        state.distances[i] = _points[i].distance;
+        state.labels[i] = _points[i].cluster_id;
+    }
+    return state;
+}
+
+/**
+ * Continues a run from a checkpoint written by Cluster() (see setCheckpointPath): the points must be loaded
+ * already and be the same, k must match. The next Cluster() call picks up after the checkpoint's iteration and
+ * ends with exactly the result the interrupted run would have had; _max_iter still counts from the start.
+ */
+void KMeansND::resume(std::string checkpointPath)
+{
+    KMeansCheckpoint state = read_checkpoint(checkpointPath);
+    size_t dim = _points.empty() ? 0 : _points[0].coords.size();
+    if (state.k != _k || state.labels.size() != _points.size() || state.dim != (int) dim || state.pointsHash != pointsFingerprint(_points))
+    {
+        std::cout << "Checkpoint " << checkpointPath << " does not belong to these points (k " << state.k << ", " << state.labels.size()
+                  << " points of dimension " << state.dim << ")" << std::endl;
+        exit(1);
+    }
+    _seeded = true;
+    _seed = state.seed;
+    _runs = state.run;
+    _centroids.assign(_k, Point(std::vector<double>(dim)));
+    for (int i = 0; i < _k; i++)
+    {
+        std::copy(state.centroids.begin() + (size_t) i * dim, state.centroids.begin() + (size_t) (i + 1) * dim, _centroids[i].coords.begin());
+        _centroids[i].cluster_id = i;
+        _centroids[i].distance = 0;
+    }
+    for (size_t i = 0; i < _points.size(); i++)
+    {
+        _points[i].cluster_id = state.labels[i];
+        _points[i].distance = state.distances[i];
+    }
+    _anchorCentroids = _centroids;
+    _resumeIteration = state.iteration;
+    _resumePointsChanged = state.pointsChanged;
+}
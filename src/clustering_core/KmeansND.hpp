@@ -1,11 +1,16 @@
 #pragma once
 #include "include/npy.hpp"
-#include "modules/clusterTools.hpp"
+#include "modules/checkpoint.hpp"
+#include "modules/ClusterTools.hpp"
+#include "modules/iterationMetrics.hpp"
 #include "modules/kMeansLogic.hpp"
-#include "modules/readData.hpp"
+#include "modules/memoryBudget.hpp"
+#include "modules/progress.hpp"
+#include "modules/ReadData.hpp"
 #include "modules/writeData.hpp"
 #include <algorithm>
 #include <cmath>
+#include <fstream>
 #include <iostream>
 #include <map>
 #include <random>
@@ -26,9 +31,35 @@ protected:
     std::string _pointsPath;
     std::string _centroidsPath;
     std::string _resultPath;
+    std::string _countsPath;
+    std::string _metricsPath;
+    std::string _checkpointPath;
+    int _checkpointEvery = 1;
 
     std::vector<Point> _points;
 
+    std::vector<int> _clusterCounts;    // number of points per cluster, kept up to date by incremental updates
+    std::vector<Point> _anchorCentroids;// centroids after the last full clustering, used to measure drift
+
+    std::vector<IterationMetrics> _metrics;// iterations of the last Cluster() call
+    int _runs = 0;
+
+    KMeansParallel _parallel{0, true};// all cores, results independent of the thread count
+    bool _seeded = false;
+    unsigned _seed = 0;// seed of the current initial centroids, drawn from std::random_device unless set
+
+    int _resumeIteration = -1;// set by resume(), Cluster() then continues after this iteration
+    int _resumePointsChanged = 0;
+
+    MemoryReservation _memory;// points, centroids and counts against the memory budget, see accountMemory()
+
+    std::vector<int> countPointsPerCluster() const;
+    std::vector<Point> drawCentroids();
+    void accountMemory();
+    KMeansCheckpoint checkpoint(int iteration, int pointsChanged, uint64_t pointsHash) const;
+    void recordIteration(int iteration, double assignSeconds, double updateSeconds, double seconds, int pointsChanged, double inertia,
+                         double centroidShift, std::ofstream& metricsFile);
+
 public:
     KMeansND(int k, int max_iter, std::string pointsPath, std::string centroidsPath, std::string resultPath)
     {
@@ -39,56 +70,63 @@ public:
         _resultPath = resultPath;
         _with_coordinates = false;
         _points = read_data(_pointsPath);
-        _centroids = initialize_random_centroids(_points, _k);
+        _centroids = drawCentroids();
+        accountMemory();
     }
-    KMeansND(int k, std::string pointsPath, std::string centroidsPath) : _k(k), _pointsPath(pointsPath), _centroidsPath(centroidsPath), _points(read_data(pointsPath)), _centroids(read_data(centroidsPath)) {};
-    KMeansND(int k, int max_iter, std::vector<Point> points) : _k(k), _max_iter(max_iter), _points(points), _centroids(initialize_random_centroids(points, k)){};
+    KMeansND(int k, std::string pointsPath, std::string centroidsPath) : _k(k), _max_iter(100), _with_coordinates(false), _pointsPath(pointsPath), _centroidsPath(centroidsPath), _points(read_data(pointsPath)), _centroids(read_data(centroidsPath))
+    {
+        _clusterCounts = countPointsPerCluster();
+        _anchorCentroids = _centroids;
+        accountMemory();
+    };
+    KMeansND(int k, int max_iter, std::vector<Point> points) : _k(k), _max_iter(max_iter), _points(std::move(points))
+    {
+        _centroids = drawCentroids();
+        accountMemory();
+    };
 
     KMeansND(int k, int max_iter) : _k(k), _max_iter(max_iter){};
 
     ~KMeansND() = default;
+    KMeansND(KMeansND&&) = default;
+    KMeansND& operator=(KMeansND&&) = default;
 
-    void Cluster(bool showStatus);
+    void Cluster(bool showStatus = false);
+    bool ClusterIncremental(const std::vector<Point>& newPoints, double driftThreshold, bool showStatus = false);
     void save();
+    void loadClusterCounts(std::string countsPath);
+    void resume(std::string checkpointPath);
 
     void setK(int k) { _k = k; };
     void setPoints(std::vector<Point> points);
-    void setCentroids(std::vector<Point> centroids) { _centroids = centroids; };
+    void setCentroids(std::vector<Point> centroids)
+    {
+        _centroids = centroids;
+        accountMemory();
+    };
     void setMaxIter(int max_iter) { _max_iter = max_iter; };
+    void setThreads(int threads) { _parallel.threads = threads; };
+    void setReproducible(bool reproducible) { _parallel.reproducible = reproducible; };
+    void setSeed(unsigned seed);
     void setPointsPath(std::string pointsPath) { _pointsPath = pointsPath; };
     void setCentroidsPath(std::string centroidsPath) { _centroidsPath = centroidsPath; };
     void setResultPath(std::string resultPath) { _resultPath = resultPath; };
     void setWithCoordinates(bool with_coordinates) { _with_coordinates = with_coordinates; };
+    void setCountsPath(std::string countsPath) { _countsPath = countsPath; };
+    void setMetricsPath(std::string metricsPath) { _metricsPath = metricsPath; };
+    void setCheckpointPath(std::string checkpointPath, int everyIterations = 1)
+    {
+        _checkpointPath = checkpointPath;
+        _checkpointEvery = std::max(1, everyIterations);
+    };
 
     std::vector<Point> getPoints() { return _points; };
     std::vector<Point> getCentroids() { return _centroids; };
     int getK() { return _k; };
     std::map<int, int> getClustersSize() { return returnClustersSize(_points); }
+    std::vector<int> getClusterCounts() { return _clusterCounts; };
+    double getCentroidDrift();
+    std::vector<IterationMetrics> getIterationMetrics() { return _metrics; };
+    KMeansParallel getParallel() { return _parallel; };
+    unsigned getSeed() { return _seed; };
 };
-
-void KMeansND::Cluster(bool showStatus = false)// run clustering algorithm
-{
-    int pointsChanged = assignPointsToCentroids(_points, _centroids);
-    int iter = 0;
-    while (pointsChanged && iter < _max_iter)
-    {
-        // debugShowFullData(_points, _centroids); // uncomment for debugging
-        recalculateCentroids(_points, _centroids);
-        pointsChanged = assignPointsToCentroids(_points, _centroids);
-        iter++;
-        if (showStatus) { iterationStatus(iter, pointsChanged); }
-    }
-    if (showStatus) { std::cout << "Clustering finished" << std::endl; }
-}
-
-void KMeansND::save()
-{
-    save_result(_resultPath, _points, _centroids, _with_coordinates);
-    save_centroids(_centroidsPath, _centroids);
-}
-
-void KMeansND::setPoints(std::vector<Point> points)
-{
-    _points = points;
-    _centroids = initialize_random_centroids(points, _k);
-}
@@ -0,0 +1,48 @@
+#include "ClusterTools.hpp"
+#include "scratchArena.hpp"
+#include <string>
+
+std::map<int, int> returnClustersSize(const std::vector<Point>& _points)
+{
+    std::map<int, int> clusters;
+    for (int i = 0; i < _points.size(); i++)
+    {
+        clusters[_points[i].cluster_id]++;
+    }
+    return clusters;
+}
+
+
+std::vector<std::vector<Point>> returnClusters(std::vector<Point> _points, const std::vector<Point>& _centroids)
+{
+    // sized first, so every cluster allocates once and the coordinates are moved, not copied
+    ScratchArena arena;
+    ScratchVector<size_t> sizes(_centroids.size(), 0, arena.resource());
+    for (const Point& point: _points) { sizes[point.cluster_id]++; }
+    std::vector<std::vector<Point>> clusters(_centroids.size());
+    for (size_t i = 0; i < clusters.size(); i++) { clusters[i].reserve(sizes[i]); }
+    for (int i = 0; i < _points.size(); i++)
+    {
+        clusters[_points[i].cluster_id].push_back(std::move(_points[i]));
+    }
+    return clusters;
+}
+
+
+void iterationStatus(int iteration, int pointsChanged)
+{
+    // display status of the current iteration 
+    // in format: "Iteration: 5, Points changed: 321"
+    std::cout << "Iteration: " + std::to_string(iteration) + ", Points changed: " + std::to_string(pointsChanged) + "\n";
+}
+
+void debugShowFullData(std::vector<Point> _points, std::vector<Point> _centroids)
+{
+    std::cout << "-------------------------------------------------------\n";
+    std::cout << "Centroids:\n";
+    for (int i = 0; i < _centroids.size(); i++) {std::cout << _centroids[i] << "\n";}
+    std::cout << "\nPoints:\n";
+    for (int i = 0; i < _points.size(); i++) {std::cout << _points[i] << "\n";}
+    std::cout << "\n";
+    std::cout << "-------------------------------------------------------\n";
+}
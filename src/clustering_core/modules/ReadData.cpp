@@ -0,0 +1,257 @@
+#include "ReadData.hpp"
+#include "../include/npy.hpp"// https://github.com/llohse/libnpy
+#include "memoryBudget.hpp"
+#include "progress.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+std::vector<Point> read_data(std::string path)
+{
+    // Determine the file type based on its extension
+    std::string extension = path.substr(path.size() - 4);
+
+
+    if (extension == ".csv") { return read_from_csv(path); }
+    if (extension == ".txt") { return read_from_txt(path); }
+    if (extension == ".npy") { return read_from_npy(path); }
+
+    else
+    {
+        std::cout << "File type for row points not supported" << std::endl;
+        std::cout << "Supported file types: csv, npy, txt" << std::endl;
+        exit(1);
+    }
+}
+
+// progress of reading a text file line by line: rows are unknown up front, the ETA comes from the file size
+static Progress readProgress(const std::string& path)
+{
+    std::error_code error;
+    size_t size = std::filesystem::file_size(path, error);
+    return Progress("reading " + std::filesystem::path(path).filename().string(), 0, error ? 0 : size);
+}
+
+std::vector<Point> read_from_csv(std::string path)
+{
+    std::vector<Point> points;
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        std::cout << "File " << path << " not found" << std::endl;
+        exit(1);
+    }
+    Progress progress = readProgress(path);
+    std::string line;
+    std::getline(file, line);
+    // determine is it row points or clustered ones
+    // if "cluster_id" or "distance" is in the first line, then
+    if (line.find("cluster_id") != std::string::npos || line.find("distance") != std::string::npos)
+    {
+        while (std::getline(file, line))
+        {
+            progress.add(1, line.size() + 1);
+            std::istringstream iss(line);
+            std::vector<double> values;
+            int cluster_id;
+            double distance;
+            std::string value;
+            short count = 0;
+            while (std::getline(iss, value, ','))
+            {
+                if (count == 0) { cluster_id = std::stoi(value); }
+                else if (count == 1) { distance = std::stod(value); }
+                else {values.push_back(std::stod(value));}
+                count++;
+            }
+            points.push_back(Point(values, cluster_id, distance));
+        }
+    }
+    else
+    {
+        while (std::getline(file, line))
+        {
+            progress.add(1, line.size() + 1);
+            std::istringstream iss(line);
+            std::vector<double> values;
+            std::string value;
+            while (std::getline(iss, value, ','))
+            {
+                values.push_back(std::stod(value));
+            }
+            points.push_back(Point(values));// Assuming Point constructor can take a vector<double> for N-dimensional points
+        }
+    }
+    file.close();
+    return points;
+}
+
+std::vector<Point> read_from_txt(std::string path)
+{
+    std::vector<Point> points;
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        std::cout << "File " << path << " not found" << std::endl;
+        exit(1);
+    }
+    Progress progress = readProgress(path);
+    std::string line;
+    std::getline(file, line); // Read the first line to determine the data format
+    // If "cluster_id" or "distance" is in the first line, then it's clustered data
+    if (line.find("cluster_id") != std::string::npos || line.find("distance") != std::string::npos)
+    {
+        while (std::getline(file, line))
+        {
+            progress.add(1, line.size() + 1);
+            std::istringstream iss(line);
+            std::vector<double> values;
+            int cluster_id;
+            double distance;
+            std::string value;
+            short count = 0;
+            while (std::getline(iss, value, ','))
+            {
+                if (count == 0) { cluster_id = std::stoi(value); }
+                else if (count == 1) { distance = std::stod(value); }
+                else { values.push_back(std::stod(value)); }
+                count++;
+            }
+            points.push_back(Point(values, cluster_id, distance));
+        }
+    }
+    else // If the first line does not contain "cluster_id" or "distance", it's unclustered data
+    {
+        // Reset the file read pointer to the beginning of the file as we need to read the first line again
+        file.clear();
+        file.seekg(0);
+        while (std::getline(file, line))
+        {
+            progress.add(1, line.size() + 1);
+            std::istringstream iss(line);
+            std::vector<double> values;
+            std::string value;
+            while (std::getline(iss, value, ','))
+            {
+                values.push_back(std::stod(value));
+            }
+            points.push_back(Point(values)); // Assuming Point constructor can take a vector<double> for N-dimensional points
+        }
+    }
+    file.close();
+    return points;
+}
+
+/**
+ * Reads a 2D float64 array. The points are reserved against the memory budget first (see memoryBudget.hpp).
+ * If the raw array fits beside them, the file is read in one piece; otherwise it is read in chunks of rows,
+ * which caps the extra memory at the chunk instead of a second copy of the data.
+ */
+std::vector<Point> read_from_npy(std::string path)
+{
+    std::string name = std::filesystem::path(path).filename().string();
+    std::ifstream stream(path, std::ifstream::binary);
+    if (!stream.is_open())
+    {
+        std::cout << "File " << path << " not found" << std::endl;
+        exit(1);
+    }
+    npy::header_t header = npy::parse_header(npy::read_header(stream));
+    if (header.dtype.tie() != npy::dtype_map.at(std::type_index(typeid(double))).tie() || header.fortran_order || header.shape.size() != 2)
+    {
+        std::cout << "File " << path << " is not a 2D float64 array in C order" << std::endl;
+        exit(1);
+    }
+    size_t rows = header.shape[0], dim = header.shape[1];
+
+    MemoryStage stage("reading " + name);
+    MemoryReservation pointsMemory("the points of " + name, pointsBytes(rows, dim));
+    size_t rowBytes = std::max<size_t>(1, dim * sizeof(double));
+    size_t chunkRows = rows;
+    if (!MemoryBudget::fits(rows * rowBytes))
+    {
+        // half of what is left, at least one row and at most NPY_CHUNK_BYTES
+        chunkRows = std::max<size_t>(1, std::min(MemoryBudget::available() / 2, NPY_CHUNK_BYTES) / rowBytes);
+        stage.setStrategy("chunks of " + std::to_string(chunkRows) + " rows");
+    }
+    else { stage.setStrategy("whole file"); }
+    MemoryReservation chunkMemory("the read buffer of " + name, std::min(chunkRows, rows) * rowBytes);
+
+    std::vector<Point> points;
+    points.reserve(rows);
+    std::vector<double> chunk;
+    Progress progress("reading " + name, rows);
+    for (size_t first = 0; first < rows; first += chunkRows)
+    {
+        size_t count = std::min(chunkRows, rows - first);
+        chunk.resize(count * dim);
+        if (!stream.read(reinterpret_cast<char*>(chunk.data()), chunk.size() * sizeof(double)))
+        {
+            std::cout << "File " << path << " is truncated" << std::endl;
+            exit(1);
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            points.push_back(Point(std::vector<double>(chunk.begin() + i * dim, chunk.begin() + (i + 1) * dim)));
+        }
+        progress.add(count, count * rowBytes);
+    }
+    return points;
+}
+
+std::vector<int> read_cluster_counts(std::string path)
+{
+    // file format: "cluster_id,count" header, then one line per cluster
+    std::vector<int> counts;
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        std::cout << "File " << path << " not found" << std::endl;
+        exit(1);
+    }
+    std::string line;
+    std::getline(file, line);
+    while (std::getline(file, line))
+    {
+        std::istringstream iss(line);
+        std::string value;
+        std::getline(iss, value, ',');
+        int cluster_id = std::stoi(value);
+        std::getline(iss, value, ',');
+        if (cluster_id >= (int) counts.size()) { counts.resize(cluster_id + 1, 0); }
+        counts[cluster_id] = std::stoi(value);
+    }
+    file.close();
+    return counts;
+}
+
+std::vector<Point> read_cluster_anchors(std::string path)
+{
+    // file format: "cluster_id,count[,x0,x1,...]", the anchors are the coordinates after the count, if any
+    std::vector<Point> anchors;
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        std::cout << "File " << path << " not found" << std::endl;
+        exit(1);
+    }
+    std::string line;
+    std::getline(file, line);
+    while (std::getline(file, line))
+    {
+        std::istringstream iss(line);
+        std::string value;
+        std::getline(iss, value, ',');
+        int cluster_id = std::stoi(value);
+        std::getline(iss, value, ',');
+        std::vector<double> coords;
+        while (std::getline(iss, value, ',')) { coords.push_back(std::stod(value)); }
+        if (coords.empty()) { return {}; }
+        if (cluster_id >= (int) anchors.size()) { anchors.resize(cluster_id + 1, Point(std::vector<double>(coords.size()))); }
+        anchors[cluster_id] = Point(coords, cluster_id, 0);
+    }
+    file.close();
+    return anchors;
+}
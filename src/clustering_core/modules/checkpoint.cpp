@@ -0,0 +1,191 @@
+#include "checkpoint.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+// FNV-1a over 8-byte words
+static uint64_t hashWords(uint64_t hash, const char* data, size_t size)
+{
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    for (; i < size; i++) { hash = (hash ^ (unsigned char) data[i]) * 1099511628211ULL; }
+    return hash;
+}
+
+static const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+
+uint64_t pointsFingerprint(const std::vector<Point>& points)
+{
+    uint64_t sizes[2] = {points.size(), points.empty() ? 0 : points[0].coords.size()};
+    uint64_t hash = hashWords(FNV_OFFSET, reinterpret_cast<const char*>(sizes), sizeof(sizes));
+    for (const Point& point: points)
+    {
+        hash = hashWords(hash, reinterpret_cast<const char*>(point.coords.data()), point.coords.size() * sizeof(double));
+    }
+    return hash;
+}
+
+static uint64_t checkpointChecksum(const KMeansCheckpoint& checkpoint)
+{
+    uint64_t hash = hashWords(FNV_OFFSET, reinterpret_cast<const char*>(checkpoint.centroids.data()), checkpoint.centroids.size() * sizeof(double));
+    hash = hashWords(hash, reinterpret_cast<const char*>(checkpoint.distances.data()), checkpoint.distances.size() * sizeof(double));
+    return hashWords(hash, reinterpret_cast<const char*>(checkpoint.labels.data()), checkpoint.labels.size() * sizeof(int32_t));
+}
+
+bool try_save_checkpoint(const std::string& path, const KMeansCheckpoint& checkpoint, std::string* error)
+{
+    KMeansCheckpointHeader header = {};
+    std::memcpy(header.magic, "KMCP", 4);
+    header.version = KMEANS_CHECKPOINT_VERSION;
+    header.k = checkpoint.k;
+    header.dim = checkpoint.dim;
+    header.numPoints = (int64_t) checkpoint.labels.size();
+    header.run = checkpoint.run;
+    header.iteration = checkpoint.iteration;
+    header.pointsChanged = checkpoint.pointsChanged;
+    header.seed = checkpoint.seed;
+    header.pointsHash = checkpoint.pointsHash;
+    header.checksum = checkpointChecksum(checkpoint);
+
+    auto fail = [&](const std::string& message) {
+        if (error) { *error = message; }
+        return false;
+    };
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary);
+        if (!file.is_open()) { return fail("could not open " + tmpPath); }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(checkpoint.centroids.data()), checkpoint.centroids.size() * sizeof(double));
+        file.write(reinterpret_cast<const char*>(checkpoint.distances.data()), checkpoint.distances.size() * sizeof(double));
+        file.write(reinterpret_cast<const char*>(checkpoint.labels.data()), checkpoint.labels.size() * sizeof(int32_t));
+        if (!file.flush()) { return fail("could not write " + tmpPath); }
+    }
+    std::error_code renameError;
+    std::filesystem::rename(tmpPath, path, renameError);
+    if (renameError) { return fail(renameError.message()); }
+    return true;
+}
+
+void save_checkpoint(const std::string& path, const KMeansCheckpoint& checkpoint)
+{
+    std::string error;
+    if (!try_save_checkpoint(path, checkpoint, &error))
+    {
+        std::cout << "Saving error: " << error << std::endl;
+        exit(1);
+    }
+}
+
+KMeansCheckpoint read_checkpoint(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Error opening file: " << path << std::endl;
+        exit(1);
+    }
+    KMeansCheckpointHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, "KMCP", 4) != 0
+        || header.version != KMEANS_CHECKPOINT_VERSION || header.k < 0 || header.dim < 0 || header.numPoints < 0)
+    {
+        std::cout << "File " << path << " is not a k-means checkpoint" << std::endl;
+        exit(1);
+    }
+    // the arrays have to fill the rest of the file exactly before anything is allocated for them
+    std::error_code sizeError;
+    uint64_t fileSize = std::filesystem::file_size(path, sizeError);
+    uint64_t rest = sizeError || fileSize < sizeof(header) ? 0 : fileSize - sizeof(header);
+    uint64_t centroidBytes = (uint64_t) header.k * (uint64_t) header.dim * sizeof(double);
+    if (sizeError || centroidBytes > rest || (uint64_t) header.numPoints > (rest - centroidBytes) / (sizeof(double) + sizeof(int32_t))
+        || (uint64_t) header.numPoints * (sizeof(double) + sizeof(int32_t)) != rest - centroidBytes)
+    {
+        std::cout << "File " << path << " is not a k-means checkpoint" << std::endl;
+        exit(1);
+    }
+    KMeansCheckpoint checkpoint;
+    checkpoint.run = header.run;
+    checkpoint.iteration = header.iteration;
+    checkpoint.pointsChanged = header.pointsChanged;
+    checkpoint.seed = header.seed;
+    checkpoint.k = header.k;
+    checkpoint.dim = header.dim;
+    checkpoint.pointsHash = header.pointsHash;
+    checkpoint.centroids.resize((size_t) header.k * header.dim);
+    checkpoint.distances.resize(header.numPoints);
+    checkpoint.labels.resize(header.numPoints);
+    file.read(reinterpret_cast<char*>(checkpoint.centroids.data()), checkpoint.centroids.size() * sizeof(double));
+    file.read(reinterpret_cast<char*>(checkpoint.distances.data()), checkpoint.distances.size() * sizeof(double));
+    file.read(reinterpret_cast<char*>(checkpoint.labels.data()), checkpoint.labels.size() * sizeof(int32_t));
+    if (!file || checkpointChecksum(checkpoint) != header.checksum)
+    {
+        std::cout << "File " << path << " is corrupted (checksum mismatch)" << std::endl;
+        exit(1);
+    }
+    return checkpoint;
+}
+
+CheckpointWriter::CheckpointWriter(std::string path) : _path(std::move(path)), _thread(&CheckpointWriter::run, this) {}
+
+CheckpointWriter::~CheckpointWriter() { finish(); }
+
+void CheckpointWriter::submit(KMeansCheckpoint checkpoint)
+{
+    exitOnError();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _pending = std::move(checkpoint);
+        _hasPending = true;
+    }
+    _wake.notify_one();
+}
+
+void CheckpointWriter::finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _wake.notify_one();
+    if (_thread.joinable()) { _thread.join(); }
+    exitOnError();
+}
+
+// the writer thread only records a failure, the program stops on the thread that owns the run
+void CheckpointWriter::exitOnError()
+{
+    std::string error;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        error = _error;
+    }
+    if (error.empty()) { return; }
+    std::cout << "Saving error: " << error << std::endl;
+    exit(1);
+}
+
+void CheckpointWriter::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _wake.wait(lock, [this]() { return _hasPending || _stopping; });
+        if (!_hasPending) { return; }
+        KMeansCheckpoint checkpoint = std::move(_pending);
+        _hasPending = false;
+        // write without the lock, the loop can hand over the next state meanwhile
+        lock.unlock();
+        std::string error;
+        bool saved = try_save_checkpoint(_path, checkpoint, &error);
+        lock.lock();
+        if (saved) { _written++; }
+        else if (_error.empty()) { _error = error; }
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "structPoint.hpp"// Point structure definition
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * State of a k-means run after the assignment of an iteration, enough to continue it with the same result.
+ * The seed is the whole random state: random numbers are only drawn for the initial centroids.
+ */
+struct KMeansCheckpoint
+{
+    int run = 0;          ///< Cluster() call on the object
+    int iteration = 0;    ///< last finished iteration, 0 for the initial assignment
+    int pointsChanged = 0;///< of that iteration, 0 means the run had converged
+    unsigned seed = 0;    ///< seed of the initial centroids
+    int k = 0;
+    int dim = 0;
+    uint64_t pointsHash = 0;     ///< pointsFingerprint of the clustered points
+    std::vector<double> centroids;///< k x dim
+    std::vector<double> distances;///< Point::distance per point
+    std::vector<int32_t> labels;  ///< Point::cluster_id per point
+};
+
+/**
+ * File layout: this header, then centroids, distances and labels as raw arrays.
+ * `checksum` covers everything after the header, so a truncated or damaged file is rejected.
+ */
+struct KMeansCheckpointHeader
+{
+    char magic[4];// "KMCP"
+    int32_t version;
+    int32_t k;
+    int32_t dim;
+    int64_t numPoints;
+    int32_t run;
+    int32_t iteration;
+    int32_t pointsChanged;
+    uint32_t seed;
+    uint64_t pointsHash;
+    uint64_t checksum;
+};
+
+static_assert(sizeof(KMeansCheckpointHeader) == 56, "KMeansCheckpointHeader layout");
+
+const int32_t KMEANS_CHECKPOINT_VERSION = 1;
+
+// hash of the number, dimension and coordinates of the points, to check a checkpoint belongs to them
+uint64_t pointsFingerprint(const std::vector<Point>& points);
+
+// writes to `path`.tmp first and renames it, so a crash while writing keeps the previous checkpoint
+void save_checkpoint(const std::string& path, const KMeansCheckpoint& checkpoint);
+// save_checkpoint without exiting: false, with the reason in `error`, if the file could not be written
+bool try_save_checkpoint(const std::string& path, const KMeansCheckpoint& checkpoint, std::string* error = nullptr);
+KMeansCheckpoint read_checkpoint(const std::string& path);
+
+/**
+ * Writes checkpoints on a background thread, so the iteration loop only pays for the copy of the state.
+ * If a checkpoint is submitted while the previous one is still being written, it replaces any one waiting:
+ * only the newest state is worth writing. finish() (also called by the destructor) writes the waiting one and
+ * stops the thread. A failed write is reported by the next submit() or by finish(), on the owning thread.
+ */
+class CheckpointWriter
+{
+public:
+    explicit CheckpointWriter(std::string path);
+    ~CheckpointWriter();
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    void submit(KMeansCheckpoint checkpoint);
+    void finish();
+    int written() const { return _written; };
+
+private:
+    std::string _path;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    KMeansCheckpoint _pending;
+    bool _hasPending = false;
+    bool _stopping = false;
+    std::string _error;// of the first failed write
+    std::atomic<int> _written{0};
+    std::thread _thread;
+
+    void run();
+    void exitOnError();
+};
@@ -0,0 +1,34 @@
+#include "iterationMetrics.hpp"
+#include <iomanip>
+#include <sstream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+size_t peakResidentBytes()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) { return 0; }
+#ifdef __APPLE__
+    return (size_t) usage.ru_maxrss;// bytes on macOS
+#else
+    return (size_t) usage.ru_maxrss * 1024;// kilobytes on Linux
+#endif
+#else
+    return 0;
+#endif
+}
+
+// one JSON object on one line, for JSON lines files
+std::string iterationMetricsJson(const IterationMetrics& metrics)
+{
+    std::ostringstream line;
+    line << std::setprecision(9);
+    line << "{\"run\": " << metrics.run << ", \"iteration\": " << metrics.iteration << ", \"seconds\": " << metrics.seconds
+         << ", \"assign_seconds\": " << metrics.assignSeconds << ", \"update_seconds\": " << metrics.updateSeconds
+         << ", \"distance_evaluations\": " << metrics.distanceEvaluations << ", \"points_changed\": " << metrics.pointsChanged
+         << ", \"inertia\": " << metrics.inertia << ", \"centroid_shift\": " << metrics.centroidShift << ", \"bytes_read\": " << metrics.bytesRead
+         << ", \"peak_rss_bytes\": " << metrics.peakRssBytes << "}";
+    return line.str();
+}
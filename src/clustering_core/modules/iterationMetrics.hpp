@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+/**
+ * Counters of one k-means iteration, filled by KMeansND::Cluster.
+ * Iteration 0 is the initial assignment and has no update step.
+ */
+struct IterationMetrics
+{
+    int run;                      ///< Cluster() call on the object, starting at 0
+    int iteration;                ///< 0 for the initial assignment
+    double seconds;               ///< wall time of the whole iteration
+    double assignSeconds;         ///< assignPointsToCentroids
+    double updateSeconds;         ///< recalculateCentroids
+    long long distanceEvaluations;///< points x centroids of the assignment plus one per centroid for the shift
+    int pointsChanged;            ///< points that moved to another cluster
+    double inertia;               ///< sum of squared distances of the points to their centroid after the assignment
+    double centroidShift;         ///< largest distance a centroid moved in the update
+    size_t bytesRead;             ///< point coordinates streamed by the assignment and the update
+    size_t peakRssBytes;          ///< peak resident set size of the process so far, 0 where unknown
+};
+
+size_t peakResidentBytes();
+std::string iterationMetricsJson(const IterationMetrics& metrics);
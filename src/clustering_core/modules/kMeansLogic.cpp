@@ -0,0 +1,246 @@
+#include "kMeansLogic.hpp"
+#include "../../index_core/KDTree2D.hpp"
+#include "parallel.hpp"
+#include "progress.hpp"
+#include "scratchArena.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <iostream>
+#include <map>
+#include <random>// for randomly generated centroids
+#include <thread>
+
+// With CLUSTERING_MULTIVERSION (CMake option) the assignment scan is compiled for AVX2 and the baseline,
+// the loader picks the variant for the CPU it runs on
+#if defined(CLUSTERING_MULTIVERSION) && defined(__x86_64__)
+#define CLUSTERING_TARGET_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define CLUSTERING_TARGET_CLONES
+#endif
+
+// Sum of `values` as a pairwise tree over the indices: the same shape, and so the same rounding, on every run.
+// The partial sums are kept in `values`, so it is changed.
+double pairwiseSum(ScratchVector<double>& values)
+{
+    for (size_t stride = 1; stride < values.size(); stride *= 2)
+    {
+        for (size_t i = 0; i + stride < values.size(); i += 2 * stride) { values[i] += values[i + stride]; }
+    }
+    return values.empty() ? 0.0 : values[0];
+}
+
+// on the run's worker pool when there is one, otherwise on threads started for this call
+template<typename Body>
+static void runBlocks(const KMeansParallel& parallel, size_t count, const Body& body)
+{
+    if (parallel.pool) { parallel.pool->run(count, body); }
+    else { runParallel(parallel.threads, count, body); }
+}
+
+size_t numBlocks(size_t numPoints) { return std::max<size_t>(1, (numPoints + KMEANS_BLOCK_SIZE - 1) / KMEANS_BLOCK_SIZE); }
+
+// Assigns points [begin, end) and returns the number of changed ones; the squared distances are added to `inertia`.
+CLUSTERING_TARGET_CLONES int assignBlock(std::vector<Point>& _points, const std::vector<Point>& _centroids, size_t begin, size_t end, double& inertia)
+{
+    int points_changed = 0;
+    for (size_t i = begin; i < end; i++)
+    {
+        double min_dist = __DBL_MAX__;
+        int min_index = -1;
+        for (int j = 0; j < _centroids.size(); j++)
+        {
+            double dist = _points[i].calcDist(_centroids[j]);
+            if (dist < min_dist)
+            {
+                min_dist = dist;
+                min_index = j;
+            }
+        }
+        if (min_index >= 0) { inertia += min_dist * min_dist; }
+        if (_points[i].cluster_id != min_index)
+        {
+            _points[i].cluster_id = min_index;
+            _points[i].distance = min_dist;
+            points_changed++;
+        }
+    }
+    return points_changed;
+}
+
+// Points are assigned in blocks of KMEANS_BLOCK_SIZE. A point's result does not depend on the others and the
+// inertia of the blocks is added pairwise, so the outcome is the same for every thread count.
+int assignPointsToCentroids(std::vector<Point>& _points, const std::vector<Point>& _centroids, double* inertia, const KMeansParallel& parallel)
+{
+    if ((int) _centroids.size() >= KDTREE_MIN_CENTROIDS && _centroids[0].coords.size() == 2 && !_points.empty()
+        && _points[0].coords.size() == 2)
+    {
+        return assignPointsToCentroids2D(_points, _centroids, inertia, parallel);
+    }
+    // the per-block results live for this call only, they come from the thread's scratch buffer
+    ScratchArena arena;
+    size_t blocks = numBlocks(_points.size());
+    ScratchVector<int> changed(blocks, 0, arena.resource());
+    ScratchVector<double> blockInertia(blocks, 0.0, arena.resource());
+    runBlocks(parallel, blocks, [&](size_t b) {
+        size_t begin = b * KMEANS_BLOCK_SIZE;
+        size_t end = std::min(_points.size(), begin + KMEANS_BLOCK_SIZE);
+        changed[b] = assignBlock(_points, _centroids, begin, end, blockInertia[b]);
+        if (parallel.progress) { parallel.progress->add(end - begin, (end - begin) * _points[begin].coords.size() * sizeof(double)); }
+    });
+    if (inertia) { *inertia += pairwiseSum(blockInertia); }
+    int points_changed = 0;
+    for (int count: changed) { points_changed += count; }
+    return points_changed;
+}
+
+// Same assignment for 2D points (t-SNE runs) through a k-d tree over the centroids: the nearest centroid,
+// the lowest index on ties, and distance only updated when the cluster changes.
+int assignPointsToCentroids2D(std::vector<Point>& _points, const std::vector<Point>& _centroids, double* inertia, const KMeansParallel& parallel)
+{
+    ScratchArena arena;
+    ScratchVector<double> xs(_centroids.size(), arena.resource()), ys(_centroids.size(), arena.resource());
+    for (size_t j = 0; j < _centroids.size(); j++)
+    {
+        xs[j] = _centroids[j].coords[0];
+        ys[j] = _centroids[j].coords[1];
+    }
+    BasicKDTree2D<double> tree(xs.data(), ys.data(), xs.size());
+
+    size_t blocks = numBlocks(_points.size());
+    ScratchVector<int> changed(blocks, 0, arena.resource());
+    ScratchVector<double> blockInertia(blocks, 0.0, arena.resource());
+    runBlocks(parallel, blocks, [&](size_t b) {
+        size_t end = std::min(_points.size(), (b + 1) * KMEANS_BLOCK_SIZE);
+        for (size_t i = b * KMEANS_BLOCK_SIZE; i < end; i++)
+        {
+            Point& point = _points[i];
+            int min_index = tree.nearest(point.coords[0], point.coords[1]);
+            if (min_index >= 0)
+            {
+                double dx = point.coords[0] - xs[min_index], dy = point.coords[1] - ys[min_index];
+                blockInertia[b] += dx * dx + dy * dy;
+            }
+            if (point.cluster_id != min_index)
+            {
+                point.cluster_id = min_index;
+                point.distance = min_index < 0 ? __DBL_MAX__ : point.calcDist(_centroids[min_index]);
+                changed[b]++;
+            }
+        }
+        size_t begin = b * KMEANS_BLOCK_SIZE;
+        if (parallel.progress) { parallel.progress->add(end - begin, (end - begin) * 2 * sizeof(double)); }
+    });
+    if (inertia) { *inertia += pairwiseSum(blockInertia); }
+    int points_changed = 0;
+    for (int count: changed) { points_changed += count; }
+    return points_changed;
+}
+
+/**
+ * New centroids as the mean of their points. The points are split into leaves of consecutive points; every leaf
+ * sums its points per centroid in order, and the leaves are then combined pairwise (leaf 0 += leaf 1, 2 += 3, ...,
+ * then 0 += 2, ...).
+ * Reproducible: the leaves are KMEANS_BLOCK_SIZE points, fewer when their sums would not fit in
+ * KMEANS_REDUCTION_BUDGET, so the summation order only depends on the points and k, not on the threads.
+ * Otherwise: one leaf per thread.
+ * With a single leaf (up to KMEANS_BLOCK_SIZE points) this is the plain sum in point order.
+ * A centroid without points is set to the origin.
+ */
+void recalculateCentroids(const std::vector<Point>& _points, std::vector<Point>& _centroids, const KMeansParallel& parallel)
+{
+    size_t k = _centroids.size();
+    size_t dim = k == 0 ? 0 : _centroids[0].coords.size();
+    size_t leafSize = k * dim + k;// coordinate sums, then the counts
+    size_t leaves = numBlocks(_points.size());
+    if (parallel.reproducible)
+    {
+        leaves = std::min(leaves, std::max<size_t>(1, KMEANS_REDUCTION_BUDGET / (std::max<size_t>(1, leafSize) * sizeof(double))));
+    }
+    else
+    {
+        int threads = parallel.threads <= 0 ? (int) std::max(1u, std::thread::hardware_concurrency()) : parallel.threads;
+        leaves = std::min(leaves, (size_t) threads);
+    }
+
+    ScratchArena arena;
+    ScratchVector<double> sums(leaves * leafSize, 0.0, arena.resource());
+    runBlocks(parallel, leaves, [&](size_t leaf) {
+        double* leafSums = sums.data() + leaf * leafSize;
+        double* leafCounts = leafSums + k * dim;
+        size_t end = (leaf + 1) * _points.size() / leaves;
+        for (size_t i = leaf * _points.size() / leaves; i < end; i++)
+        {
+            const Point& point = _points[i];
+            if (point.cluster_id < 0 || point.cluster_id >= (int) k) { continue; }
+            double* centroidSums = leafSums + point.cluster_id * dim;
+            for (size_t j = 0; j < dim; j++) { centroidSums[j] += point.coords[j]; }
+            leafCounts[point.cluster_id] += 1;
+        }
+    });
+    for (size_t stride = 1; stride < leaves; stride *= 2)
+    {
+        size_t pairs = (leaves - stride + 2 * stride - 1) / (2 * stride);
+        auto combine = [&](size_t p) {
+            double* target = sums.data() + 2 * stride * p * leafSize;
+            const double* source = target + stride * leafSize;
+            for (size_t j = 0; j < leafSize; j++) { target[j] += source[j]; }
+        };
+        // the later strides are a few additions, handing them to other threads costs more than it saves;
+        // the pairs are disjoint, so the sums are the same either way
+        if (pairs * leafSize < KMEANS_PARALLEL_COMBINE_MIN)
+        {
+            for (size_t p = 0; p < pairs; p++) { combine(p); }
+        }
+        else { runBlocks(parallel, pairs, combine); }
+    }
+
+    const double* counts = sums.data() + k * dim;
+    for (size_t i = 0; i < k; i++)
+    {
+        _centroids[i].cluster_id = (int) i;
+        _centroids[i].distance = 0;
+        for (size_t j = 0; j < dim; j++)
+        {
+            // divide each coordinate by the number of points in the cluster, empty clusters stay at 0
+            _centroids[i].coords[j] = counts[i] > 0 ? sums[i * dim + j] / counts[i] : 0;
+        }
+    }
+}
+
+std::vector<Point> initialize_random_centroids(const std::vector<Point>& points, int k)
+{
+    std::random_device rd;
+    return initialize_random_centroids(points, k, rd());
+}
+
+std::vector<Point> initialize_random_centroids(const std::vector<Point>& points, int k, unsigned seed)
+{
+    // check that the number of centroids is less than the number of points
+    if (k > points.size())
+    {
+        std::cout << "The number of centroids is greater than the number of points" << std::endl;
+        std::cout << "Number of centroids: " << k << " Number of points: " << points.size() << std::endl;
+        exit(1);
+    }
+    // initialize centroids
+    std::vector<Point> centroids;
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> dis(0, points.size() - 1);
+    std::map<int, bool> used;// store used the indexes of centroids
+    for (int i = 0; i < k; i++)
+    {
+        int index = dis(gen);
+        while (used[index])
+        {
+            index = dis(gen);
+        }
+        used[index] = true;
+        centroids.push_back(points[index]);
+    }
+    for (int i = 0; i < centroids.size(); i++)// make them clusters
+    {
+        centroids[i].cluster_id = i;
+        centroids[i].distance = 0;
+    }
+    return centroids;
+}
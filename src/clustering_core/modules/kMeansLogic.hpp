@@ -1,126 +1,43 @@
 #pragma once
 #include "structPoint.hpp"// Point structure definition
-#include <cmath>
-#include <map>
-#include <random>// for randomly generated centroids
-#include <string>
+#include <cstddef>
 #include <vector>
 
-std::vector<Point> initialize_random_centroids(const std::vector<Point>& points, int k);
-int assignPointsToCentroids(std::vector<Point>& _points, const std::vector<Point>& _centroids);
-void recalculateCentroids(const std::vector<Point>& _points, std::vector<Point>& _centroids);
-
-int assignPointsToCentroids(std::vector<Point>& _points, const std::vector<Point>& _centroids)
-{
-    int points_changed = 0;
-    for (int i = 0; i < _points.size(); i++)
-    {
-        double min_dist = __DBL_MAX__;
-        int min_index = -1;
-        for (int j = 0; j < _centroids.size(); j++)
-        {
-            double dist = _points[i].calcDist(_centroids[j]);
-            if (dist < min_dist)
-            {
-                min_dist = dist;
-                min_index = j;
-            }
-        }
-        if (_points[i].cluster_id != min_index)
-        {
-            _points[i].cluster_id = min_index;
-            _points[i].distance = min_dist;
-            points_changed++;
-        }
-    }
-    return points_changed;
-}
+class Progress;
+class WorkerPool;
 
+// points per block of the parallel assignment and update: blocks, not threads, fix the order of the sums
+const size_t KMEANS_BLOCK_SIZE = 4096;
+// bytes for the per-block partial sums of a reproducible update, larger k x dim use fewer, larger blocks
+const size_t KMEANS_REDUCTION_BUDGET = 64 << 20;
+// doubles added by one pairwise combine step of the update below which it runs on the calling thread alone
+const size_t KMEANS_PARALLEL_COMBINE_MIN = 1 << 16;
 
-void recalculateCentroids(const std::vector<Point>& _points, std::vector<Point>& _centroids)
+/**
+ * How the assignment and update steps run.
+ * `threads` <= 0 uses one thread per core.
+ * With `reproducible` the per-centroid sums are added up in blocks of points and combined in a fixed pairwise
+ * order, so centroids and labels are bit-identical for every thread count. Without it every thread sums one
+ * share of the points: less memory, but the rounding depends on the number of threads.
+ */
+struct KMeansParallel
 {
-    // reset centroids
-    for (int i = 0; i < _centroids.size(); i++)
-    {
-        for (int j = 0; j < _centroids[i].coords.size(); j++) { _centroids[i].coords[j] = 0; }
-        _centroids[i].cluster_id = i;
-        _centroids[i].distance = 0;
-    }
-    // recalculate centroids
+    int threads = 1;
+    bool reproducible = true;
+    Progress* progress = nullptr;// if given, the assignment adds its points to it as it goes
+    WorkerPool* pool = nullptr;  // if given, runs the blocks on its threads instead of ones started per step
+};
 
-    std::map<int, int> points_per_cluster;// store the number of points in each cluster
-    for (const auto& point: _points)      // for each point
-    {
-        points_per_cluster[point.cluster_id]++;// update the number of points in each cluster
-        for (int j = 0; j < point.coords.size(); j++)
-        {
-            // update each coordinate of the centroid
-            _centroids[point.cluster_id].coords[j] += point.coords[j];
-        }
-    }
-    // divide each coordinate by the number of points in the cluster
-    for (int i = 0; i < _centroids.size(); i++)
-    {
-        if (points_per_cluster[i] > 0)// Avoid division by zero
-        {
-            for (int j = 0; j < _centroids[i].coords.size(); j++)
-            {
-                _centroids[i].coords[j] /= points_per_cluster[i];
-            }
-        }
-    }
-    // // check that all centroids are different
-    // for (int i = 0; i < _centroids.size(); i++)
-    // {
-    //     for (int j = i + 1; j < _centroids.size(); j++)
-    //     {
-    //         bool is_different = false;
-    //         for (int k = 0; k < _centroids[i].coords.size(); k++)
-    //         {
-    //             if (_centroids[i].coords[k] != _centroids[j].coords[k])
-    //             {
-    //                 is_different = true;
-    //                 break;
-    //             }
-    //         }
-    //         if (!is_different)
-    //         {
-    //             std::cout << "Error: centroids are the same" << std::endl;
-    //             exit(1);
-    //         }
-    //     }
-    // }
-}
+std::vector<Point> initialize_random_centroids(const std::vector<Point>& points, int k);
+// the same seed picks the same points
+std::vector<Point> initialize_random_centroids(const std::vector<Point>& points, int k, unsigned seed);
 
-std::vector<Point> initialize_random_centroids(const std::vector<Point>& points, int k)
-{
-    // check that the number of centroids is less than the number of points
-    if (k > points.size())
-    {
-        std::cout << "The number of centroids is greater than the number of points" << std::endl;
-        std::cout << "Number of centroids: " << k << " Number of points: " << points.size() << std::endl;
-        exit(1);
-    }
-    // initialize centroids
-    std::vector<Point> centroids;
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, points.size() - 1);
-    std::map<int, bool> used;// store used the indexes of centroids
-    for (int i = 0; i < k; i++)
-    {
-        int index = dis(gen);
-        while (used[index])
-        {
-            index = dis(gen);
-        }
-        used[index] = true;
-        centroids.push_back(points[index]);
-    }
-    for (int i = 0; i < centroids.size(); i++)// make them clusters
-    {
-        centroids[i].cluster_id = i;
-        centroids[i].distance = 0;
-    }
-    return centroids;
-}
+// `inertia`, if given, is increased by the squared distance of every point to its nearest centroid
+int assignPointsToCentroids(std::vector<Point>& _points, const std::vector<Point>& _centroids, double* inertia = nullptr,
+                            const KMeansParallel& parallel = KMeansParallel());
+int assignPointsToCentroids2D(std::vector<Point>& _points, const std::vector<Point>& _centroids, double* inertia = nullptr,
+                              const KMeansParallel& parallel = KMeansParallel());
+void recalculateCentroids(const std::vector<Point>& _points, std::vector<Point>& _centroids, const KMeansParallel& parallel = KMeansParallel());
+
+// below this many centroids a linear scan beats building a tree
+const int KDTREE_MIN_CENTROIDS = 64;
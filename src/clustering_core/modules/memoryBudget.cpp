@@ -0,0 +1,139 @@
+#include "memoryBudget.hpp"
+#include "iterationMetrics.hpp"
+#include "structPoint.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+size_t MemoryBudget::physicalMemory()
+{
+#if defined(_SC_PHYS_PAGES) && defined(_SC_PAGESIZE)
+    long pages = sysconf(_SC_PHYS_PAGES), pageSize = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && pageSize > 0) { return (size_t) pages * (size_t) pageSize; }
+#endif
+    return 0;
+}
+
+static std::atomic<size_t>& budgetLimit()
+{
+    static std::atomic<size_t> limit([]() -> size_t {
+        const char* value = std::getenv("CLUSTERING_MEMORY_BUDGET_MB");
+        if (value != nullptr) { return (size_t) (std::atof(value) * (1 << 20)); }
+        return MemoryBudget::physicalMemory() / 4 * 3;
+    }());
+    return limit;
+}
+
+static std::atomic<size_t> budgetUsed(0);
+static std::atomic<size_t> budgetPeak(0);
+
+static std::mutex reportsMutex;
+static std::vector<MemoryStageReport> reports;
+
+void MemoryBudget::setLimit(size_t bytes) { budgetLimit() = bytes; }
+size_t MemoryBudget::limit() { return budgetLimit(); }
+size_t MemoryBudget::used() { return budgetUsed; }
+
+size_t MemoryBudget::available()
+{
+    size_t limit = budgetLimit(), used = budgetUsed;
+    if (limit == 0) { return std::numeric_limits<size_t>::max(); }
+    return used < limit ? limit - used : 0;
+}
+
+bool MemoryBudget::fits(size_t bytes) { return bytes <= available(); }
+
+static std::string megabytes(size_t bytes)
+{
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(1) << bytes / (double) (1 << 20) << " MB";
+    return text.str();
+}
+
+MemoryReservation::MemoryReservation(std::string what, size_t bytes, bool required) : _what(std::move(what)), _bytes(bytes)
+{
+    if (required && !MemoryBudget::fits(bytes))
+    {
+        std::cout << "Memory budget exceeded: " << _what << " needs " << megabytes(bytes) << ", " << megabytes(MemoryBudget::used()) << " of "
+                  << megabytes(MemoryBudget::limit()) << " are in use (set CLUSTERING_MEMORY_BUDGET_MB to change the budget)" << std::endl;
+        exit(1);
+    }
+    size_t used = budgetUsed.fetch_add(bytes) + bytes;
+    size_t peak = budgetPeak;
+    while (used > peak && !budgetPeak.compare_exchange_weak(peak, used)) {}
+}
+
+MemoryReservation::MemoryReservation(MemoryReservation&& other) noexcept : _what(std::move(other._what)), _bytes(other._bytes) { other._bytes = 0; }
+
+MemoryReservation& MemoryReservation::operator=(MemoryReservation&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        _what = std::move(other._what);
+        _bytes = other._bytes;
+        other._bytes = 0;
+    }
+    return *this;
+}
+
+void MemoryReservation::release()
+{
+    budgetUsed -= _bytes;
+    _bytes = 0;
+}
+
+size_t pointsBytes(size_t n, size_t dim)
+{
+    // the Point objects, and one heap block per coordinate vector with the allocator's header
+    return n * (sizeof(Point) + sizeof(double) * dim + 16);
+}
+
+MemoryStage::MemoryStage(std::string stage) : _stage(std::move(stage))
+{
+    // the peak restarts at the current use for this stage; the outer one is restored when it closes
+    _outerPeak = budgetPeak.exchange(budgetUsed);
+}
+
+MemoryStage::~MemoryStage()
+{
+    size_t peak = budgetPeak;
+    MemoryStageReport report{_stage, _strategy, peak, MemoryBudget::limit(), peakResidentBytes()};
+    size_t outer = std::max(peak, _outerPeak);
+    while (!budgetPeak.compare_exchange_weak(peak, std::max(peak, outer))) {}
+    std::lock_guard<std::mutex> lock(reportsMutex);
+    reports.push_back(report);
+}
+
+std::vector<MemoryStageReport> memoryStageReports()
+{
+    std::lock_guard<std::mutex> lock(reportsMutex);
+    return reports;
+}
+
+void clearMemoryStageReports()
+{
+    std::lock_guard<std::mutex> lock(reportsMutex);
+    reports.clear();
+}
+
+std::string memoryReport()
+{
+    std::ostringstream text;
+    text << "| stage | strategy | peak reserved | budget | process peak RSS |\n|---|---|---:|---:|---:|\n";
+    for (const MemoryStageReport& report: memoryStageReports())
+    {
+        text << "| " << report.stage << " | " << (report.strategy.empty() ? "-" : report.strategy) << " | " << megabytes(report.peakBytes) << " | "
+             << (report.limitBytes ? megabytes(report.limitBytes) : "none") << " | " << (report.peakRssBytes ? megabytes(report.peakRssBytes) : "-")
+             << " |\n";
+    }
+    return text.str();
+}
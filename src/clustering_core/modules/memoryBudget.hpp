@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Accounting of the large buffers of the pipeline (points, centroids, labels, cluster partitions, indexes)
+ * against one memory budget for the process.
+ *
+ * The owner of a buffer holds a MemoryReservation of its size for as long as the buffer lives. Stages that
+ * have a cheaper strategy ask MemoryBudget::fits() first and fall back to it, e.g. read_from_npy reads in
+ * chunks instead of the whole file. A required reservation that does not fit stops the program before the
+ * allocation, with the sizes involved, instead of letting the machine run out of memory.
+ *
+ * The budget is 3/4 of the physical memory by default, CLUSTERING_MEMORY_BUDGET_MB or setLimit() replace it,
+ * 0 means unlimited. Only reserved buffers count, so keep some headroom for the rest of the process.
+ */
+class MemoryBudget
+{
+public:
+    static void setLimit(size_t bytes);
+    static size_t limit();
+    static size_t used();
+    static size_t available();// limit - used, the largest size_t without a limit
+    static bool fits(size_t bytes);
+    static size_t physicalMemory();// 0 where unknown
+};
+
+class MemoryReservation
+{
+public:
+    MemoryReservation() = default;
+    // `required`: exit with a message if the bytes do not fit; otherwise they are counted anyway
+    MemoryReservation(std::string what, size_t bytes, bool required = true);
+    ~MemoryReservation() { release(); };
+    MemoryReservation(const MemoryReservation&) = delete;
+    MemoryReservation& operator=(const MemoryReservation&) = delete;
+    MemoryReservation(MemoryReservation&& other) noexcept;
+    MemoryReservation& operator=(MemoryReservation&& other) noexcept;
+
+    void release();
+    size_t bytes() const { return _bytes; };
+
+private:
+    std::string _what;
+    size_t _bytes = 0;
+};
+
+// approximate heap use of a std::vector<Point> with n points of `dim` coordinates
+size_t pointsBytes(size_t n, size_t dim);
+
+struct MemoryStageReport
+{
+    std::string stage;
+    std::string strategy;  ///< e.g. "whole file" or "chunks of 65536 rows", empty if the stage has only one
+    size_t peakBytes;      ///< largest reserved total while the stage ran
+    size_t limitBytes;     ///< budget at the end of the stage, 0 for none
+    size_t peakRssBytes;   ///< peak resident set size of the process so far (see peakResidentBytes)
+};
+
+/**
+ * Scope of one pipeline stage: records the peak of the reserved bytes while it is open and appends a
+ * MemoryStageReport when it closes. Stages nest; open and close them on one thread.
+ */
+class MemoryStage
+{
+public:
+    explicit MemoryStage(std::string stage);
+    ~MemoryStage();
+    MemoryStage(const MemoryStage&) = delete;
+    MemoryStage& operator=(const MemoryStage&) = delete;
+
+    void setStrategy(std::string strategy) { _strategy = std::move(strategy); };
+
+private:
+    std::string _stage;
+    std::string _strategy;
+    size_t _outerPeak;
+};
+
+std::vector<MemoryStageReport> memoryStageReports();
+void clearMemoryStageReports();
+// markdown table of the reports, one row per stage
+std::string memoryReport();
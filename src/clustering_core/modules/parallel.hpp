@@ -0,0 +1,116 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs body(0) .. body(count - 1) on up to `threads` threads (<= 0: one per core), the calling thread included.
+// Which thread runs which index is not fixed, so the bodies must write to disjoint places.
+template<typename Body>
+void runParallel(int threads, size_t count, const Body& body)
+{
+    if (threads <= 0) { threads = std::max(1u, std::thread::hardware_concurrency()); }
+    threads = (int) std::min<size_t>(threads, count);
+    if (threads <= 1)
+    {
+        for (size_t i = 0; i < count; i++) { body(i); }
+        return;
+    }
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++) { body(i); }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) { pool.emplace_back(worker); }
+    worker();
+    for (auto& thread: pool) { thread.join(); }
+}
+
+/**
+ * Threads that are started once and run many loops, for code that calls runParallel many times in a row
+ * (the passes of every k-means iteration). run() has the semantics of runParallel with the pool's thread count;
+ * the workers sleep between calls. One loop at a time: run() must not be called from a body.
+ */
+class WorkerPool
+{
+public:
+    // `threads` counts the calling thread, <= 0 is one per core
+    explicit WorkerPool(int threads)
+    {
+        if (threads <= 0) { threads = std::max(1u, std::thread::hardware_concurrency()); }
+        for (int t = 1; t < threads; t++) { _workers.emplace_back(&WorkerPool::work, this); }
+    }
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _wake.notify_all();
+        for (auto& worker: _workers) { worker.join(); }
+    }
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int threads() const { return (int) _workers.size() + 1; }
+
+    template<typename Body>
+    void run(size_t count, const Body& body)
+    {
+        if (_workers.empty() || count <= 1)
+        {
+            for (size_t i = 0; i < count; i++) { body(i); }
+            return;
+        }
+        std::function<void(size_t)> task = std::cref(body);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _task = &task;
+            _count = count;
+            _next = 0;
+            _busy = _workers.size();
+            _generation++;
+        }
+        _wake.notify_all();
+        for (size_t i = _next++; i < count; i = _next++) { task(i); }
+        // the task lives on this stack, so every worker has to be done with it
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [this]() { return _busy == 0; });
+        _task = nullptr;
+    }
+
+private:
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    const std::function<void(size_t)>* _task = nullptr;
+    size_t _count = 0;
+    std::atomic<size_t> _next{0};
+    size_t _busy = 0;        ///< workers still in the current loop
+    uint64_t _generation = 0;///< number of loops started, a worker joins each one once
+    bool _stopping = false;
+
+    void work()
+    {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true)
+        {
+            _wake.wait(lock, [&]() { return _stopping || _generation != seen; });
+            if (_stopping) { return; }
+            seen = _generation;
+            const std::function<void(size_t)>& task = *_task;
+            size_t count = _count;
+            lock.unlock();
+            for (size_t i = _next++; i < count; i = _next++) { task(i); }
+            lock.lock();
+            if (--_busy == 0) { _done.notify_one(); }
+        }
+    }
+};
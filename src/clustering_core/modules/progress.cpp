@@ -0,0 +1,125 @@
+#include "progress.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+static std::atomic<bool>& progressEnabled()
+{
+    static std::atomic<bool> enabled([]() {
+        const char* value = std::getenv("CLUSTERING_PROGRESS");
+        return value == nullptr || std::string(value) != "0";
+    }());
+    return enabled;
+}
+
+static std::atomic<double> progressInterval(1.0);
+static std::atomic<std::ostream*> progressOutput(nullptr);
+
+void Progress::setEnabled(bool enabled) { progressEnabled() = enabled; }
+bool Progress::enabled() { return progressEnabled(); }
+void Progress::setInterval(double seconds) { progressInterval = seconds; }
+void Progress::setOutput(std::ostream* output) { progressOutput = output; }
+
+Progress::Progress(std::string stage, size_t totalRows, size_t totalBytes) : _stage(std::move(stage)), _totalRows(totalRows), _totalBytes(totalBytes)
+{
+    _start = _lastPrint = Clock::now();
+    // disabled: add() never gets past the comparison
+    if (enabled()) { _nextCheck = 1; }
+}
+
+Progress::~Progress() { finish(); }
+
+void Progress::check(size_t done)
+{
+    std::unique_lock<std::mutex> lock(_mutex, std::try_to_lock);
+    if (!lock.owns_lock() || _finished) { return; }
+    Clock::time_point now = Clock::now();
+    double elapsed = std::chrono::duration<double>(now - _start).count();
+    double interval = progressInterval;
+    if (std::chrono::duration<double>(now - _lastPrint).count() >= interval)
+    {
+        print(status(elapsed), false);
+        _lastPrint = now;
+        _printed = true;
+    }
+    // look at the clock again after about a quarter of the interval at the rate so far; the step at most doubles
+    // the rows, so a rate measured on the first few fast rows cannot push the next check far out
+    double rate = elapsed > 0 ? done / elapsed : 0;
+    size_t step = std::min(done, (size_t) (rate * interval / 4));
+    _nextCheck.store(done + std::max<size_t>(1, step), std::memory_order_relaxed);
+}
+
+void Progress::finish()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_finished) { return; }
+    _finished = true;
+    _nextCheck = std::numeric_limits<size_t>::max();
+    if (_printed) { print(status(std::chrono::duration<double>(Clock::now() - _start).count()), true); }
+}
+
+std::string Progress::status(double seconds) const
+{
+    size_t rows = this->rows(), bytes = this->bytes();
+    std::ostringstream text;
+    text << formatCount((double) rows);
+    if (_totalRows) { text << " / " << formatCount((double) _totalRows); }
+    text << " rows";
+    double fraction = _totalRows ? (double) rows / _totalRows : _totalBytes ? (double) bytes / _totalBytes : -1;
+    if (fraction >= 0) { text << " (" << (int) (100 * std::min(1.0, fraction)) << "%)"; }
+    if (seconds > 0)
+    {
+        text << ", " << formatCount(rows / seconds) << " rows/s";
+        if (bytes) { text << ", " << std::fixed << std::setprecision(0) << bytes / seconds / 1e6 << " MB/s"; }
+    }
+    if (_finished) { text << ", done in " << formatDuration(seconds); }
+    else if (fraction > 0 && fraction < 1) { text << ", ETA " << formatDuration(seconds * (1 - fraction) / fraction); }
+    return text.str();
+}
+
+void Progress::print(const std::string& text, bool last)
+{
+    std::ostream* output = progressOutput;
+    bool terminal = false;
+    if (output == nullptr)
+    {
+        output = &std::cerr;
+#if defined(__unix__) || defined(__APPLE__)
+        terminal = isatty(fileno(stderr));
+#endif
+    }
+    // on a terminal the line is rewritten in place, elsewhere (logs, pipes) every update is a line of its own
+    if (terminal) { *output << "\r\033[K" << _stage << ": " << text << (last ? "\n" : "") << std::flush; }
+    else { *output << _stage << ": " << text << std::endl; }
+}
+
+std::string Progress::formatCount(double value)
+{
+    const char* suffixes[] = {"", "k", "M", "G", "T"};
+    int unit = 0;
+    while (value >= 1000 && unit < 4)
+    {
+        value /= 1000;
+        unit++;
+    }
+    std::ostringstream text;
+    if (unit > 0 && value < 100) { text << std::setprecision(3) << value << suffixes[unit]; }
+    else { text << std::fixed << std::setprecision(0) << value << suffixes[unit]; }
+    return text.str();
+}
+
+std::string Progress::formatDuration(double seconds)
+{
+    std::ostringstream text;
+    long long whole = (long long) seconds;
+    if (seconds < 60) { text << std::fixed << std::setprecision(1) << seconds << "s"; }
+    else if (seconds < 3600) { text << whole / 60 << "m" << std::setw(2) << std::setfill('0') << whole % 60 << "s"; }
+    else { text << whole / 3600 << "h" << std::setw(2) << std::setfill('0') << whole / 60 % 60 << "m"; }
+    return text.str();
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+/**
+ * Progress of one long stage, printed as
+ *   reading embeddings.npy: 1.2M / 3M rows (40%), 850k rows/s, 310 MB/s, ETA 2.1s
+ * and, if anything was printed, a last line when the stage ends.
+ *
+ * add() may be called from any thread. It costs two relaxed atomic additions; the clock is only read once the
+ * rows reach the next check, which is spaced to about a quarter of the print interval at the current rate, and
+ * a line is printed at most once per interval. Stages shorter than the interval print nothing.
+ * ETA and percentage use the total rows if known, otherwise the total bytes.
+ *
+ * Output goes to std::cerr, rewriting one line on a terminal. Progress::setEnabled(false), or the environment
+ * variable CLUSTERING_PROGRESS=0, silences every stage for batch runs.
+ */
+class Progress
+{
+public:
+    explicit Progress(std::string stage, size_t totalRows = 0, size_t totalBytes = 0);
+    ~Progress();
+    Progress(const Progress&) = delete;
+    Progress& operator=(const Progress&) = delete;
+
+    void add(size_t rows, size_t bytes = 0)
+    {
+        size_t done = _rows.fetch_add(rows, std::memory_order_relaxed) + rows;
+        if (bytes) { _bytes.fetch_add(bytes, std::memory_order_relaxed); }
+        if (done >= _nextCheck.load(std::memory_order_relaxed)) { check(done); }
+    }
+    void finish();
+
+    size_t rows() const { return _rows.load(std::memory_order_relaxed); };
+    size_t bytes() const { return _bytes.load(std::memory_order_relaxed); };
+    bool printed() const { return _printed; };
+
+    static void setEnabled(bool enabled);
+    static bool enabled();
+    static void setInterval(double seconds);// 1 s by default
+    static void setOutput(std::ostream* output);// std::cerr by default, for tests
+
+    // "850", "12.3k", "1.2M", "4.5G" and "0.8s", "2m05s", "1h02m"
+    static std::string formatCount(double value);
+    static std::string formatDuration(double seconds);
+    // the text of a line after `seconds`, without the stage name
+    std::string status(double seconds) const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    std::string _stage;
+    size_t _totalRows;
+    size_t _totalBytes;
+    std::atomic<size_t> _rows{0};
+    std::atomic<size_t> _bytes{0};
+    std::atomic<size_t> _nextCheck{std::numeric_limits<size_t>::max()};
+    Clock::time_point _start;
+    Clock::time_point _lastPrint;
+    std::mutex _mutex;// held while checking the clock and printing, other threads skip the check
+    bool _printed = false;
+    bool _finished = false;
+
+    void check(size_t done);
+    void print(const std::string& text, bool last);
+};
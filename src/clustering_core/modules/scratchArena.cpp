@@ -0,0 +1,40 @@
+#include "scratchArena.hpp"
+#include <algorithm>
+
+// per thread: one buffer per nesting level, and the level of the innermost open scope
+struct ScratchBuffers
+{
+    std::vector<std::vector<std::byte>> levels;
+    size_t depth = 0;
+};
+
+static thread_local ScratchBuffers scratchBuffers;
+
+// the first scope of a level starts from a small heap block and leaves the buffer its size
+static const size_t SCRATCH_ARENA_FIRST_BLOCK = 4096;
+
+std::pmr::monotonic_buffer_resource ScratchArena::makeResource(size_t level, std::pmr::memory_resource* upstream)
+{
+    if (scratchBuffers.levels.size() <= level) { scratchBuffers.levels.resize(level + 1); }
+    std::vector<std::byte>& buffer = scratchBuffers.levels[level];
+    if (buffer.empty()) { return std::pmr::monotonic_buffer_resource(SCRATCH_ARENA_FIRST_BLOCK, upstream); }
+    return std::pmr::monotonic_buffer_resource(buffer.data(), buffer.size(), upstream);
+}
+
+ScratchArena::ScratchArena() : _level(scratchBuffers.depth++), _resource(makeResource(_level, &_upstream)) {}
+
+ScratchArena::~ScratchArena()
+{
+    _resource.release();
+    scratchBuffers.depth--;
+    // the buffer is grown by what the scope took from the heap, so an equal scope fits next time
+    std::vector<std::byte>& buffer = scratchBuffers.levels[_level];
+    size_t wanted = std::min(SCRATCH_ARENA_MAX_BYTES, buffer.size() + _upstream.bytes);
+    if (wanted > buffer.size())
+    {
+        buffer = std::vector<std::byte>();
+        buffer.resize(wanted);
+    }
+}
+
+size_t ScratchArena::threadBufferBytes(size_t level) { return level < scratchBuffers.levels.size() ? scratchBuffers.levels[level].size() : 0; }
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+// largest buffer a thread keeps per nesting level between scopes; bigger scopes take the rest from the heap
+const size_t SCRATCH_ARENA_MAX_BYTES = 16 << 20;
+
+template<typename T>
+using ScratchVector = std::pmr::vector<T>;
+
+/**
+ * Scratch memory for the temporaries of one iteration, one query or one post-processing job.
+ *
+ * A ScratchArena scope hands out a std::pmr::monotonic_buffer_resource over a buffer owned by the calling thread:
+ * an allocation is a pointer bump and nothing is freed before the scope closes. The next scope on the thread reuses
+ * the buffer. What does not fit comes from the heap, and when the scope closes the buffer grows by that much, up
+ * to SCRATCH_ARENA_MAX_BYTES. A loop of similar scopes (k-means iterations, queries) therefore stops allocating
+ * from the heap after its first round.
+ *
+ *   ScratchArena arena;
+ *   ScratchVector<int> order(points.size(), 0, arena.resource());
+ *
+ * Scopes nest, each level of a thread has its own buffer. Memory of a scope must not outlive it, and the scope
+ * must close on the thread that opened it; other threads may use memory it handed out meanwhile, as the
+ * workers of runParallel write into the caller's arrays.
+ */
+class ScratchArena
+{
+public:
+    ScratchArena();
+    ~ScratchArena();
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &_resource; };
+    // bytes this scope had to take from the heap so far
+    size_t overflowBytes() const { return _upstream.bytes; };
+    // buffer of the calling thread for scopes at nesting level `level`, 0 before its first scope there
+    static size_t threadBufferBytes(size_t level = 0);
+
+private:
+    // forwards to the default heap resource and adds up what it hands out
+    struct CountingResource : std::pmr::memory_resource
+    {
+        size_t bytes = 0;
+
+        void* do_allocate(size_t size, size_t alignment) override
+        {
+            bytes += size;
+            return std::pmr::new_delete_resource()->allocate(size, alignment);
+        }
+        void do_deallocate(void* memory, size_t size, size_t alignment) override
+        {
+            std::pmr::new_delete_resource()->deallocate(memory, size, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    size_t _level;
+    CountingResource _upstream;
+    std::pmr::monotonic_buffer_resource _resource;
+
+    static std::pmr::monotonic_buffer_resource makeResource(size_t level, std::pmr::memory_resource* upstream);
+};
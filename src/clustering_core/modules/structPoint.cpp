@@ -0,0 +1,52 @@
+#include "structPoint.hpp"
+
+Point::Point(const std::vector<double>& coords, int cluster_id, double distance)
+    : coords(coords), distance(distance), cluster_id(cluster_id) {}
+
+Point::Point(std::initializer_list<double> list)
+    : coords(list), distance(INT_MAX), cluster_id(-1) {}
+
+Point::Point(const std::vector<double>& coords)
+    : coords(coords), distance(INT_MAX), cluster_id(-1) {}
+
+Point::Point(std::vector<double>&& coords)
+    : coords(std::move(coords)), distance(INT_MAX), cluster_id(-1) {}
+
+Point::Point(const std::vector<double>& coords, int cluster_id)
+    : coords(coords), distance(0), cluster_id(cluster_id) {}
+
+Point::Point()
+    : distance(INT_MAX), cluster_id(-1), coords({}) {}
+
+double Point::CalcNorm() const {
+    double sum = 0;
+    for (int i = 0; i < coords.size(); i++) {
+        sum += pow(coords[i], 2);
+    }
+    return sqrt(sum);
+}
+
+bool Point::operator==(const Point& other) const {
+    return (coords == other.coords);
+}
+
+bool Point::operator!=(const Point& other) const {
+    return !(*this == other);
+}
+
+bool Point::operator<(const Point& other) const {
+    if (cluster_id == -1 && other.cluster_id == -1) {
+        return CalcNorm() < other.CalcNorm();
+    }
+    return distance < other.distance;
+}
+
+std::ostream& operator<<(std::ostream& os, const Point& p) {
+    os << "cluster_id: " << p.cluster_id << ", distance: " << p.distance;
+    os << ", coords: [ ";
+    for (int i = 0; i < p.coords.size(); i++) {
+        os << p.coords[i] << " ";
+    }
+    os << "]";
+    return os;
+}
\ No newline at end of file
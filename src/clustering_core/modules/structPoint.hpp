@@ -21,9 +21,15 @@ public:
     Point(const std::vector<double>& coords, int cluster_id, double distance);
     Point(std::initializer_list<double> list);
     Point(const std::vector<double>& coords);
+    Point(std::vector<double>&& coords);
     Point(const std::vector<double>& coords, int cluster_id);
     Point();
     ~Point() = default;
+    // declared because of the destructor, which would otherwise turn every move of a Point into a copy
+    Point(const Point&) = default;
+    Point(Point&&) noexcept = default;
+    Point& operator=(const Point&) = default;
+    Point& operator=(Point&&) noexcept = default;
 
     double calcDist(const Point& other) const;
     double CalcNorm() const;
@@ -35,60 +41,11 @@ public:
     friend std::ostream& operator<<(std::ostream& os, const Point& p);
 };
 
-// Implementations of Point methods
-
-Point::Point(const std::vector<double>& coords, int cluster_id, double distance)
-    : coords(coords), distance(distance), cluster_id(cluster_id) {}
-
-Point::Point(std::initializer_list<double> list)
-    : coords(list), distance(INT_MAX), cluster_id(-1) {}
-
-Point::Point(const std::vector<double>& coords)
-    : coords(coords), distance(INT_MAX), cluster_id(-1) {}
-
-Point::Point(const std::vector<double>& coords, int cluster_id)
-    : coords(coords), distance(0), cluster_id(cluster_id) {}
-
-Point::Point()
-    : distance(INT_MAX), cluster_id(-1), coords({}) {}
-
-double Point::calcDist(const Point& other) const {
+// the distance is the inner loop of every assignment, it stays in the header to be inlined there
+inline double Point::calcDist(const Point& other) const {
     double sum = 0;
     for (int i = 0; i < coords.size(); i++) {
         sum += pow(coords[i] - other.coords[i], 2);
     }
     return sqrt(sum);
 }
-
-double Point::CalcNorm() const {
-    double sum = 0;
-    for (int i = 0; i < coords.size(); i++) {
-        sum += pow(coords[i], 2);
-    }
-    return sqrt(sum);
-}
-
-bool Point::operator==(const Point& other) const {
-    return (coords == other.coords);
-}
-
-bool Point::operator!=(const Point& other) const {
-    return !(*this == other);
-}
-
-bool Point::operator<(const Point& other) const {
-    if (cluster_id == -1 && other.cluster_id == -1) {
-        return CalcNorm() < other.CalcNorm();
-    }
-    return distance < other.distance;
-}
-
-std::ostream& operator<<(std::ostream& os, const Point& p) {
-    os << "cluster_id: " << p.cluster_id << ", distance: " << p.distance;
-    os << ", coords: [ ";
-    for (int i = 0; i < p.coords.size(); i++) {
-        os << p.coords[i] << " ";
-    }
-    os << "]";
-    return os;
-}
\ No newline at end of file
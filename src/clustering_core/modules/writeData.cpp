@@ -0,0 +1,372 @@
+#include "writeData.hpp"
+#include "../include/npy.hpp"// https://github.com/llohse/libnpy
+#include "progress.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+// Progress of writing points: rows are counted one by one, the bytes are taken from the stream position every
+// 1024 rows. finish() before closing the file.
+class WriteProgress
+{
+public:
+    WriteProgress(const std::string& path, size_t rows, std::ofstream& file)
+        : _progress("writing " + std::filesystem::path(path).filename().string(), rows), _file(file), _reported(file.tellp())
+    {
+    }
+    ~WriteProgress() { finish(); }
+
+    void row()
+    {
+        if (++_pending == 1024) { report(); }
+    }
+    void finish()
+    {
+        if (_pending) { report(); }
+        _progress.finish();
+    }
+
+private:
+    Progress _progress;
+    std::ofstream& _file;
+    std::streampos _reported;
+    size_t _pending = 0;
+
+    void report()
+    {
+        std::streampos position = _file.tellp();
+        _progress.add(_pending, position > _reported ? (size_t) (position - _reported) : 0);
+        _reported = position;
+        _pending = 0;
+    }
+};
+
+void save_result(const std::string& _resultPath, const std::vector<Point>& _points, const std::vector<Point>& _centroids, bool _with_coordinates)
+{
+    // Determine the file type based on its extension
+    std::string extension = _resultPath.substr(_resultPath.size() - 4);
+    if (extension == ".csv") { save_result_to_csv(_resultPath, _points, _centroids, _with_coordinates); }
+    else if (extension == ".txt") { save_result_to_txt(_resultPath, _points, _centroids, _with_coordinates); }
+    else if (extension == ".npy") { save_result_to_npy(_resultPath, _points, _centroids, _with_coordinates); }
+
+    else
+    {
+        std::cout << "File type for result not supported" << std::endl;
+        std::cout << "Supported file types: csv, npy, txt" << std::endl;
+        exit(1);
+    }
+}
+
+void save_centroids(std::string _resultPath, const std::vector<Point>& _centroids)
+{
+    // Determine the file type based on its extension
+    std::string extension = _resultPath.substr(_resultPath.size() - 4);
+
+    std::cout << "Writing centroids...";
+
+    // Write data to a CSV file
+    if (extension == ".csv") { save_centroids_to_csv(_resultPath, _centroids); }
+    else if (extension == ".npy") { save_centroids_to_npy(_resultPath, _centroids); }
+    else if (extension == ".txt") { save_centroids_to_txt(_resultPath, _centroids); }
+    else
+    {
+        std::cout << "File type for clusters not supported" << std::endl;
+        std::cout << "Supported file types: csv, npy, txt" << std::endl;
+        exit(1);
+    }
+    std::cout << "done" << std::endl;
+}
+
+void save_result_to_csv(const std::string& _resultPath, const std::vector<Point>& _points, const std::vector<Point>& _centroids, bool _with_coordinates)
+{
+    std::ofstream file(_resultPath);
+    if (!file.is_open())
+    {
+        std::cout << "Saving error" << std::endl;
+        exit(1);
+    }
+    // with coordinates
+    if (_with_coordinates)
+    {
+        // save headers
+        file << "cluster_id,distance,";
+        for (int i = 0; i < _points[0].coords.size(); i++)
+        {
+            file << "x" << i << ",";
+        }
+        file << std::endl;
+
+        // save data
+        WriteProgress progress(_resultPath, _points.size(), file);
+        for (int i = 0; i < _points.size(); i++)
+        {
+            file << _points[i].cluster_id << "," << _points[i].distance << ",";
+            for (int j = 0; j < _points[i].coords.size(); j++)
+            {
+                file << _points[i].coords[j] << ",";
+            }
+            file << std::endl;
+            progress.row();
+        }
+        progress.finish();
+        file.close();
+    }
+    // without coordinates
+    else
+    {
+        // save headers
+        file << "cluster_id,distance" << std::endl;
+
+        // save data
+        WriteProgress progress(_resultPath, _points.size(), file);
+        for (int i = 0; i < _points.size(); i++)
+        {
+            file << _points[i].cluster_id << "," << _points[i].distance << std::endl;
+            progress.row();
+        }
+        progress.finish();
+        file.close();
+    }
+}
+
+void save_centroids_to_csv(const std::string& _resultPath, const std::vector<Point>& _centroids)
+{
+    std::ofstream file(_resultPath);
+    if (!file.is_open())
+    {
+        std::cout << "Saving error" << std::endl;
+        exit(1);
+    }
+    // save headers
+    file << "cluster_id,distance,";
+    for (int i = 0; i < _centroids[0].coords.size(); i++)
+    {
+        file << "x" << i << ",";
+    }
+    file << std::endl;
+
+    // save data
+    for (int i = 0; i < _centroids.size(); i++)
+    {
+        file << _centroids[i].cluster_id << "," << _centroids[i].distance << ",";
+        for (int j = 0; j < _centroids[i].coords.size(); j++)
+        {
+            file << _centroids[i].coords[j] << ",";
+        }
+        file << std::endl;
+    }
+    file.close();
+}
+
+void save_result_to_txt(const std::string& _resultPath, const std::vector<Point>& _points, const std::vector<Point>& _centroids, bool _with_coordinates)
+{
+    if (_with_coordinates)
+    {
+        // open file
+        std::ofstream file(_resultPath);
+        if (!file.is_open())
+        {
+            std::cout << "Saving error" << std::endl;
+            exit(1);
+        }
+        // save headers
+        file << "cluster_id,distance,";
+        for (int i = 0; i < _points[0].coords.size(); i++)
+        {
+            file << "x" << i << ",";
+        }
+        file << std::endl;
+
+        // save data
+        WriteProgress progress(_resultPath, _points.size(), file);
+        for (int i = 0; i < _points.size(); i++)
+        {
+            file << _points[i].cluster_id << "," << _points[i].distance << ",";
+            for (int j = 0; j < _points[i].coords.size(); j++)
+            {
+                file << _points[i].coords[j] << ",";
+            }
+            file << std::endl;
+            progress.row();
+        }
+        progress.finish();
+        file.close();
+    }
+    // without coordinates
+    else
+    {
+        // open file
+        std::ofstream file(_resultPath);
+        if (!file.is_open())
+        {
+            std::cout << "Saving error" << std::endl;
+            exit(1);
+        }
+        // save headers
+        file << "cluster_id,distance" << std::endl;
+
+        // save data
+        WriteProgress progress(_resultPath, _points.size(), file);
+        for (int i = 0; i < _points.size(); i++)
+        {
+            file << _points[i].cluster_id << "," << _points[i].distance << std::endl;
+            progress.row();
+        }
+        progress.finish();
+        file.close();
+    }
+}
+
+void save_centroids_to_txt(const std::string& _resultPath, const std::vector<Point>& _centroids)
+{
+    // open file
+    std::ofstream file(_resultPath);
+    if (!file.is_open())
+    {
+        std::cout << "Saving error" << std::endl;
+        exit(1);
+    }
+
+    // save headers
+    file << "cluster_id,distance,";
+    for (int i = 0; i < _centroids[0].coords.size(); i++)
+    {
+        file << "x" << i << ",";
+    }
+    file << std::endl;
+
+    // save data
+    for (int i = 0; i < _centroids.size(); i++)
+    {
+        file << _centroids[i].cluster_id << "," << _centroids[i].distance << ",";
+        for (int j = 0; j < _centroids[i].coords.size(); j++)
+        {
+            file << _centroids[i].coords[j] << ",";
+        }
+        file << std::endl;
+    }
+    file.close();
+}
+
+void save_result_to_npy(const std::string& _resultPath, const std::vector<Point>& _points, const std::vector<Point>& _centroids, bool _with_coordinates)
+{
+    // with coordinates
+    if (_with_coordinates)
+    {
+        // open file
+        npy::npy_data file = npy::read_npy<double>(_resultPath);
+        for (int i = 0; i < _centroids.size(); i++)
+        {
+            file.data[i * file.shape[1] + 0] = _centroids[i].cluster_id;
+            file.data[i * file.shape[1] + 1] = _centroids[i].distance;
+            for (int j = 0; j < _centroids[i].coords.size(); j++)
+            {
+                file.data[i * file.shape[1] + 2 + j] = _centroids[i].coords[j];
+            }
+        }
+        npy::write_npy(_resultPath, file);
+    }
+    // without coordinates
+    else
+    {
+        // open file
+        npy::npy_data file = npy::read_npy<double>(_resultPath);
+
+        // save data without headers
+        for (int i = 0; i < _centroids.size(); i++)
+        {
+            file.data[i * file.shape[1] + 0] = _centroids[i].cluster_id;
+            file.data[i * file.shape[1] + 1] = _centroids[i].distance;
+        }
+        npy::write_npy(_resultPath, file);
+    }
+}
+
+void save_centroids_to_npy(const std::string& _resultPath, const std::vector<Point>& _centroids)
+{
+    // open file
+    npy::npy_data file = npy::read_npy<double>(_resultPath);
+    // save data
+    for (int i = 0; i < _centroids.size(); i++)
+    {
+        file.data[i * file.shape[1] + 0] = _centroids[i].cluster_id;
+        file.data[i * file.shape[1] + 1] = _centroids[i].distance;
+        for (int j = 0; j < _centroids[i].coords.size(); j++)
+        {
+            file.data[i * file.shape[1] + j + 2] = _centroids[i].coords[j];
+        }
+    }
+    npy::write_npy(_resultPath, file);
+}
+void save_cluster_counts(const std::string& _resultPath, const std::vector<int>& _counts, const std::vector<Point>& _anchors)
+{
+    std::ofstream file(_resultPath);
+    if (!file.is_open())
+    {
+        std::cout << "Saving error" << std::endl;
+        exit(1);
+    }
+    bool withAnchors = !_anchors.empty() && _anchors.size() == _counts.size();
+    file << "cluster_id,count";
+    if (withAnchors)
+    {
+        for (int j = 0; j < _anchors[0].coords.size(); j++) { file << ",x" << j; }
+    }
+    file << std::endl;
+    file << std::setprecision(17);// anchors read back exactly, the drift is measured against them
+    for (int i = 0; i < _counts.size(); i++)
+    {
+        file << i << "," << _counts[i];
+        if (withAnchors)
+        {
+            for (double coord: _anchors[i].coords) { file << "," << coord; }
+        }
+        file << std::endl;
+    }
+    file.close();
+}
+
+void save_points(const std::string& _path, const std::vector<Point>& _points)
+{
+    std::string extension = _path.substr(_path.size() - 4);
+    size_t dim = _points.empty() ? 0 : _points[0].coords.size();
+    if (extension == ".npy")
+    {
+        npy::npy_data<double> matrix;
+        matrix.shape = {(unsigned long) _points.size(), (unsigned long) dim};
+        matrix.data.reserve(_points.size() * dim);
+        for (const Point& point: _points) { matrix.data.insert(matrix.data.end(), point.coords.begin(), point.coords.end()); }
+        npy::write_npy(_path, matrix);
+        return;
+    }
+    if (extension != ".csv" && extension != ".txt")
+    {
+        std::cout << "File type for points not supported" << std::endl;
+        std::cout << "Supported file types: csv, npy, txt" << std::endl;
+        exit(1);
+    }
+    std::ofstream file(_path);
+    if (!file.is_open())
+    {
+        std::cout << "Saving error" << std::endl;
+        exit(1);
+    }
+    // read_from_csv always skips the first line, read_from_txt only a "cluster_id" header
+    if (extension == ".csv")
+    {
+        if (dim == 2) { file << "x,y"; }
+        for (size_t i = 0; dim != 2 && i < dim; i++) { file << (i ? "," : "") << "x" << i; }
+        file << std::endl;
+    }
+    WriteProgress progress(_path, _points.size(), file);
+    for (const Point& point: _points)
+    {
+        for (size_t j = 0; j < point.coords.size(); j++) { file << (j ? "," : "") << point.coords[j]; }
+        file << std::endl;
+        progress.row();
+    }
+    progress.finish();
+    file.close();
+}
@@ -0,0 +1,30 @@
+#include "../clustering_core/modules/ReadData.hpp"
+#include "DatasetBundleBuilder.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+// usage: BuildDatasetBundle [comments csv] [rowClustered] [tsneClustered or "-"] [output]
+int main(int argc, char* argv[])
+{
+    std::string commentsPath = argc > 1 ? argv[1] : "../../data/big_data/the-reddit-climate-change-dataset-comments.csv";
+    std::string clustersPath = argc > 2 ? argv[2] : "../../data/big_data/rowClustered.csv";
+    std::string projectedPath = argc > 3 ? argv[3] : "../../data/big_data/tsneClustered.csv";
+    std::string outputPath = argc > 4 ? argv[4] : "../../data/big_data/dataset.bundle";
+
+    std::vector<CommentInfo> comments = read_comments_csv(commentsPath);
+    std::vector<Point> clustered = read_data(clustersPath);
+    std::vector<Point> projected;
+    if (projectedPath != "-") { projected = read_data(projectedPath); }
+    std::cout << "Read " << comments.size() << " comments, " << clustered.size() << " clustered and " << projected.size() << " projected rows"
+              << std::endl;
+
+    save_dataset_bundle(outputPath, comments, clustered, projected);
+
+    std::vector<char> buffer;
+    DatasetBundleView view;
+    load_dataset_bundle(outputPath, buffer, view);
+    std::cout << "Saved " << view.numRows() << " rows (" << buffer.size() << " bytes, " << view.textData().size() << " bytes of text) to "
+              << outputPath << std::endl;
+    return 0;
+}
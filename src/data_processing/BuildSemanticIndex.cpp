@@ -0,0 +1,53 @@
+#include "SemanticSearch.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// usage: BuildSemanticIndex [rowClustered] [rowCentroids] [embeddings] [index path] [num queries]
+int main(int argc, char* argv[])
+{
+    std::string clustersPath = argc > 1 ? argv[1] : "../../data/big_data/rowClustered.csv";
+    std::string centroidsPath = argc > 2 ? argv[2] : "../../data/big_data/rowCentroids.csv";
+    std::string embPath = argc > 3 ? argv[3] : "../../data/big_data/embeddings.npy";
+    std::string indexPath = argc > 4 ? argv[4] : "../../data/big_data/embeddings.sem";
+    int numQueries = argc > 5 ? std::stoi(argv[5]) : 200;
+    const int k = 10;
+
+    std::vector<Point> points = read_data(embPath);
+    std::cout << "Read " << points.size() << " points of dimension " << points[0].coords.size() << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    SemanticIndex index(points, readClusterIds_csv(clustersPath), readCentroids_from_csv(centroidsPath));
+    index.save(indexPath);
+    double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Built and saved index of " << index.numClusters() << " clusters in " << buildSeconds << " s to " << indexPath << std::endl;
+
+    // evenly spaced queries taken from the data set, exact answers from a full scan (nprobe = all clusters)
+    std::vector<int> queries;
+    numQueries = std::min<int>(numQueries, points.size());
+    for (int i = 0; i < numQueries; i++) { queries.push_back((int) ((size_t) i * points.size() / numQueries)); }
+    std::vector<std::vector<std::pair<int, double>>> expected;
+    for (int q: queries) { expected.push_back(index.search(points[q], k, index.numClusters())); }
+
+    std::cout << std::setw(8) << "nprobe" << std::setw(14) << "recall@10" << std::setw(14) << "ms/query" << std::endl;
+    for (int nprobe: {1, 2, 4, 8, 16, 32})
+    {
+        if (nprobe > index.numClusters()) { break; }
+        double recall = 0;
+        start = std::chrono::steady_clock::now();
+        for (size_t q = 0; q < queries.size(); q++)
+        {
+            int hits = 0;
+            for (const auto& found: index.search(points[queries[q]], k, nprobe))
+            {
+                for (const auto& exact: expected[q]) { hits += found.first == exact.first; }
+            }
+            recall += expected[q].empty() ? 1.0 : (double) hits / expected[q].size();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::setw(8) << nprobe << std::setw(14) << recall / queries.size() << std::setw(14) << 1000 * seconds / queries.size() << std::endl;
+    }
+    return 0;
+}
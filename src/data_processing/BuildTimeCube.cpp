@@ -0,0 +1,28 @@
+#include "ReduceClusterSizes.hpp"
+#include "TimeCubeBuilder.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+// usage: BuildTimeCube [comments csv] [rowClustered] [output]
+int main(int argc, char* argv[])
+{
+    std::string commentsPath = argc > 1 ? argv[1] : "../../data/big_data/the-reddit-climate-change-dataset-comments.csv";
+    std::string clustersPath = argc > 2 ? argv[2] : "../../data/big_data/rowClustered.csv";
+    std::string outputPath = argc > 3 ? argv[3] : "../../data/big_data/time_cube.bin";
+
+    std::vector<CommentInfo> comments = read_comments_csv(commentsPath);
+    std::vector<int> cluster_ids = readClusterIds_csv(clustersPath);
+    std::cout << "Read " << comments.size() << " comments and " << cluster_ids.size() << " cluster ids" << std::endl;
+
+    save_time_cube(outputPath, comments, cluster_ids);
+
+    std::vector<char> buffer;
+    TimeCubeView view;
+    load_time_cube(outputPath, buffer, view);
+    int year, month, day;
+    civilFromDays(view.firstDay(), year, month, day);
+    std::cout << "Saved " << view.numDays() << " days x " << view.numClusters() << " clusters from " << year << "-" << month << "-" << day
+              << " (" << buffer.size() << " bytes) to " << outputPath << std::endl;
+    return 0;
+}
@@ -0,0 +1,28 @@
+#include "ReduceClusterSizes.hpp"
+#include "TopCommentsBuilder.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+// usage: BuildTopComments [comments csv] [rowClustered] [rowCentroids] [embeddings] [output] [top N]
+int main(int argc, char* argv[])
+{
+    std::string commentsPath = argc > 1 ? argv[1] : "../../data/big_data/the-reddit-climate-change-dataset-comments.csv";
+    std::string clustersPath = argc > 2 ? argv[2] : "../../data/big_data/rowClustered.csv";
+    std::string centroidsPath = argc > 3 ? argv[3] : "../../data/big_data/rowCentroids.csv";
+    std::string embPath = argc > 4 ? argv[4] : "../../data/big_data/embeddings.npy";
+    std::string outputPath = argc > 5 ? argv[5] : "../../data/big_data/top_comments.bin";
+    int topN = argc > 6 ? std::stoi(argv[6]) : 50;
+
+    std::vector<CommentInfo> comments = read_comments_csv(commentsPath);
+    std::vector<Point> combined = combinePoints(read_data(embPath), readClusterIds_csv(clustersPath), readCentroids_from_csv(centroidsPath));
+    std::cout << "Read " << comments.size() << " comments and " << combined.size() << " clustered rows" << std::endl;
+
+    save_top_comments(outputPath, combined, comments, topN);
+
+    std::vector<char> buffer;
+    TopCommentsView view;
+    load_top_comments(outputPath, buffer, view);
+    std::cout << "Saved top " << view.topN() << " comments of " << view.numClusters() << " clusters (" << buffer.size() << " bytes) to " << outputPath << std::endl;
+    return 0;
+}
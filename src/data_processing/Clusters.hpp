@@ -17,6 +17,7 @@ public:
     Cluster(int id) : cluster_id(id), num_points(0) {}
     Cluster(int id, const Point& center) : cluster_id(id), center(center), num_points(0) {}
     Cluster(int id, const std::vector<Point>& points) : cluster_id(id), points(points), num_points(points.size()) {}
+    Cluster(int id, std::vector<Point>&& points) : cluster_id(id), points(std::move(points)), num_points(this->points.size()) {}
     Cluster(int id, const Point& center, const std::vector<Point>& points) : cluster_id(id), center(center), points(points), num_points(points.size()) {}
     Cluster(int id, const Point& center, const std::vector<Point>& points, int num_points) : cluster_id(id), center(center), points(points), num_points(num_points) {}
 
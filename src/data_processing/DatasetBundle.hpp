@@ -0,0 +1,186 @@
+// DatasetBundle.hpp
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/**
+ * Binary bundle of the data set the Qt app shows, written by BuildDatasetBundle and memory-mapped by the app.
+ *
+ * Layout (little endian, every section 8-byte aligned):
+ *   DatasetBundleHeader
+ *   DatasetBundleSection sections[numSections]     id, element size, offset and size of every section
+ *   section data                                   one column per section, numRows elements each
+ *
+ * Columns are found through the section table, so readers skip sections they do not know and a missing
+ * optional column (e.g. no t-SNE coordinates) is just absent. Texts are one UTF-8 arena addressed by a
+ * uint64 offsets table of numRows + 1 entries: text i is [offsets[i], offsets[i + 1]).
+ * The checksum covers everything after the header.
+ * This header only depends on the standard library so the Qt app can include it directly.
+ */
+enum DatasetBundleSectionId : uint32_t
+{
+    BUNDLE_UTC = 1,         // double, seconds since 1970-01-01 UTC
+    BUNDLE_SCORE = 2,       // float
+    BUNDLE_SENTIMENT = 3,   // float
+    BUNDLE_CLUSTER_ID = 4,  // int32, -1 when the row has no cluster
+    BUNDLE_DISTANCE = 5,    // float, distance to the cluster center
+    BUNDLE_X = 6,           // float, t-SNE projection
+    BUNDLE_Y = 7,           // float
+    BUNDLE_TEXT_OFFSETS = 8,// uint64, numRows + 1 entries
+    BUNDLE_TEXT_DATA = 9    // UTF-8 bytes
+};
+
+struct DatasetBundleHeader
+{
+    char magic[4];// "DSB1"
+    uint32_t version;
+    uint64_t numRows;
+    uint32_t numSections;
+    uint32_t reserved;
+    uint64_t checksum;
+};
+
+struct DatasetBundleSection
+{
+    uint32_t id;
+    uint32_t elementSize;// 1 for byte sections
+    uint64_t offset;     // from the start of the file
+    uint64_t size;       // in bytes
+};
+
+static_assert(sizeof(DatasetBundleHeader) == 32, "DatasetBundleHeader layout");
+static_assert(sizeof(DatasetBundleSection) == 24, "DatasetBundleSection layout");
+
+// FNV-1a over 64-bit words, the last partial word zero padded
+inline uint64_t bundleChecksum(const char* data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    if (i < size)
+    {
+        uint64_t word = 0;
+        std::memcpy(&word, data + i, size - i);
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * @class DatasetBundleView
+ * @brief Read-only view over a dataset bundle held in memory (a loaded file or a memory map).
+ */
+class DatasetBundleView
+{
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    DatasetBundleView() : _data(nullptr), _size(0), _header(nullptr), _textOffsets(nullptr), _textData(nullptr), _textSize(0) {}
+
+    /**
+     * Checks the header and the section table; returns false if the buffer is not a complete bundle.
+     * The checksum is not verified here, see verifyChecksum(). `data` must stay alive while the view is used.
+     */
+    bool open(const char* data, size_t size)
+    {
+        _data = nullptr;
+        _header = nullptr;
+        _textOffsets = nullptr;
+        _textData = nullptr;
+        _textSize = 0;
+        if (data == nullptr || size < sizeof(DatasetBundleHeader)) { return false; }
+        const DatasetBundleHeader* header = reinterpret_cast<const DatasetBundleHeader*>(data);
+        if (std::memcmp(header->magic, "DSB1", 4) != 0 || header->version != VERSION) { return false; }
+        if (header->numSections > (size - sizeof(DatasetBundleHeader)) / sizeof(DatasetBundleSection)) { return false; }
+
+        const DatasetBundleSection* sections = reinterpret_cast<const DatasetBundleSection*>(data + sizeof(DatasetBundleHeader));
+        for (uint32_t s = 0; s < header->numSections; s++)
+        {
+            const DatasetBundleSection& section = sections[s];
+            if (section.offset % 8 != 0 || section.offset > size || section.size > size - section.offset) { return false; }
+            if (section.elementSize == 0 || section.size % section.elementSize != 0) { return false; }
+            uint64_t expected = section.id == BUNDLE_TEXT_OFFSETS ? header->numRows + 1 : header->numRows;
+            if (section.id >= BUNDLE_UTC && section.id <= BUNDLE_TEXT_OFFSETS && section.size / section.elementSize != expected)
+            {
+                return false;
+            }
+        }
+        _data = data;
+        _size = size;
+        _header = header;
+
+        // the text offsets must be ascending and inside the arena, then text() needs no checks
+        const uint64_t* offsets = column<uint64_t>(BUNDLE_TEXT_OFFSETS);
+        const DatasetBundleSection* textData = section(BUNDLE_TEXT_DATA);
+        if (offsets && textData)
+        {
+            bool valid = offsets[0] == 0 && offsets[header->numRows] <= textData->size;
+            for (uint64_t i = 0; valid && i < header->numRows; i++) { valid = offsets[i] <= offsets[i + 1]; }
+            if (!valid)
+            {
+                _header = nullptr;
+                return false;
+            }
+            _textOffsets = offsets;
+            _textData = data + textData->offset;
+            _textSize = textData->size;
+        }
+        return true;
+    }
+
+    // full pass over the file, callers run it once after open()
+    bool verifyChecksum() const
+    {
+        if (!_header) { return false; }
+        return bundleChecksum(_data + sizeof(DatasetBundleHeader), _size - sizeof(DatasetBundleHeader)) == _header->checksum;
+    }
+
+    bool isOpen() const { return _header != nullptr; }
+    uint64_t numRows() const { return _header ? _header->numRows : 0; }
+    uint64_t checksum() const { return _header ? _header->checksum : 0; }
+
+    const DatasetBundleSection* section(DatasetBundleSectionId id) const
+    {
+        if (!_header) { return nullptr; }
+        const DatasetBundleSection* sections = reinterpret_cast<const DatasetBundleSection*>(_data + sizeof(DatasetBundleHeader));
+        for (uint32_t s = 0; s < _header->numSections; s++)
+        {
+            if (sections[s].id == id) { return &sections[s]; }
+        }
+        return nullptr;
+    }
+
+    // the column as an array, nullptr when the bundle has no such section or it holds another type
+    template <typename T>
+    const T* column(DatasetBundleSectionId id) const
+    {
+        const DatasetBundleSection* s = section(id);
+        if (!s || s->elementSize != sizeof(T)) { return nullptr; }
+        return reinterpret_cast<const T*>(_data + s->offset);
+    }
+
+    bool hasTexts() const { return _textOffsets != nullptr; }
+    const uint64_t* textOffsets() const { return _textOffsets; }
+    std::string_view textData() const { return std::string_view(_textData, _textSize); }
+
+    std::string_view text(uint64_t row) const
+    {
+        if (!_textOffsets || row >= _header->numRows) { return {}; }
+        return std::string_view(_textData + _textOffsets[row], _textOffsets[row + 1] - _textOffsets[row]);
+    }
+
+protected:
+    const char* _data;
+    size_t _size;
+    const DatasetBundleHeader* _header;
+    const uint64_t* _textOffsets;
+    const char* _textData;
+    uint64_t _textSize;
+};
@@ -0,0 +1,142 @@
+// DatasetBundleBuilder.hpp
+#pragma once
+#include "../clustering_core/modules/structPoint.hpp"
+#include "DatasetBundle.hpp"
+#include "TopCommentsBuilder.hpp"
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Writes the comments with their clustering results as a dataset bundle.
+ * `clustered[i]` carries the cluster_id and distance of row i (rowClustered.csv), `projected[i]` its t-SNE
+ * coordinates in coords[0..1] (tsneClustered.csv). `projected` may be empty, the bundle then has no x/y columns.
+ */
+void save_dataset_bundle(const std::string& path, const std::vector<CommentInfo>& comments, const std::vector<Point>& clustered,
+                         const std::vector<Point>& projected);
+
+/**
+ * Reads a whole bundle into `buffer` and opens `view` on it. Exits if the file is missing, not a bundle or corrupted.
+ */
+void load_dataset_bundle(const std::string& path, std::vector<char>& buffer, DatasetBundleView& view);
+
+// Implementations
+
+inline void save_dataset_bundle(const std::string& path, const std::vector<CommentInfo>& comments, const std::vector<Point>& clustered,
+                         const std::vector<Point>& projected)
+{
+    size_t rows = comments.size();
+    if (clustered.size() != rows || (!projected.empty() && projected.size() != rows))
+    {
+        std::cout << "Got " << rows << " comments, " << clustered.size() << " clustered rows and " << projected.size() << " projected rows"
+                  << std::endl;
+        exit(1);
+    }
+
+    std::vector<double> utc(rows);
+    std::vector<float> score(rows), sentiment(rows), distance(rows), x, y;
+    std::vector<int32_t> cluster_id(rows);
+    std::vector<uint64_t> textOffsets(rows + 1, 0);
+    std::string textData;
+    for (size_t i = 0; i < rows; i++)
+    {
+        utc[i] = comments[i].utc;
+        score[i] = (float) comments[i].score;
+        sentiment[i] = (float) comments[i].sentiment;
+        cluster_id[i] = clustered[i].cluster_id;
+        distance[i] = (float) clustered[i].distance;
+        textData += comments[i].text;
+        textOffsets[i + 1] = textData.size();
+    }
+    if (!projected.empty())
+    {
+        x.resize(rows);
+        y.resize(rows);
+        for (size_t i = 0; i < rows; i++)
+        {
+            if (projected[i].coords.size() < 2)
+            {
+                std::cout << "Projected row " << i << " has fewer than 2 coordinates" << std::endl;
+                exit(1);
+            }
+            x[i] = (float) projected[i].coords[0];
+            y[i] = (float) projected[i].coords[1];
+        }
+    }
+
+    struct Column
+    {
+        DatasetBundleSectionId id;
+        uint32_t elementSize;
+        const void* data;
+        uint64_t size;
+    };
+    std::vector<Column> columns = {
+        {BUNDLE_UTC, sizeof(double), utc.data(), rows * sizeof(double)},
+        {BUNDLE_SCORE, sizeof(float), score.data(), rows * sizeof(float)},
+        {BUNDLE_SENTIMENT, sizeof(float), sentiment.data(), rows * sizeof(float)},
+        {BUNDLE_CLUSTER_ID, sizeof(int32_t), cluster_id.data(), rows * sizeof(int32_t)},
+        {BUNDLE_DISTANCE, sizeof(float), distance.data(), rows * sizeof(float)},
+    };
+    if (!projected.empty())
+    {
+        columns.push_back({BUNDLE_X, sizeof(float), x.data(), rows * sizeof(float)});
+        columns.push_back({BUNDLE_Y, sizeof(float), y.data(), rows * sizeof(float)});
+    }
+    columns.push_back({BUNDLE_TEXT_OFFSETS, sizeof(uint64_t), textOffsets.data(), (rows + 1) * sizeof(uint64_t)});
+    columns.push_back({BUNDLE_TEXT_DATA, 1, textData.data(), textData.size()});
+
+    // everything after the header is assembled in memory, so the checksum is one pass before writing
+    std::vector<DatasetBundleSection> sections(columns.size());
+    uint64_t offset = sizeof(DatasetBundleHeader) + sections.size() * sizeof(DatasetBundleSection);
+    for (size_t s = 0; s < columns.size(); s++)
+    {
+        offset = (offset + 7) / 8 * 8;
+        sections[s] = DatasetBundleSection{columns[s].id, columns[s].elementSize, offset, columns[s].size};
+        offset += columns[s].size;
+    }
+    std::vector<char> body(offset - sizeof(DatasetBundleHeader), 0);
+    std::memcpy(body.data(), sections.data(), sections.size() * sizeof(DatasetBundleSection));
+    for (size_t s = 0; s < columns.size(); s++)
+    {
+        if (columns[s].size > 0) { std::memcpy(body.data() + sections[s].offset - sizeof(DatasetBundleHeader), columns[s].data, columns[s].size); }
+    }
+
+    DatasetBundleHeader header = {};
+    std::memcpy(header.magic, "DSB1", 4);
+    header.version = DatasetBundleView::VERSION;
+    header.numRows = rows;
+    header.numSections = (uint32_t) sections.size();
+    header.checksum = bundleChecksum(body.data(), body.size());
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Saving error" << std::endl;
+        exit(1);
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(body.data(), body.size());
+}
+
+inline void load_dataset_bundle(const std::string& path, std::vector<char>& buffer, DatasetBundleView& view)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Error opening file: " << path << std::endl;
+        exit(1);
+    }
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (!view.open(buffer.data(), buffer.size()))
+    {
+        std::cout << "File " << path << " is not a dataset bundle" << std::endl;
+        exit(1);
+    }
+    if (!view.verifyChecksum())
+    {
+        std::cout << "File " << path << " is corrupted (checksum mismatch)" << std::endl;
+        exit(1);
+    }
+}
@@ -0,0 +1,271 @@
+// ProductQuantizer.hpp
+#pragma once
+#include "../clustering_core/KmeansND.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Compact storage for product-quantized vectors.
+ *
+ * Every vector is stored as `codeSize` consecutive bytes, one centroid index per subspace.
+ */
+struct PQCodes
+{
+    int codeSize = 0;
+    std::vector<uint8_t> codes;
+
+    size_t size() const { return codeSize == 0 ? 0 : codes.size() / codeSize; }
+    const uint8_t* operator[](size_t i) const { return codes.data() + i * codeSize; }
+};
+
+/**
+ * @class ProductQuantizer
+ * @brief Compresses N-dimensional points into a few bytes each.
+ *
+ * The space is split into `numSubspaces` contiguous sub-vectors, every subspace gets its own
+ * codebook trained with KMeansND, and a point is encoded as the index of the nearest codebook
+ * centroid in each subspace. Distances from an uncompressed query to encoded points are
+ * computed asymmetrically through a per-query lookup table (see `distanceTable`).
+ */
+class ProductQuantizer
+{
+public:
+    ProductQuantizer(int dimension, int numSubspaces, int numCentroids = 256, int maxIter = 25)
+        : _dimension(dimension), _numSubspaces(numSubspaces), _numCentroids(numCentroids), _maxIter(maxIter), _trainSampleSize(0)
+    {
+        if (numSubspaces <= 0 || numSubspaces > dimension)
+        {
+            std::cout << "Number of subspaces must be in [1, " << dimension << "], got " << numSubspaces << std::endl;
+            exit(1);
+        }
+        if (numCentroids <= 0 || numCentroids > 256)
+        {
+            std::cout << "Number of centroids per subspace must be in [1, 256], got " << numCentroids << std::endl;
+            exit(1);
+        }
+        // spread the remainder over the first subspaces when dimension is not divisible
+        _offsets.resize(numSubspaces + 1, 0);
+        for (int m = 0; m < numSubspaces; m++)
+        {
+            _offsets[m + 1] = _offsets[m] + dimension / numSubspaces + (m < dimension % numSubspaces ? 1 : 0);
+        }
+    }
+    ProductQuantizer() : ProductQuantizer(1, 1, 1, 1) {}
+
+    void train(const std::vector<Point>& points);
+    std::vector<uint8_t> encode(const Point& point) const;
+    PQCodes encodeAll(const std::vector<Point>& points) const;
+    Point decode(const uint8_t* code) const;
+
+    std::vector<double> distanceTable(const Point& query) const;
+    double asymmetricDistance(const std::vector<double>& table, const uint8_t* code) const;
+    std::vector<std::pair<int, double>> search(const Point& query, const PQCodes& codes, int k) const;
+
+    void save(const std::string& path) const;
+    void load(const std::string& path);
+
+    // train on this many evenly spaced points only, 0 means use all points
+    void setTrainSampleSize(int trainSampleSize) { _trainSampleSize = trainSampleSize; }
+
+    int getDimension() const { return _dimension; }
+    int getNumSubspaces() const { return _numSubspaces; }
+    int getNumCentroids() const { return _numCentroids; }
+    int getCodeSize() const { return _numSubspaces; }
+    bool isTrained() const { return !_codebooks.empty(); }
+
+protected:
+    int _dimension;
+    int _numSubspaces;
+    int _numCentroids;
+    int _maxIter;
+    int _trainSampleSize;
+
+    std::vector<int> _offsets;     ///< first coordinate of every subspace, size numSubspaces + 1
+    std::vector<double> _codebooks;///< centroid c of subspace m starts at numCentroids * _offsets[m] + c * subDim(m)
+
+    int subDim(int m) const { return _offsets[m + 1] - _offsets[m]; }
+    const double* codeword(int m, int c) const { return _codebooks.data() + _numCentroids * _offsets[m] + c * subDim(m); }
+    int nearestCodeword(int m, const Point& point) const;
+};
+
+inline void ProductQuantizer::train(const std::vector<Point>& points)
+{
+    if (points.empty())
+    {
+        std::cout << "Product quantizer can not be trained without points" << std::endl;
+        exit(1);
+    }
+    // exactly `count` points, spread evenly over the input
+    size_t count = (_trainSampleSize > 0 && points.size() > (size_t) _trainSampleSize) ? (size_t) _trainSampleSize : points.size();
+    std::vector<Point> sample;
+    sample.reserve(count);
+    for (size_t i = 0; i < count; i++) { sample.push_back(points[i * points.size() / count]); }
+
+    // a codebook can not have more entries than there are training points
+    _numCentroids = std::min<int>(_numCentroids, sample.size());
+    _codebooks.assign((size_t) _numCentroids * _dimension, 0.0);
+
+    for (int m = 0; m < _numSubspaces; m++)
+    {
+        std::vector<Point> subPoints;
+        subPoints.reserve(sample.size());
+        for (const auto& point: sample)
+        {
+            subPoints.push_back(Point(std::vector<double>(point.coords.begin() + _offsets[m], point.coords.begin() + _offsets[m + 1])));
+        }
+
+        KMeansND kmeans(_numCentroids, _maxIter, subPoints);
+        kmeans.Cluster(false);
+        std::vector<Point> centroids = kmeans.getCentroids();
+
+        double* book = _codebooks.data() + _numCentroids * _offsets[m];
+        for (int c = 0; c < _numCentroids; c++)
+        {
+            std::copy(centroids[c].coords.begin(), centroids[c].coords.end(), book + c * subDim(m));
+        }
+    }
+}
+
+inline int ProductQuantizer::nearestCodeword(int m, const Point& point) const
+{
+    int best = 0;
+    double bestDist = __DBL_MAX__;
+    const double* sub = point.coords.data() + _offsets[m];
+    for (int c = 0; c < _numCentroids; c++)
+    {
+        const double* word = codeword(m, c);
+        double dist = 0;
+        for (int j = 0; j < subDim(m); j++) { dist += (sub[j] - word[j]) * (sub[j] - word[j]); }
+        if (dist < bestDist)
+        {
+            bestDist = dist;
+            best = c;
+        }
+    }
+    return best;
+}
+
+inline std::vector<uint8_t> ProductQuantizer::encode(const Point& point) const
+{
+    std::vector<uint8_t> code(_numSubspaces);
+    for (int m = 0; m < _numSubspaces; m++) { code[m] = (uint8_t) nearestCodeword(m, point); }
+    return code;
+}
+
+inline PQCodes ProductQuantizer::encodeAll(const std::vector<Point>& points) const
+{
+    PQCodes result;
+    result.codeSize = _numSubspaces;
+    result.codes.resize(points.size() * _numSubspaces);
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        for (int m = 0; m < _numSubspaces; m++) { result.codes[i * _numSubspaces + m] = (uint8_t) nearestCodeword(m, points[i]); }
+    }
+    return result;
+}
+
+inline Point ProductQuantizer::decode(const uint8_t* code) const
+{
+    std::vector<double> coords(_dimension);
+    for (int m = 0; m < _numSubspaces; m++)
+    {
+        std::copy(codeword(m, code[m]), codeword(m, code[m]) + subDim(m), coords.begin() + _offsets[m]);
+    }
+    return Point(coords);
+}
+
+/**
+ * Squared distances from every query sub-vector to every codeword, laid out as [subspace][centroid].
+ * Computed once per query, after which the distance to any encoded point costs numSubspaces lookups.
+ */
+inline std::vector<double> ProductQuantizer::distanceTable(const Point& query) const
+{
+    std::vector<double> table((size_t) _numSubspaces * _numCentroids);
+    for (int m = 0; m < _numSubspaces; m++)
+    {
+        const double* sub = query.coords.data() + _offsets[m];
+        for (int c = 0; c < _numCentroids; c++)
+        {
+            const double* word = codeword(m, c);
+            double dist = 0;
+            for (int j = 0; j < subDim(m); j++) { dist += (sub[j] - word[j]) * (sub[j] - word[j]); }
+            table[m * _numCentroids + c] = dist;
+        }
+    }
+    return table;
+}
+
+inline double ProductQuantizer::asymmetricDistance(const std::vector<double>& table, const uint8_t* code) const
+{
+    double sum = 0;
+    for (int m = 0; m < _numSubspaces; m++) { sum += table[m * _numCentroids + code[m]]; }
+    return sqrt(sum);
+}
+
+inline std::vector<std::pair<int, double>> ProductQuantizer::search(const Point& query, const PQCodes& codes, int k) const
+{
+    std::vector<double> table = distanceTable(query);
+    std::vector<std::pair<int, double>> result(codes.size());
+    for (size_t i = 0; i < codes.size(); i++) { result[i] = {(int) i, asymmetricDistance(table, codes[i])}; }
+
+    k = std::min<int>(k, result.size());
+    std::partial_sort(result.begin(), result.begin() + k, result.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
+    result.resize(k);
+    return result;
+}
+
+inline void ProductQuantizer::save(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Saving error" << std::endl;
+        exit(1);
+    }
+    int32_t header[4] = {_dimension, _numSubspaces, _numCentroids, _maxIter};
+    file.write("PQ01", 4);
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(_offsets.data()), _offsets.size() * sizeof(int32_t));
+    file.write(reinterpret_cast<const char*>(_codebooks.data()), _codebooks.size() * sizeof(double));
+}
+
+inline void ProductQuantizer::load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[4];
+    if (!file.is_open() || !file.read(magic, 4) || std::string(magic, 4) != "PQ01")
+    {
+        std::cout << "File " << path << " is not a product quantizer codebook" << std::endl;
+        exit(1);
+    }
+    // every section is checked before its sizes are used, a truncated or foreign file stops here
+    int32_t header[4];
+    bool valid = (bool) file.read(reinterpret_cast<char*>(header), sizeof(header));
+    valid = valid && header[0] > 0 && header[1] > 0 && header[1] <= header[0] && header[2] > 0 && header[2] <= 256;
+    if (valid)
+    {
+        _offsets.resize(header[1] + 1);
+        valid = (bool) file.read(reinterpret_cast<char*>(_offsets.data()), _offsets.size() * sizeof(int32_t));
+        valid = valid && _offsets[0] == 0 && _offsets[header[1]] == header[0];
+        for (int m = 0; valid && m < header[1]; m++) { valid = _offsets[m] < _offsets[m + 1]; }
+    }
+    if (valid)
+    {
+        _codebooks.resize((size_t) header[2] * header[0]);
+        valid = (bool) file.read(reinterpret_cast<char*>(_codebooks.data()), _codebooks.size() * sizeof(double));
+    }
+    if (!valid)
+    {
+        std::cout << "File " << path << " is truncated or not a product quantizer codebook" << std::endl;
+        exit(1);
+    }
+    _dimension = header[0];
+    _numSubspaces = header[1];
+    _numCentroids = header[2];
+    _maxIter = header[3];
+}
@@ -2,6 +2,7 @@
 #include "../clustering_core/KmeansND.hpp"
 #include "Clusters.hpp"
 #include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <iterator>
@@ -9,16 +10,17 @@
 #include <string>
 #include <vector>
 
-std::vector<Point> combinePoints(const std::vector<Point>& points, const std::vector<int>& cluster_ids, const std::vector<Point>& cluster_centers)
+// sets cluster_id and distance in place: pass std::move(points) (or a temporary) to avoid a copy of the embeddings
+std::vector<Point> combinePoints(std::vector<Point> points, const std::vector<int>& cluster_ids, const std::vector<Point>& cluster_centers)
 {
-    std::vector<Point> combined_points(points.size());
+    Progress progress("combining points", points.size());
     for (size_t i = 0; i < points.size(); ++i)
     {
-        combined_points[i] = points[i];
-        combined_points[i].cluster_id = cluster_ids[i];
-        combined_points[i].distance = combined_points[i].calcDist(cluster_centers[cluster_ids[i]]);
+        progress.add(1, points[i].coords.size() * sizeof(double));
+        points[i].cluster_id = cluster_ids[i];
+        points[i].distance = points[i].calcDist(cluster_centers[cluster_ids[i]]);
     }
-    return combined_points;
+    return points;
 }
 
 std::vector<Point> readCentroids_from_csv(const std::string& filename)
@@ -68,9 +70,13 @@ std::vector<int> readClusterIds_csv(const std::string& filename)
         std::cerr << "Error opening file: " << filename << std::endl;
         return cluster_ids;
     }
+    std::error_code error;
+    size_t size = std::filesystem::file_size(filename, error);
+    Progress progress("reading " + std::filesystem::path(filename).filename().string(), 0, error ? 0 : size);
     std::string line;
     while (std::getline(file, line))
     {
+        progress.add(1, line.size() + 1);
         std::istringstream iss(line);
         std::string value;
         int cluster_id;
@@ -81,19 +87,26 @@ std::vector<int> readClusterIds_csv(const std::string& filename)
     return cluster_ids;
 }
 
+/**
+ * Groups the embeddings by cluster. The embeddings are read once (in chunks if the memory budget requires it,
+ * see read_from_npy) and then moved from stage to stage, so the peak stays at one copy of them.
+ */
 std::vector<Cluster> ReduceClusterSize(const std::string& pathToClusters, const std::string& pathToCentroids, const std::string& pathEmbeddings)
 {
+    MemoryStage stage("ReduceClusterSize");
     std::vector<Point> centroids = readCentroids_from_csv(pathToCentroids);// shape: (num_clusters, num_features)
     std::vector<int> cluster_id = readClusterIds_csv(pathToClusters);      // shape: (num_points,)
+    MemoryReservation labelsMemory("cluster ids", cluster_id.capacity() * sizeof(int), false);
     std::vector<Point> rowPoints = read_data(pathEmbeddings);              // shape: (num_points, num_features)
+    size_t dim = rowPoints.empty() ? 0 : rowPoints[0].coords.size();
+    MemoryReservation pointsMemory("embeddings", pointsBytes(rowPoints.size(), dim), false);
 
-    std::vector<Point> combined_points = combinePoints(rowPoints, cluster_id, centroids);
+    std::vector<Point> combined_points = combinePoints(std::move(rowPoints), cluster_id, centroids);
+    // the partitions take over the coordinates, only their Point objects are new until combined_points is gone
+    MemoryReservation partitionsMemory("cluster partitions", combined_points.size() * sizeof(Point), false);
+    std::vector<std::vector<Point>> clusters_points = returnClusters(std::move(combined_points), centroids);
     std::vector<Cluster> clusters;
-    std::vector<std::vector<Point>> clusters_points = returnClusters(combined_points, centroids);
-    for (size_t i = 0; i < clusters_points.size(); ++i)
-    {
-        Cluster c(i, clusters_points[i]);
-        clusters.push_back(c);
-    }
+    clusters.reserve(clusters_points.size());
+    for (size_t i = 0; i < clusters_points.size(); ++i) { clusters.push_back(Cluster(i, std::move(clusters_points[i]))); }
     return clusters;
 }
\ No newline at end of file
@@ -0,0 +1,282 @@
+// SemanticSearch.hpp
+#pragma once
+#include "../assign_core/CentroidAssigner.hpp"
+#include "ReduceClusterSizes.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+// largest cluster id a loaded index may have, the id -> slot lookup has one entry per id
+const int SEMANTIC_MAX_CLUSTER_ID = 1 << 24;
+
+/**
+ * @class SemanticIndex
+ * @brief Nearest-comment lookup that only scans the clusters closest to the query.
+ *
+ * The embeddings are regrouped by cluster into one contiguous float block per cluster (inverted file layout).
+ * A query first ranks the centroids with CentroidMatrix, then computes exact distances only for the rows of
+ * the `nprobe` nearest clusters, so the cost is about nprobe / k of a linear scan.
+ */
+class SemanticIndex
+{
+public:
+    SemanticIndex() : _dim(0) {}
+    // embeddings[i] belongs to cluster cluster_ids[i], centroids are KMeansND output (cluster_id set per centroid)
+    SemanticIndex(const std::vector<Point>& embeddings, const std::vector<int>& cluster_ids, const std::vector<Point>& centroids);
+
+    // same inputs as ReduceClusterSize: rowClustered.csv, rowCentroids.csv and the embeddings file
+    static SemanticIndex fromFiles(const std::string& pathToClusters, const std::string& pathToCentroids, const std::string& pathEmbeddings);
+
+    /**
+     * Returns up to k (row, distance) pairs sorted by distance, where row is the index of the embedding
+     * in the original file. Only the nprobe nearest clusters are scanned.
+     */
+    std::vector<std::pair<int, double>> search(const Point& query, int k, int nprobe) const;
+
+    void save(const std::string& path) const;
+    // exits with a message if the file is missing, damaged or does not fit in the memory budget
+    void load(const std::string& path);
+    /**
+     * Same as load, but returns false instead of exiting, e.g. for the GUI. The header, the size of every
+     * section against the file size, the cluster ids, the offsets and the row ids are checked before the
+     * index is replaced; on failure the index is unchanged and `error`, if given, says why.
+     */
+    bool tryLoad(const std::string& path, std::string* error = nullptr);
+
+    size_t size() const { return _rowIds.size(); }
+    int dimension() const { return _dim; }
+    int numClusters() const { return (int) _centroids.size(); }
+    // number of rows stored for the cluster at position `slot` of the centroid list
+    size_t clusterSize(int slot) const { return _offsets[slot + 1] - _offsets[slot]; }
+
+protected:
+    int _dim;
+    std::vector<Point> _centroids;
+    CentroidMatrix _matrix;
+    std::vector<int> _slotOf;     // cluster_id -> position in _centroids
+    std::vector<size_t> _offsets; // rows of slot s are [_offsets[s], _offsets[s + 1])
+    std::vector<int> _rowIds;     // original row of every stored embedding
+    std::vector<float> _data;     // row-major, _dim floats per stored embedding
+    MemoryReservation _memory;    // _rowIds and _data against the memory budget
+
+    void buildLookup();
+};
+
+// Implementations of SemanticIndex methods
+
+inline SemanticIndex::SemanticIndex(const std::vector<Point>& embeddings, const std::vector<int>& cluster_ids, const std::vector<Point>& centroids)
+    : _dim(centroids.empty() ? 0 : centroids[0].coords.size()), _centroids(centroids)
+{
+    if (embeddings.size() != cluster_ids.size())
+    {
+        std::cout << "Got " << embeddings.size() << " embeddings but " << cluster_ids.size() << " cluster ids" << std::endl;
+        exit(1);
+    }
+    buildLookup();
+
+    // counting sort of the rows by cluster
+    _offsets.assign(_centroids.size() + 1, 0);
+    for (int id : cluster_ids) { _offsets[_slotOf.at(id) + 1]++; }
+    for (size_t s = 0; s < _centroids.size(); s++) { _offsets[s + 1] += _offsets[s]; }
+
+    std::vector<size_t> next(_offsets.begin(), _offsets.end() - 1);
+    _memory = MemoryReservation("the semantic index", embeddings.size() * (sizeof(int) + _dim * sizeof(float)));
+    _rowIds.resize(embeddings.size());
+    _data.resize(embeddings.size() * _dim);
+    for (size_t i = 0; i < embeddings.size(); i++)
+    {
+        size_t position = next[_slotOf[cluster_ids[i]]]++;
+        _rowIds[position] = (int) i;
+        std::copy(embeddings[i].coords.begin(), embeddings[i].coords.end(), _data.begin() + position * _dim);
+    }
+}
+
+inline SemanticIndex SemanticIndex::fromFiles(const std::string& pathToClusters, const std::string& pathToCentroids, const std::string& pathEmbeddings)
+{
+    std::vector<Point> centroids = readCentroids_from_csv(pathToCentroids);
+    std::vector<int> cluster_ids = readClusterIds_csv(pathToClusters);
+    std::vector<Point> embeddings = read_data(pathEmbeddings);
+    return SemanticIndex(embeddings, cluster_ids, centroids);
+}
+
+inline void SemanticIndex::buildLookup()
+{
+    _matrix = CentroidMatrix(_centroids);
+    int maxId = -1;
+    for (const Point& c : _centroids) { maxId = std::max(maxId, c.cluster_id); }
+    _slotOf.assign(maxId + 1, -1);
+    for (size_t s = 0; s < _centroids.size(); s++)
+    {
+        if (_centroids[s].cluster_id < 0)
+        {
+            std::cout << "Centroid " << s << " has no cluster id" << std::endl;
+            exit(1);
+        }
+        _slotOf[_centroids[s].cluster_id] = (int) s;
+    }
+}
+
+inline std::vector<std::pair<int, double>> SemanticIndex::search(const Point& query, int k, int nprobe) const
+{
+    std::vector<std::pair<int, double>> result;
+    if (_centroids.empty() || k <= 0) { return result; }
+    if ((int) query.coords.size() != _dim)
+    {
+        std::cout << "Query has dimension " << query.coords.size() << ", index has " << _dim << std::endl;
+        exit(1);
+    }
+
+    ScratchArena arena;
+    ScratchVector<float> q(query.coords.begin(), query.coords.end(), arena.resource());
+    // max-heap of the k best (squared distance, row) seen so far
+    ScratchVector<std::pair<float, int>> heap(arena.resource());
+    heap.reserve(k + 1);
+    std::priority_queue<std::pair<float, int>, ScratchVector<std::pair<float, int>>> best(std::less<std::pair<float, int>>(), std::move(heap));
+    for (const auto& probe : _matrix.assign(query, nprobe).nearest)
+    {
+        int slot = _slotOf[probe.first];
+        for (size_t r = _offsets[slot]; r < _offsets[slot + 1]; r++)
+        {
+            const float* row = _data.data() + r * _dim;
+            float d = 0;
+            for (int j = 0; j < _dim; j++) { d += (row[j] - q[j]) * (row[j] - q[j]); }
+            if ((int) best.size() < k) { best.push({d, _rowIds[r]}); }
+            else if (d < best.top().first)
+            {
+                best.pop();
+                best.push({d, _rowIds[r]});
+            }
+        }
+    }
+
+    result.resize(best.size());
+    for (size_t i = result.size(); i-- > 0; best.pop()) { result[i] = {best.top().second, sqrt(best.top().first)}; }
+    return result;
+}
+
+// Layout: "SEM1", dim, number of clusters, number of rows (int64), centroid ids and coordinates (double),
+// offsets (int64), row ids (int32), embeddings (float).
+inline void SemanticIndex::save(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Saving error" << std::endl;
+        exit(1);
+    }
+    int32_t header[2] = {_dim, (int32_t) _centroids.size()};
+    int64_t rows = _rowIds.size();
+    file.write("SEM1", 4);
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+    for (const Point& c : _centroids)
+    {
+        int32_t id = c.cluster_id;
+        file.write(reinterpret_cast<const char*>(&id), sizeof(id));
+        file.write(reinterpret_cast<const char*>(c.coords.data()), _dim * sizeof(double));
+    }
+    std::vector<int64_t> offsets(_offsets.begin(), _offsets.end());
+    file.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(int64_t));
+    file.write(reinterpret_cast<const char*>(_rowIds.data()), _rowIds.size() * sizeof(int32_t));
+    file.write(reinterpret_cast<const char*>(_data.data()), _data.size() * sizeof(float));
+}
+
+inline void SemanticIndex::load(const std::string& path)
+{
+    std::string error;
+    if (!tryLoad(path, &error))
+    {
+        std::cout << error << std::endl;
+        exit(1);
+    }
+}
+
+inline bool SemanticIndex::tryLoad(const std::string& path, std::string* error)
+{
+    auto fail = [&](const std::string& message) {
+        if (error) { *error = message; }
+        return false;
+    };
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) { return fail("File " + path + " not found"); }
+    uint64_t remaining = (uint64_t) file.tellg();
+    file.seekg(0);
+
+    char magic[4] = {};
+    int32_t header[2] = {};
+    int64_t rows = 0;
+    file.read(magic, 4);
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    file.read(reinterpret_cast<char*>(&rows), sizeof(rows));
+    if (!file || std::memcmp(magic, "SEM1", 4) != 0 || header[0] < 0 || header[1] < 0 || rows < 0 || rows > INT32_MAX ||
+        (header[1] > 0 && header[0] == 0))
+    {
+        return fail("File " + path + " is not a semantic index");
+    }
+    remaining -= 4 + sizeof(header) + sizeof(rows);
+
+    // every section must fit in what is left of the file, and together they must fill it exactly
+    uint64_t dim = header[0], clusters = header[1];
+    auto take = [&](uint64_t count, uint64_t size) {
+        if (size > 0 && count > remaining / size) { return false; }
+        remaining -= count * size;
+        return true;
+    };
+    if (!take(clusters, sizeof(int32_t) + dim * sizeof(double)) || !take(clusters + 1, sizeof(int64_t)) || !take(rows, sizeof(int32_t)) ||
+        !take(rows, dim * sizeof(float)) || remaining != 0)
+    {
+        return fail("File " + path + " is truncated or has the wrong size");
+    }
+    size_t bytes = (size_t) rows * (sizeof(int) + dim * sizeof(float));
+    if (!MemoryBudget::fits(bytes))
+    {
+        return fail("The semantic index " + path + " (" + std::to_string(bytes >> 20) + " MB) does not fit in the memory budget");
+    }
+
+    SemanticIndex index;
+    index._dim = (int) dim;
+    index._centroids.assign(clusters, Point());
+    std::vector<int> ids(clusters);
+    for (size_t s = 0; s < clusters; s++)
+    {
+        Point& c = index._centroids[s];
+        c.coords.resize(dim);
+        file.read(reinterpret_cast<char*>(&ids[s]), sizeof(int32_t));
+        file.read(reinterpret_cast<char*>(c.coords.data()), dim * sizeof(double));
+        c.cluster_id = ids[s];
+    }
+    // ids size the id -> slot lookup, so they are bounded, and each must name one slot
+    std::sort(ids.begin(), ids.end());
+    if (!ids.empty() && (ids.front() < 0 || ids.back() >= SEMANTIC_MAX_CLUSTER_ID || std::adjacent_find(ids.begin(), ids.end()) != ids.end()))
+    {
+        return fail("File " + path + " has invalid cluster ids");
+    }
+    std::vector<int64_t> offsets(clusters + 1);
+    file.read(reinterpret_cast<char*>(offsets.data()), offsets.size() * sizeof(int64_t));
+    for (size_t s = 0; s < clusters; s++)
+    {
+        if (offsets[s] > offsets[s + 1]) { return fail("File " + path + " has invalid offsets"); }
+    }
+    if (offsets[0] != 0 || offsets[clusters] != rows) { return fail("File " + path + " has invalid offsets"); }
+    index._offsets.assign(offsets.begin(), offsets.end());
+
+    index._memory = MemoryReservation("the semantic index " + path, bytes, false);
+    index._rowIds.resize(rows);
+    file.read(reinterpret_cast<char*>(index._rowIds.data()), rows * sizeof(int32_t));
+    index._data.resize(rows * dim);
+    file.read(reinterpret_cast<char*>(index._data.data()), index._data.size() * sizeof(float));
+    if (!file) { return fail("File " + path + " could not be read"); }
+    for (int row : index._rowIds)
+    {
+        if (row < 0) { return fail("File " + path + " has invalid row ids"); }
+    }
+    index.buildLookup();
+    *this = std::move(index);
+    return true;
+}
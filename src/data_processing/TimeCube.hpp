@@ -0,0 +1,146 @@
+// TimeCube.hpp
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * Time x cluster aggregate of the comments, written by BuildTimeCube and read by the Qt year window.
+ *
+ * Layout (little endian):
+ *   TimeCubeHeader
+ *   TimeCubeCell prefix[numDays + 1][numClusters]
+ *
+ * prefix[d][c] holds the totals of cluster c over the days [firstDay, firstDay + d), so the totals of any
+ * day range, and therefore of any day, month or year, are one subtraction per cluster.
+ * Days are counted from 1970-01-01 (UTC). Standard library only, so the Qt app includes it directly.
+ */
+struct TimeCubeHeader
+{
+    char magic[4];// "TCUB"
+    int32_t version;
+    int32_t numClusters;
+    int32_t firstDay;
+    int32_t numDays;
+    int32_t reserved;
+};
+
+struct TimeCubeCell
+{
+    int64_t count;
+    double scoreSum;
+    double sentimentSum;
+};
+
+static_assert(sizeof(TimeCubeHeader) == 24, "TimeCubeHeader layout");
+static_assert(sizeof(TimeCubeCell) == 24, "TimeCubeCell layout");
+
+// days since 1970-01-01 of a proleptic Gregorian date (month 1..12)
+inline int daysFromCivil(int year, int month, int day)
+{
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+// inverse of daysFromCivil
+inline void civilFromDays(int days, int& year, int& month, int& day)
+{
+    days += 719468;
+    int era = (days >= 0 ? days : days - 146096) / 146097;
+    int dayOfEra = days - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int mp = (5 * dayOfYear + 2) / 153;
+    day = dayOfYear - (153 * mp + 2) / 5 + 1;
+    month = mp + (mp < 10 ? 3 : -9);
+    year = yearOfEra + era * 400 + (month <= 2);
+}
+
+/**
+ * @class TimeCubeView
+ * @brief Read-only view over a time cube held in memory (a loaded file or a memory map).
+ */
+class TimeCubeView
+{
+public:
+    static constexpr int32_t VERSION = 1;
+
+    TimeCubeView() : _header(nullptr), _prefix(nullptr) {}
+
+    // returns false if the buffer is not a complete cube; `data` must stay alive while the view is used
+    bool open(const char* data, size_t size)
+    {
+        _header = nullptr;
+        _prefix = nullptr;
+        if (data == nullptr || size < sizeof(TimeCubeHeader)) { return false; }
+        const TimeCubeHeader* header = reinterpret_cast<const TimeCubeHeader*>(data);
+        if (std::memcmp(header->magic, "TCUB", 4) != 0 || header->version != VERSION || header->numClusters < 0 || header->numDays < 0)
+        {
+            return false;
+        }
+        if (sizeof(TimeCubeHeader) + ((size_t) header->numDays + 1) * header->numClusters * sizeof(TimeCubeCell) > size) { return false; }
+        _header = header;
+        _prefix = reinterpret_cast<const TimeCubeCell*>(data + sizeof(TimeCubeHeader));
+        return true;
+    }
+
+    bool isOpen() const { return _header != nullptr; }
+    int numClusters() const { return _header ? _header->numClusters : 0; }
+    int firstDay() const { return _header ? _header->firstDay : 0; }
+    int numDays() const { return _header ? _header->numDays : 0; }
+
+    static int yearStart(int year) { return daysFromCivil(year, 1, 1); }
+    static int monthStart(int year, int month) { return month > 12 ? daysFromCivil(year + 1, 1, 1) : daysFromCivil(year, month, 1); }
+
+    // totals of one cluster over the days [fromDay, toDay), days outside the cube count as empty
+    TimeCubeCell total(int fromDay, int toDay, int cluster) const
+    {
+        TimeCubeCell result = {0, 0.0, 0.0};
+        if (!_header || cluster < 0 || cluster >= _header->numClusters) { return result; }
+        int from = clampDay(fromDay), to = clampDay(toDay);
+        if (to <= from) { return result; }
+        const TimeCubeCell& a = _prefix[(size_t) from * _header->numClusters + cluster];
+        const TimeCubeCell& b = _prefix[(size_t) to * _header->numClusters + cluster];
+        result.count = b.count - a.count;
+        result.scoreSum = b.scoreSum - a.scoreSum;
+        result.sentimentSum = b.sentimentSum - a.sentimentSum;
+        return result;
+    }
+
+    // totals of every cluster over the days [fromDay, toDay)
+    std::vector<TimeCubeCell> totals(int fromDay, int toDay) const
+    {
+        std::vector<TimeCubeCell> result(numClusters());
+        for (int c = 0; c < numClusters(); c++) { result[c] = total(fromDay, toDay, c); }
+        return result;
+    }
+
+    // the k clusters with the most comments over [fromDay, toDay), empty clusters excluded; ties keep the lower id
+    std::vector<int> topClusters(int fromDay, int toDay, int k) const
+    {
+        std::vector<TimeCubeCell> cells = totals(fromDay, toDay);
+        std::vector<int> ids;
+        for (int c = 0; c < (int) cells.size(); c++)
+        {
+            if (cells[c].count > 0) { ids.push_back(c); }
+        }
+        size_t top = std::min<size_t>(std::max(k, 0), ids.size());
+        std::partial_sort(ids.begin(), ids.begin() + top, ids.end(), [&cells](int a, int b) {
+            return cells[a].count != cells[b].count ? cells[a].count > cells[b].count : a < b;
+        });
+        ids.resize(top);
+        return ids;
+    }
+
+protected:
+    const TimeCubeHeader* _header;
+    const TimeCubeCell* _prefix;
+
+    int clampDay(int day) const { return std::min(std::max(day - _header->firstDay, 0), _header->numDays); }
+};
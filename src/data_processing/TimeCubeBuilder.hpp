@@ -0,0 +1,100 @@
+// TimeCubeBuilder.hpp
+#pragma once
+#include "TimeCube.hpp"
+#include "TopCommentsBuilder.hpp"
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Writes the day x cluster prefix sums of comment counts, score and sentiment.
+ * `comments[i]` (with its utc) belongs to cluster `cluster_ids[i]`; rows with a negative cluster id are skipped, and so are
+ * rows without a time (utc <= 0, which is what a missing utc reads as), like the Qt CommentStore does.
+ */
+void save_time_cube(const std::string& path, const std::vector<CommentInfo>& comments, const std::vector<int>& cluster_ids);
+
+/**
+ * Reads a whole cube into `buffer` and opens `view` on it. Exits if the file is missing or not a valid cube.
+ */
+void load_time_cube(const std::string& path, std::vector<char>& buffer, TimeCubeView& view);
+
+// Implementations
+
+inline void save_time_cube(const std::string& path, const std::vector<CommentInfo>& comments, const std::vector<int>& cluster_ids)
+{
+    if (comments.size() != cluster_ids.size())
+    {
+        std::cout << "Got " << comments.size() << " comments but " << cluster_ids.size() << " cluster ids" << std::endl;
+        exit(1);
+    }
+
+    auto skipped = [&](size_t i) { return cluster_ids[i] < 0 || !(comments[i].utc > 0); };
+    std::vector<int> days(comments.size());
+    int firstDay = 0, lastDay = -1, numClusters = 0;
+    for (size_t i = 0; i < comments.size(); i++)
+    {
+        if (skipped(i)) { continue; }
+        days[i] = (int) std::floor(comments[i].utc / 86400.0);
+        if (lastDay < firstDay) { firstDay = lastDay = days[i]; }
+        firstDay = std::min(firstDay, days[i]);
+        lastDay = std::max(lastDay, days[i]);
+        numClusters = std::max(numClusters, cluster_ids[i] + 1);
+    }
+    int numDays = lastDay - firstDay + 1;
+
+    // per day totals first, then running sums in place: row d + 1 accumulates days [0, d]
+    std::vector<TimeCubeCell> prefix(((size_t) numDays + 1) * numClusters, TimeCubeCell{0, 0.0, 0.0});
+    for (size_t i = 0; i < comments.size(); i++)
+    {
+        if (skipped(i)) { continue; }
+        TimeCubeCell& cell = prefix[(size_t) (days[i] - firstDay + 1) * numClusters + cluster_ids[i]];
+        cell.count += 1;
+        cell.scoreSum += comments[i].score;
+        cell.sentimentSum += comments[i].sentiment;
+    }
+    for (size_t d = 1; d <= (size_t) numDays; d++)
+    {
+        for (int c = 0; c < numClusters; c++)
+        {
+            TimeCubeCell& cell = prefix[d * numClusters + c];
+            const TimeCubeCell& previous = prefix[(d - 1) * numClusters + c];
+            cell.count += previous.count;
+            cell.scoreSum += previous.scoreSum;
+            cell.sentimentSum += previous.sentimentSum;
+        }
+    }
+
+    TimeCubeHeader header = {};
+    std::memcpy(header.magic, "TCUB", 4);
+    header.version = TimeCubeView::VERSION;
+    header.numClusters = numClusters;
+    header.firstDay = firstDay;
+    header.numDays = numDays;
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Saving error" << std::endl;
+        exit(1);
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(prefix.data()), prefix.size() * sizeof(TimeCubeCell));
+}
+
+inline void load_time_cube(const std::string& path, std::vector<char>& buffer, TimeCubeView& view)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Error opening file: " << path << std::endl;
+        exit(1);
+    }
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (!view.open(buffer.data(), buffer.size()))
+    {
+        std::cout << "File " << path << " is not a time cube" << std::endl;
+        exit(1);
+    }
+}
@@ -0,0 +1,117 @@
+// TopComments.hpp
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/**
+ * Binary table of the top-N comments of every cluster, written by BuildTopComments and read by the Qt info window.
+ *
+ * Layout (little endian, every section 8-byte aligned):
+ *   TopCommentsHeader
+ *   int32 counts[numClusters][numOrders]              number of valid entries of every list
+ *   TopCommentEntry entries[numClusters][numOrders][topN]
+ *   UTF-8 texts, addressed by TopCommentEntry::textOffset relative to the text section
+ *
+ * Entries have a fixed size, so a list is found by arithmetic on (cluster, order) without any scan.
+ * This header only depends on the standard library so the Qt app can include it directly.
+ */
+enum TopCommentsOrder
+{
+    BY_DISTANCE = 0,   // closest to the cluster center first
+    BY_SCORE = 1,      // most upvoted first
+    BY_CONTROVERSY = 2,// strongest sentiment with the most engagement first
+    NUM_TOP_ORDERS = 3
+};
+
+struct TopCommentsHeader
+{
+    char magic[4];// "TOPN"
+    int32_t version;
+    int32_t numClusters;
+    int32_t topN;
+    int32_t numOrders;
+    int32_t reserved;
+    int64_t countsOffset;
+    int64_t entriesOffset;
+    int64_t textOffset;
+    int64_t textSize;
+};
+
+struct TopCommentEntry
+{
+    int64_t textOffset;
+    int32_t row;        // row of the comment in the original data set
+    uint32_t textLength;// in bytes
+    double value;       // distance, score or controversy, depending on the list
+};
+
+static_assert(sizeof(TopCommentsHeader) == 56, "TopCommentsHeader layout");
+static_assert(sizeof(TopCommentEntry) == 24, "TopCommentEntry layout");
+
+/**
+ * @class TopCommentsView
+ * @brief Read-only view over a top comments table held in memory (a loaded file or a memory map).
+ */
+class TopCommentsView
+{
+public:
+    static constexpr int32_t VERSION = 1;
+
+    TopCommentsView() : _data(nullptr), _size(0), _header(nullptr) {}
+
+    // returns false if the buffer is not a complete table; `data` must stay alive while the view is used
+    bool open(const char* data, size_t size)
+    {
+        _data = nullptr;
+        _header = nullptr;
+        if (data == nullptr || size < sizeof(TopCommentsHeader)) { return false; }
+        const TopCommentsHeader* header = reinterpret_cast<const TopCommentsHeader*>(data);
+        if (std::memcmp(header->magic, "TOPN", 4) != 0 || header->version != VERSION || header->numOrders != NUM_TOP_ORDERS)
+        {
+            return false;
+        }
+        if (header->numClusters < 0 || header->topN < 0) { return false; }
+        int64_t lists = (int64_t) header->numClusters * header->numOrders;
+        if (header->countsOffset + lists * (int64_t) sizeof(int32_t) > (int64_t) size
+            || header->entriesOffset + lists * header->topN * (int64_t) sizeof(TopCommentEntry) > (int64_t) size
+            || header->textOffset + header->textSize > (int64_t) size)
+        {
+            return false;
+        }
+        _data = data;
+        _size = size;
+        _header = header;
+        return true;
+    }
+
+    bool isOpen() const { return _header != nullptr; }
+    int numClusters() const { return _header ? _header->numClusters : 0; }
+    int topN() const { return _header ? _header->topN : 0; }
+
+    // number of entries of the list, 0 for an unknown cluster
+    int count(int cluster, TopCommentsOrder order) const
+    {
+        if (!_header || cluster < 0 || cluster >= _header->numClusters) { return 0; }
+        const int32_t* counts = reinterpret_cast<const int32_t*>(_data + _header->countsOffset);
+        return counts[(size_t) cluster * NUM_TOP_ORDERS + order];
+    }
+
+    const TopCommentEntry& entry(int cluster, TopCommentsOrder order, int i) const
+    {
+        const TopCommentEntry* entries = reinterpret_cast<const TopCommentEntry*>(_data + _header->entriesOffset);
+        return entries[((size_t) cluster * NUM_TOP_ORDERS + order) * _header->topN + i];
+    }
+
+    std::string_view text(const TopCommentEntry& entry) const
+    {
+        if (entry.textOffset < 0 || entry.textOffset + entry.textLength > _header->textSize) { return {}; }
+        return std::string_view(_data + _header->textOffset + entry.textOffset, entry.textLength);
+    }
+
+protected:
+    const char* _data;
+    size_t _size;
+    const TopCommentsHeader* _header;
+};
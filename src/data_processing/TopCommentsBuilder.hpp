@@ -0,0 +1,218 @@
+// TopCommentsBuilder.hpp
+#pragma once
+#include "../clustering_core/modules/structPoint.hpp"
+#include "TopComments.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief One comment of the original data set: the fields used to rank it and its text.
+ */
+struct CommentInfo
+{
+    double score;
+    double sentiment;
+    std::string text;
+    double utc = 0;// seconds since 1970-01-01, 0 when the file has no utc column
+};
+
+/**
+ * Reads the comments data set (a header row with at least `body`, `sentiment` and `score` columns, `utc` is optional).
+ * Quoted fields may contain commas, doubled quotes and line breaks.
+ */
+std::vector<CommentInfo> read_comments_csv(const std::string& path);
+
+// strong sentiment (either sign) on a comment many people voted on
+inline double controversyScore(double score, double sentiment) { return std::abs(sentiment) * std::log1p(std::abs(score)); }
+
+/**
+ * Writes the top `topN` comments of every cluster by distance, score and controversy.
+ * `combined[i]` is row i with its cluster_id and distance to the center (see combinePoints), `comments[i]` its text.
+ */
+void save_top_comments(const std::string& path, const std::vector<Point>& combined, const std::vector<CommentInfo>& comments, int topN);
+
+/**
+ * Reads a whole table into `buffer` and opens `view` on it. Exits if the file is missing or not a valid table.
+ */
+void load_top_comments(const std::string& path, std::vector<char>& buffer, TopCommentsView& view);
+
+// Implementations
+
+// splits one CSV record starting at `pos`, advances `pos` past the record
+inline bool readCsvRecord(const std::string& content, size_t& pos, std::vector<std::string>& fields)
+{
+    fields.clear();
+    if (pos >= content.size()) { return false; }
+    std::string field;
+    bool quoted = false;
+    while (pos < content.size())
+    {
+        char c = content[pos++];
+        if (quoted)
+        {
+            if (c == '"' && pos < content.size() && content[pos] == '"')
+            {
+                field += '"';
+                pos++;
+            }
+            else if (c == '"') { quoted = false; }
+            else { field += c; }
+        }
+        else if (c == '"') { quoted = true; }
+        else if (c == ',')
+        {
+            fields.push_back(field);
+            field.clear();
+        }
+        else if (c == '\n') { break; }
+        else if (c != '\r') { field += c; }
+    }
+    fields.push_back(field);
+    return true;
+}
+
+inline std::vector<CommentInfo> read_comments_csv(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Error opening file: " << path << std::endl;
+        exit(1);
+    }
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    size_t pos = 0;
+    std::vector<std::string> fields;
+    readCsvRecord(content, pos, fields);
+    int body = -1, sentiment = -1, score = -1, utc = -1;
+    for (size_t i = 0; i < fields.size(); i++)
+    {
+        if (fields[i] == "body") { body = i; }
+        if (fields[i] == "sentiment") { sentiment = i; }
+        if (fields[i] == "score") { score = i; }
+        if (fields[i] == "utc") { utc = i; }
+    }
+    if (body < 0 || sentiment < 0 || score < 0)
+    {
+        std::cout << "File " << path << " needs body, sentiment and score columns" << std::endl;
+        exit(1);
+    }
+
+    std::vector<CommentInfo> comments;
+    int needed = std::max(std::max(body, utc), std::max(sentiment, score));
+    while (readCsvRecord(content, pos, fields))
+    {
+        if ((int) fields.size() <= needed)
+        {
+            if (fields.size() == 1 && fields[0].empty()) { continue; }// blank line
+            std::cout << "Malformed comment record " << comments.size() << " in " << path << std::endl;
+            exit(1);
+        }
+        CommentInfo info;
+        info.score = fields[score].empty() ? 0.0 : std::stod(fields[score]);
+        info.sentiment = fields[sentiment].empty() ? 0.0 : std::stod(fields[sentiment]);
+        info.text = fields[body];
+        info.utc = utc < 0 || fields[utc].empty() ? 0.0 : std::stod(fields[utc]);
+        comments.push_back(info);
+    }
+    return comments;
+}
+
+inline void save_top_comments(const std::string& path, const std::vector<Point>& combined, const std::vector<CommentInfo>& comments, int topN)
+{
+    if (combined.size() != comments.size())
+    {
+        std::cout << "Got " << combined.size() << " clustered rows but " << comments.size() << " comments" << std::endl;
+        exit(1);
+    }
+    int numClusters = 0;
+    for (const Point& p: combined) { numClusters = std::max(numClusters, p.cluster_id + 1); }
+    std::vector<std::vector<int>> members(numClusters);
+    for (size_t i = 0; i < combined.size(); i++)
+    {
+        if (combined[i].cluster_id >= 0) { members[combined[i].cluster_id].push_back((int) i); }
+    }
+
+    // the key every list is sorted by, ascending; ties keep the lower row first
+    auto key = [&](int order, int row) {
+        if (order == BY_DISTANCE) { return combined[row].distance; }
+        if (order == BY_SCORE) { return -comments[row].score; }
+        return -controversyScore(comments[row].score, comments[row].sentiment);
+    };
+
+    std::vector<int32_t> counts((size_t) numClusters * NUM_TOP_ORDERS, 0);
+    std::vector<TopCommentEntry> entries((size_t) numClusters * NUM_TOP_ORDERS * topN, TopCommentEntry{0, -1, 0, 0.0});
+    std::unordered_map<int, int64_t> textOffsets;// every comment text is stored once even if it is in several lists
+    std::string texts;
+    for (int c = 0; c < numClusters; c++)
+    {
+        for (int order = 0; order < NUM_TOP_ORDERS; order++)
+        {
+            std::vector<int> rows = members[c];
+            size_t top = std::min<size_t>(topN, rows.size());
+            std::partial_sort(rows.begin(), rows.begin() + top, rows.end(), [&](int a, int b) {
+                double ka = key(order, a), kb = key(order, b);
+                return ka != kb ? ka < kb : a < b;
+            });
+            size_t list = (size_t) c * NUM_TOP_ORDERS + order;
+            counts[list] = (int32_t) top;
+            for (size_t i = 0; i < top; i++)
+            {
+                int row = rows[i];
+                auto it = textOffsets.find(row);
+                if (it == textOffsets.end())
+                {
+                    it = textOffsets.emplace(row, (int64_t) texts.size()).first;
+                    texts += comments[row].text;
+                }
+                entries[list * topN + i] = TopCommentEntry{it->second, row, (uint32_t) comments[row].text.size(), order == BY_DISTANCE ? key(order, row) : -key(order, row)};
+            }
+        }
+    }
+
+    auto align8 = [](int64_t offset) { return (offset + 7) / 8 * 8; };
+    TopCommentsHeader header = {};
+    std::memcpy(header.magic, "TOPN", 4);
+    header.version = TopCommentsView::VERSION;
+    header.numClusters = numClusters;
+    header.topN = topN;
+    header.numOrders = NUM_TOP_ORDERS;
+    header.countsOffset = sizeof(TopCommentsHeader);
+    header.entriesOffset = align8(header.countsOffset + counts.size() * sizeof(int32_t));
+    header.textOffset = header.entriesOffset + entries.size() * sizeof(TopCommentEntry);
+    header.textSize = texts.size();
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Saving error" << std::endl;
+        exit(1);
+    }
+    const char padding[8] = {};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(counts.data()), counts.size() * sizeof(int32_t));
+    file.write(padding, header.entriesOffset - header.countsOffset - counts.size() * sizeof(int32_t));
+    file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(TopCommentEntry));
+    file.write(texts.data(), texts.size());
+}
+
+inline void load_top_comments(const std::string& path, std::vector<char>& buffer, TopCommentsView& view)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Error opening file: " << path << std::endl;
+        exit(1);
+    }
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (!view.open(buffer.data(), buffer.size()))
+    {
+        std::cout << "File " << path << " is not a top comments table" << std::endl;
+        exit(1);
+    }
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include "../../clustering_core/modules/scratchArena.hpp"
 #include "../../clustering_core/modules/structPoint.hpp"
 #include "SortingClusters.hpp"
 #include <algorithm>
@@ -14,35 +15,44 @@ std::vector<Point> getNeighbors(const Point& center, const std::vector<Point>& p
     if (k <= 0) { return std::vector<Point>(); }
     if (k >= points.size()) { return points; }
 
-    // Sort points by distance from the center
-    std::vector<Point> sortedPoints = points;
-    sortPointsByDistance(center, sortedPoints);
+    // Sort the indices of the points by distance from the center, the same order sortPointsByDistance gives,
+    // without copying the points; the temporaries come from the thread's scratch buffer
+    ScratchArena arena;
+    ScratchVector<double> centerDist(points.size(), arena.resource());
+    ScratchVector<int> sorted(points.size(), arena.resource());
+    for (size_t i = 0; i < points.size(); i++) {
+        centerDist[i] = points[i].calcDist(center);
+        sorted[i] = (int) i;
+    }
+    std::sort(sorted.begin(), sorted.end(), [&centerDist](int a, int b) { return centerDist[a] < centerDist[b]; });
 
     // Select points based on max distance from each other and closest to center
     std::vector<Point> neighbors;
-    neighbors.push_back(sortedPoints[0]); // Start with the closest point to the center
+    neighbors.reserve(k);
+    neighbors.push_back(points[sorted[0]]); // Start with the closest point to the center
 
+    // minDist[s]: distance of the s-th sorted point to its nearest selected neighbor, updated with the newest one
+    ScratchVector<double> minDist(points.size(), __DBL_MAX__, arena.resource());
+    int last = sorted[0];
     while (neighbors.size() < k) {
         double maxMinDist = -1.0;
-        Point bestCandidate;
-
-        for (const auto& point : sortedPoints) {
-            double minDist = __DBL_MAX__;
-            for (const auto& neighbor : neighbors) {
-                double dist = point.calcDist(neighbor);
-                if (dist < minDist) {
-                    minDist = dist;
-                }
+        int bestCandidate = -1;
+
+        for (size_t s = 0; s < sorted.size(); s++) {
+            double dist = points[sorted[s]].calcDist(points[last]);
+            if (dist < minDist[s]) {
+                minDist[s] = dist;
             }
 
-            if (minDist > maxMinDist) {
-                maxMinDist = minDist;
-                bestCandidate = point;
+            if (minDist[s] > maxMinDist) {
+                maxMinDist = minDist[s];
+                bestCandidate = sorted[s];
             }
         }
 
-        neighbors.push_back(bestCandidate);
+        neighbors.push_back(points[bestCandidate]);
+        last = bestCandidate;
     }
 
     return neighbors;
-}
\ No newline at end of file
+}
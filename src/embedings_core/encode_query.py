@@ -0,0 +1,25 @@
+# Query encoder for the Qt search window. The app starts it once and keeps it
+# running. It prints "ready" once the model is loaded, after a warm-up embedding,
+# then reads one text per line on stdin and answers every line with the
+# embedding as comma separated values on one line of stdout, or with an empty
+# line when the text is empty or can not be encoded. It exits at the end of stdin.
+import sys
+
+from transformer import get_query_embedding
+
+if __name__ == "__main__":
+    # the first embedding makes the server load the model, so the first real query is not the slow one
+    try:
+        get_query_embedding("ready")
+    except Exception as error:
+        print("encode_query: " + str(error), file=sys.stderr, flush=True)
+    print("ready", flush=True)
+    for line in iter(sys.stdin.readline, ""):
+        text = line.strip()
+        answer = ""
+        if text:
+            try:
+                answer = ",".join(str(x) for x in get_query_embedding(text))
+            except Exception as error:
+                print("encode_query: " + str(error), file=sys.stderr, flush=True)
+        print(answer, flush=True)
@@ -0,0 +1,88 @@
+#include "../benchmarks_core/AllocationCounter.hpp"
+#include "../clustering_core/modules/ReadData.hpp"
+#include "HNSWIndex.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+std::vector<std::vector<int>> bruteForceTopK(const std::vector<Point>& points, const std::vector<int>& queries, int k);
+double recallAtK(const std::vector<std::pair<int, double>>& found, const std::vector<int>& expected);
+
+// usage: BenchmarkHNSW [embeddings] [index path] [num queries] [M] [efConstruction] [threads]
+int main(int argc, char* argv[])
+{
+    std::string embPath = argc > 1 ? argv[1] : "../../data/big_data/embeddings.npy";
+    std::string indexPath = argc > 2 ? argv[2] : "../../data/big_data/embeddings.hnsw";
+    int numQueries = argc > 3 ? std::stoi(argv[3]) : 1000;
+    int M = argc > 4 ? std::stoi(argv[4]) : 16;
+    int efConstruction = argc > 5 ? std::stoi(argv[5]) : 200;
+    int numThreads = argc > 6 ? std::stoi(argv[6]) : 0;
+    const int k = 10;
+
+    std::vector<Point> points = read_data(embPath);
+    std::cout << "Read " << points.size() << " points of dimension " << points[0].coords.size() << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        HNSWIndex index(M, efConstruction);
+        index.build(points, numThreads);
+        index.save(indexPath);
+    }
+    double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Built and saved index in " << buildSeconds << " s to " << indexPath << std::endl;
+
+    HNSWIndex index;
+    index.load(indexPath);
+
+    // evenly spaced queries taken from the data set
+    std::vector<int> queries;
+    numQueries = std::min<int>(numQueries, points.size());
+    for (int i = 0; i < numQueries; i++) { queries.push_back((int) ((size_t) i * points.size() / numQueries)); }
+    std::vector<std::vector<int>> expected = bruteForceTopK(points, queries, k);
+
+    std::cout << std::setw(8) << "ef" << std::setw(14) << "recall@10" << std::setw(14) << "queries/s" << std::setw(16) << "allocs/query" << std::endl;
+    for (int ef: {10, 20, 40, 80, 160, 320})
+    {
+        double recall = 0;
+        size_t allocations = allocationCount();
+        start = std::chrono::steady_clock::now();
+        for (size_t q = 0; q < queries.size(); q++)
+        {
+            recall += recallAtK(index.search(points[queries[q]], k, ef), expected[q]);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        allocations = allocationCount() - allocations;
+        std::cout << std::setw(8) << ef << std::setw(14) << recall / queries.size() << std::setw(14) << (int) (queries.size() / seconds)
+                  << std::setw(16) << (double) allocations / std::max<size_t>(1, queries.size()) << std::endl;
+    }
+    return 0;
+}
+
+std::vector<std::vector<int>> bruteForceTopK(const std::vector<Point>& points, const std::vector<int>& queries, int k)
+{
+    std::vector<std::vector<int>> result;
+    std::vector<std::pair<double, int>> distances(points.size());
+    for (int q: queries)
+    {
+        for (size_t i = 0; i < points.size(); i++) { distances[i] = {points[q].calcDist(points[i]), (int) i}; }
+        int top = std::min<int>(k, distances.size());
+        std::partial_sort(distances.begin(), distances.begin() + top, distances.end());
+        std::vector<int> ids;
+        for (int i = 0; i < top; i++) { ids.push_back(distances[i].second); }
+        result.push_back(ids);
+    }
+    return result;
+}
+
+double recallAtK(const std::vector<std::pair<int, double>>& found, const std::vector<int>& expected)
+{
+    int hits = 0;
+    for (const auto& hit: found)
+    {
+        if (std::find(expected.begin(), expected.end(), hit.first) != expected.end()) { hits++; }
+    }
+    return expected.empty() ? 1.0 : (double) hits / expected.size();
+}
@@ -0,0 +1,516 @@
+// HNSWIndex.hpp
+#pragma once
+#include "../clustering_core/modules/memoryBudget.hpp"
+#include "../clustering_core/modules/scratchArena.hpp"
+#include "../clustering_core/modules/structPoint.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+/**
+ * @class HNSWIndex
+ * @brief Hierarchical Navigable Small World graph for approximate top-k neighbor search.
+ *
+ * Every point is a node on level 0 and, with exponentially decreasing probability, on higher levels.
+ * A query descends greedily through the sparse upper levels and then runs a best-first search with
+ * `ef` candidates on level 0; larger `ef` gives higher recall at lower speed.
+ *
+ * All storage is kept in flat arrays so the index can be saved to a single file and memory-mapped back
+ * without parsing (see `save` / `load`).
+ */
+class HNSWIndex
+{
+public:
+    typedef std::pair<double, int> Candidate;// (squared distance, node id)
+
+    HNSWIndex(int M = 16, int efConstruction = 200, unsigned seed = 42)
+        : _M(M), _maxM0(2 * M), _efConstruction(efConstruction), _seed(seed), _levelMult(1.0 / log(std::max(M, 2))) {}
+    HNSWIndex(const HNSWIndex&) = delete;
+    HNSWIndex& operator=(const HNSWIndex&) = delete;
+    ~HNSWIndex() { unmap(); }
+
+    void build(const std::vector<Point>& points, int numThreads = 0);
+    std::vector<std::pair<int, double>> search(const Point& query, int k, int ef) const;
+
+    void save(const std::string& path) const;
+    void load(const std::string& path);
+
+    size_t size() const { return _n; }
+    int getDimension() const { return _dim; }
+    int getMaxLevel() const { return _maxLevel; }
+    bool isMapped() const { return _mapped != nullptr; }
+
+protected:
+    int _M;
+    int _maxM0;
+    int _efConstruction;
+    unsigned _seed;
+    double _levelMult;
+
+    int _dim = 0;
+    size_t _n = 0;
+    int _entryPoint = -1;
+    int _maxLevel = -1;
+
+    // views used by search, pointing either to the owned vectors below or into the mapped file
+    const double* _data = nullptr;    ///< n * dim coordinates
+    int* _links0 = nullptr;           ///< n * (1 + maxM0): neighbor count followed by neighbor ids
+    const int* _levels = nullptr;     ///< top level of every node
+    const int64_t* _upperOffsets = nullptr;///< n + 1 offsets into _upperLinks
+    int* _upperLinks = nullptr;       ///< per node, for levels 1..level: count followed by M ids
+
+    std::vector<double> _ownedData;
+    std::vector<int> _ownedLinks0;
+    std::vector<int> _ownedLevels;
+    std::vector<int64_t> _ownedUpperOffsets;
+    std::vector<int> _ownedUpperLinks;
+
+    void* _mapped = nullptr;
+    size_t _mappedSize = 0;
+
+    MemoryReservation _memory;// the owned vectors against the memory budget; a mapped file is paged by the OS
+
+    std::unique_ptr<std::mutex[]> _nodeLocks;// only used while building
+    std::mutex _globalLock;
+
+    double distance(const double* a, const double* b) const
+    {
+        double sum = 0;
+        for (int i = 0; i < _dim; i++) { sum += (a[i] - b[i]) * (a[i] - b[i]); }
+        return sum;
+    }
+    int* linksAt(int node, int level) const
+    {
+        if (level == 0) { return _links0 + (size_t) node * (1 + _maxM0); }
+        return _upperLinks + _upperOffsets[node] + (size_t) (level - 1) * (1 + _M);
+    }
+    struct LinkRange
+    {
+        const int* first;
+        const int* last;
+        const int* begin() const { return first; }
+        const int* end() const { return last; }
+    };
+    // links of `node` on `level`; while building, other threads change them, so they are copied into `copy`
+    LinkRange neighbors(int node, int level, ScratchVector<int>& copy) const;
+
+    // the temporaries of a search or an insert come from `scratch`, the ScratchArena of the query or node
+    int greedyClosest(const double* query, int entry, int level, std::pmr::memory_resource* scratch) const;
+    ScratchVector<Candidate> searchLayer(const double* query, int entry, int ef, int level, std::pmr::memory_resource* scratch) const;
+    ScratchVector<int> selectNeighbors(const ScratchVector<Candidate>& candidates, int maxCount, std::pmr::memory_resource* scratch) const;
+    void connect(int node, int level, const ScratchVector<int>& selected, std::pmr::memory_resource* scratch);
+    void insert(int node);
+    void unmap();
+};
+
+inline HNSWIndex::LinkRange HNSWIndex::neighbors(int node, int level, ScratchVector<int>& copy) const
+{
+    const int* links = linksAt(node, level);
+    if (_nodeLocks)
+    {
+        std::lock_guard<std::mutex> guard(_nodeLocks[node]);
+        copy.assign(links + 1, links + 1 + links[0]);
+        return {copy.data(), copy.data() + copy.size()};
+    }
+    return {links + 1, links + 1 + links[0]};
+}
+
+inline int HNSWIndex::greedyClosest(const double* query, int entry, int level, std::pmr::memory_resource* scratch) const
+{
+    ScratchVector<int> copy(scratch);
+    int current = entry;
+    double currentDist = distance(query, _data + (size_t) current * _dim);
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int next: neighbors(current, level, copy))
+        {
+            double dist = distance(query, _data + (size_t) next * _dim);
+            if (dist < currentDist)
+            {
+                currentDist = dist;
+                current = next;
+                changed = true;
+            }
+        }
+    }
+    return current;
+}
+
+/**
+ * Best-first search on one level. Returns up to `ef` closest nodes found, sorted by distance.
+ * The visited set is a per-thread array of epoch tags, so it is not cleared between queries.
+ */
+inline ScratchVector<HNSWIndex::Candidate> HNSWIndex::searchLayer(const double* query, int entry, int ef, int level,
+                                                          std::pmr::memory_resource* scratch) const
+{
+    thread_local std::vector<uint32_t> visited;
+    thread_local uint32_t epoch = 0;
+    if (visited.size() < _n) { visited.assign(_n, 0); }
+    if (++epoch == 0)
+    {
+        std::fill(visited.begin(), visited.end(), 0);
+        epoch = 1;
+    }
+
+    typedef std::priority_queue<Candidate, ScratchVector<Candidate>, std::greater<Candidate>> ClosestFirst;
+    typedef std::priority_queue<Candidate, ScratchVector<Candidate>> FarthestFirst;
+    ClosestFirst candidates{std::greater<Candidate>(), ScratchVector<Candidate>(scratch)};
+    FarthestFirst found{std::less<Candidate>(), ScratchVector<Candidate>(scratch)};
+    ScratchVector<int> copy(scratch);
+
+    double entryDist = distance(query, _data + (size_t) entry * _dim);
+    candidates.push({entryDist, entry});
+    found.push({entryDist, entry});
+    visited[entry] = epoch;
+
+    while (!candidates.empty())
+    {
+        Candidate current = candidates.top();
+        if (current.first > found.top().first && (int) found.size() >= ef) { break; }
+        candidates.pop();
+
+        for (int next: neighbors(current.second, level, copy))
+        {
+            if (visited[next] == epoch) { continue; }
+            visited[next] = epoch;
+            double dist = distance(query, _data + (size_t) next * _dim);
+            if ((int) found.size() < ef || dist < found.top().first)
+            {
+                candidates.push({dist, next});
+                found.push({dist, next});
+                if ((int) found.size() > ef) { found.pop(); }
+            }
+        }
+    }
+
+    ScratchVector<Candidate> result(found.size(), scratch);
+    for (int i = (int) found.size() - 1; i >= 0; i--)
+    {
+        result[i] = found.top();
+        found.pop();
+    }
+    return result;
+}
+
+/**
+ * Neighbor selection heuristic: a candidate is kept only if it is closer to the base node than to every
+ * already selected neighbor, which keeps links spread in different directions.
+ * `candidates` must be sorted by distance to the base node.
+ */
+inline ScratchVector<int> HNSWIndex::selectNeighbors(const ScratchVector<Candidate>& candidates, int maxCount, std::pmr::memory_resource* scratch) const
+{
+    ScratchVector<int> selected(scratch);
+    for (const auto& candidate: candidates)
+    {
+        if ((int) selected.size() >= maxCount) { break; }
+        bool keep = true;
+        const double* point = _data + (size_t) candidate.second * _dim;
+        for (int other: selected)
+        {
+            if (distance(point, _data + (size_t) other * _dim) < candidate.first)
+            {
+                keep = false;
+                break;
+            }
+        }
+        if (keep) { selected.push_back(candidate.second); }
+    }
+    return selected;
+}
+
+inline void HNSWIndex::connect(int node, int level, const ScratchVector<int>& selected, std::pmr::memory_resource* scratch)
+{
+    int maxCount = level == 0 ? _maxM0 : _M;
+    {
+        std::lock_guard<std::mutex> guard(_nodeLocks[node]);
+        int* links = linksAt(node, level);
+        links[0] = (int) selected.size();
+        std::copy(selected.begin(), selected.end(), links + 1);
+    }
+    const double* nodeData = _data + (size_t) node * _dim;
+    for (int other: selected)
+    {
+        std::lock_guard<std::mutex> guard(_nodeLocks[other]);
+        int* links = linksAt(other, level);
+        if (links[0] < maxCount)
+        {
+            links[1 + links[0]++] = node;
+            continue;
+        }
+        // full: re-select among the old links plus the new node
+        const double* otherData = _data + (size_t) other * _dim;
+        ScratchVector<Candidate> candidates(scratch);
+        candidates.reserve(1 + links[0]);
+        candidates.push_back({distance(otherData, nodeData), node});
+        for (int i = 1; i <= links[0]; i++) { candidates.push_back({distance(otherData, _data + (size_t) links[i] * _dim), links[i]}); }
+        std::sort(candidates.begin(), candidates.end());
+        ScratchVector<int> kept = selectNeighbors(candidates, maxCount, scratch);
+        links[0] = (int) kept.size();
+        std::copy(kept.begin(), kept.end(), links + 1);
+    }
+}
+
+inline void HNSWIndex::insert(int node)
+{
+    int level = _levels[node];
+    const double* query = _data + (size_t) node * _dim;
+    ScratchArena arena;
+
+    // a node that raises the top level holds the global lock so only one new entry point is installed at a time
+    std::unique_lock<std::mutex> global(_globalLock);
+    int entry = _entryPoint;
+    int maxLevel = _maxLevel;
+    if (level <= maxLevel) { global.unlock(); }
+
+    for (int lc = maxLevel; lc > level; lc--) { entry = greedyClosest(query, entry, lc, arena.resource()); }
+    for (int lc = std::min(level, maxLevel); lc >= 0; lc--)
+    {
+        ScratchVector<Candidate> candidates = searchLayer(query, entry, _efConstruction, lc, arena.resource());
+        connect(node, lc, selectNeighbors(candidates, lc == 0 ? _maxM0 : _M, arena.resource()), arena.resource());
+        entry = candidates[0].second;
+    }
+    if (level > maxLevel)
+    {
+        _entryPoint = node;
+        _maxLevel = level;
+    }
+}
+
+inline void HNSWIndex::build(const std::vector<Point>& points, int numThreads)
+{
+    unmap();
+    _n = points.size();
+    _dim = _n ? points[0].coords.size() : 0;
+    _entryPoint = -1;
+    _maxLevel = -1;
+    _memory.release();
+    if (_n == 0) { return; }
+
+    // levels are drawn up front from a seeded generator, so the layout does not depend on thread scheduling
+    std::mt19937 gen(_seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    _ownedLevels.resize(_n);
+    _ownedUpperOffsets.assign(_n + 1, 0);
+    for (size_t i = 0; i < _n; i++)
+    {
+        _ownedLevels[i] = (int) (-log(1.0 - uniform(gen)) * _levelMult);
+        _ownedUpperOffsets[i + 1] = _ownedUpperOffsets[i] + (int64_t) _ownedLevels[i] * (1 + _M);
+    }
+    // the level layout gives the exact size of the graph, checked before the large arrays are allocated
+    _memory = MemoryReservation("the HNSW index", _n * (_dim * sizeof(double) + (1 + _maxM0) * sizeof(int) + sizeof(int) + sizeof(int64_t) + sizeof(std::mutex))
+                                                      + _ownedUpperOffsets[_n] * sizeof(int));
+
+    _ownedData.resize(_n * _dim);
+    for (size_t i = 0; i < _n; i++) { std::copy(points[i].coords.begin(), points[i].coords.end(), _ownedData.begin() + i * _dim); }
+    _ownedLinks0.assign(_n * (1 + _maxM0), 0);
+    _ownedUpperLinks.assign(_ownedUpperOffsets[_n], 0);
+
+    _data = _ownedData.data();
+    _links0 = _ownedLinks0.data();
+    _levels = _ownedLevels.data();
+    _upperOffsets = _ownedUpperOffsets.data();
+    _upperLinks = _ownedUpperLinks.data();
+    _nodeLocks.reset(new std::mutex[_n]);
+
+    _entryPoint = 0;
+    _maxLevel = _levels[0];
+
+    if (numThreads <= 0) { numThreads = std::max(1u, std::thread::hardware_concurrency()); }
+    std::atomic<size_t> next(1);
+    auto worker = [&]() {
+        for (size_t i = next++; i < _n; i = next++) { insert((int) i); }
+    };
+    std::vector<std::thread> threads;
+    for (int t = 1; t < numThreads; t++) { threads.emplace_back(worker); }
+    worker();
+    for (auto& thread: threads) { thread.join(); }
+
+    _nodeLocks.reset();
+}
+
+/**
+ * Returns up to k (id, distance) pairs sorted by distance. `ef` is raised to k if it is smaller.
+ */
+inline std::vector<std::pair<int, double>> HNSWIndex::search(const Point& query, int k, int ef) const
+{
+    std::vector<std::pair<int, double>> result;
+    if (_n == 0 || k <= 0) { return result; }
+
+    // the queues and candidate lists of one query come from the thread's scratch buffer, reused by the next query
+    ScratchArena arena;
+    int entry = _entryPoint;
+    for (int lc = _maxLevel; lc > 0; lc--) { entry = greedyClosest(query.coords.data(), entry, lc, arena.resource()); }
+    ScratchVector<Candidate> found = searchLayer(query.coords.data(), entry, std::max(ef, k), 0, arena.resource());
+
+    result.reserve(std::min<size_t>(found.size(), k));
+    for (size_t i = 0; i < found.size() && (int) i < k; i++) { result.push_back({found[i].second, sqrt(found[i].first)}); }
+    return result;
+}
+
+/**
+ * File layout (all sections 8-byte aligned, native endianness):
+ *   "HNSW", uint32 version, int32 dim, M, maxM0, maxLevel, entryPoint, padding, int64 n, int64 upperSize
+ *   double data[n * dim]
+ *   int32  links0[n * (1 + maxM0)]
+ *   int32  levels[n]                 (padded to 8 bytes)
+ *   int64  upperOffsets[n + 1]
+ *   int32  upperLinks[upperSize]
+ */
+inline void HNSWIndex::save(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Saving error" << std::endl;
+        exit(1);
+    }
+    uint32_t version = 1;
+    int32_t header[6] = {_dim, _M, _maxM0, _maxLevel, _entryPoint, 0};
+    int64_t sizes[2] = {(int64_t) _n, _n ? _upperOffsets[_n] : 0};
+    file.write("HNSW", 4);
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+    if (_n == 0) { return; }
+
+    const char padding[8] = {0};
+    file.write(reinterpret_cast<const char*>(_data), _n * _dim * sizeof(double));
+    file.write(reinterpret_cast<const char*>(_links0), _n * (1 + _maxM0) * sizeof(int32_t));
+    file.write(padding, (_n * (1 + _maxM0) * sizeof(int32_t)) % 8);
+    file.write(reinterpret_cast<const char*>(_levels), _n * sizeof(int32_t));
+    file.write(padding, (_n * sizeof(int32_t)) % 8);
+    file.write(reinterpret_cast<const char*>(_upperOffsets), (_n + 1) * sizeof(int64_t));
+    file.write(reinterpret_cast<const char*>(_upperLinks), _upperOffsets[_n] * sizeof(int32_t));
+}
+
+/**
+ * Memory-maps an index written by `save`. Pages are loaded lazily by the OS and shared between processes.
+ */
+inline void HNSWIndex::load(const std::string& path)
+{
+    unmap();
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0)
+    {
+        std::cout << "File " << path << " not found" << std::endl;
+        exit(1);
+    }
+    _mappedSize = info.st_size;
+    _mapped = mmap(nullptr, _mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (_mapped == MAP_FAILED || _mappedSize < 48 || std::memcmp(_mapped, "HNSW", 4) != 0)
+    {
+        if (_mapped != MAP_FAILED) { munmap(_mapped, _mappedSize); }
+        _mapped = nullptr;
+        std::cout << "File " << path << " is not an HNSW index" << std::endl;
+        exit(1);
+    }
+
+    const char* base = static_cast<const char*>(_mapped);
+    const uint32_t version = *reinterpret_cast<const uint32_t*>(base + 4);
+    const int32_t* header = reinterpret_cast<const int32_t*>(base + 8);
+    const int64_t* sizes = reinterpret_cast<const int64_t*>(base + 32);
+    _dim = header[0];
+    _M = header[1];
+    _maxM0 = header[2];
+    _maxLevel = header[3];
+    _entryPoint = header[4];
+    _n = sizes[0] < 0 ? 0 : sizes[0];
+
+    // every section has to end inside the file before a pointer to it is kept; `count` elements of `size`
+    // bytes at `offset` fit if they do not reach past the end, checked without overflowing
+    size_t offset = 48;
+    bool valid = version == 1 && sizes[0] >= 0 && sizes[1] >= 0 && _dim >= 0 && _M > 0 && _maxM0 >= 0;
+    if (_n > 0) { valid = valid && _dim > 0 && _entryPoint >= 0 && (size_t) _entryPoint < _n; }
+    auto section = [&](size_t count, size_t size) {
+        valid = valid && offset <= _mappedSize && count <= (_mappedSize - offset) / size;
+        size_t start = offset;
+        if (valid) { offset += count * size; }
+        return start;
+    };
+    auto align = [&]() {
+        if (valid) { offset += offset % 8; }
+    };
+    // an empty index is the header only
+    if (valid && _n == 0) { return; }
+    if (valid) { valid = (size_t) _dim <= SIZE_MAX / sizeof(double) / std::max<size_t>(_n, 1) && (size_t) _maxM0 + 1 <= SIZE_MAX / sizeof(int32_t) / std::max<size_t>(_n, 1); }
+    size_t data = section(_n * _dim, sizeof(double));
+    size_t links0 = section(_n * (1 + _maxM0), sizeof(int32_t));
+    align();
+    size_t levels = section(_n, sizeof(int32_t));
+    align();
+    size_t upperOffsets = section(_n + 1, sizeof(int64_t));
+    size_t upperLinks = section(sizes[1], sizeof(int32_t));
+    // the offsets table has to end at the size of the upper links written in the header
+    if (valid)
+    {
+        const int64_t* offsets = reinterpret_cast<const int64_t*>(base + upperOffsets);
+        valid = offsets[0] == 0 && offsets[_n] == sizes[1];
+    }
+    // search follows the links without bounds checks, so the graph is checked once here: every node
+    // has its level's share of the upper links, the entry point is on the top level, and every link
+    // count and neighbor id is in range, with upper-level neighbors present on that level
+    if (valid)
+    {
+        const int32_t* nodeLevels = reinterpret_cast<const int32_t*>(base + levels);
+        const int64_t* offsets = reinterpret_cast<const int64_t*>(base + upperOffsets);
+        const int32_t* lower = reinterpret_cast<const int32_t*>(base + links0);
+        const int32_t* upper = reinterpret_cast<const int32_t*>(base + upperLinks);
+        valid = _maxLevel >= 0 && nodeLevels[_entryPoint] == _maxLevel;
+        for (size_t i = 0; valid && i < _n; i++)
+        {
+            valid = nodeLevels[i] >= 0 && nodeLevels[i] <= _maxLevel && offsets[i + 1] >= offsets[i] && offsets[i + 1] - offsets[i] == (int64_t) nodeLevels[i] * (1 + _M);
+        }
+        for (size_t i = 0; valid && i < _n; i++)
+        {
+            const int32_t* links = lower + i * (1 + _maxM0);
+            valid = links[0] >= 0 && links[0] <= _maxM0;
+            for (int j = 1; valid && j <= links[0]; j++) { valid = links[j] >= 0 && (size_t) links[j] < _n; }
+            for (int level = 1; valid && level <= nodeLevels[i]; level++)
+            {
+                links = upper + offsets[i] + (size_t) (level - 1) * (1 + _M);
+                valid = links[0] >= 0 && links[0] <= _M;
+                for (int j = 1; valid && j <= links[0]; j++) { valid = links[j] >= 0 && (size_t) links[j] < _n && nodeLevels[links[j]] >= level; }
+            }
+        }
+    }
+    if (!valid)
+    {
+        unmap();
+        _n = 0;
+        std::cout << "File " << path << " is truncated, damaged or not an HNSW index" << std::endl;
+        exit(1);
+    }
+
+    _data = reinterpret_cast<const double*>(base + data);
+    _links0 = reinterpret_cast<int*>(const_cast<char*>(base + links0));
+    _levels = reinterpret_cast<const int*>(base + levels);
+    _upperOffsets = reinterpret_cast<const int64_t*>(base + upperOffsets);
+    _upperLinks = reinterpret_cast<int*>(const_cast<char*>(base + upperLinks));
+}
+
+inline void HNSWIndex::unmap()
+{
+    if (_mapped) { munmap(_mapped, _mappedSize); }
+    _mapped = nullptr;
+    _mappedSize = 0;
+}
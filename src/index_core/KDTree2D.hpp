@@ -0,0 +1,243 @@
+// KDTree2D.hpp
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+/**
+ * @class BasicKDTree2D
+ * @brief Static k-d tree over 2D points for nearest point, rectangle and polygon (lasso) queries.
+ *
+ * Nodes split the wider side of their bounding box at the median, leaves hold up to LEAF_SIZE points.
+ * Points are copied in leaf order, so a leaf is one contiguous run of coordinates, and every node keeps
+ * its exact bounding box for pruning. Results are indices into the arrays the tree was built from.
+ * Standard library only, so the Qt app and the clustering tools can both include it.
+ */
+template <typename Scalar>
+class BasicKDTree2D
+{
+public:
+    typedef std::pair<Scalar, Scalar> Vertex;
+    static constexpr int LEAF_SIZE = 16;
+
+    BasicKDTree2D() {}
+    BasicKDTree2D(const Scalar* xs, const Scalar* ys, size_t count) { build(xs, ys, count); }
+    BasicKDTree2D(const std::vector<Scalar>& xs, const std::vector<Scalar>& ys) { build(xs.data(), ys.data(), std::min(xs.size(), ys.size())); }
+
+    void build(const Scalar* xs, const Scalar* ys, size_t count)
+    {
+        _index.resize(count);
+        std::iota(_index.begin(), _index.end(), 0);
+        _x.assign(xs, xs + count);
+        _y.assign(ys, ys + count);
+        _nodes.clear();
+        if (count > 0) { buildNode(0, (int) count); }
+
+        // store coordinates in leaf order
+        std::vector<Scalar> x(count), y(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            x[i] = _x[_index[i]];
+            y[i] = _y[_index[i]];
+        }
+        _x.swap(x);
+        _y.swap(y);
+    }
+
+    size_t size() const { return _index.size(); }
+
+    /**
+     * Index of the point closest to (x, y) at a distance of at most maxDistance, -1 if there is none.
+     * Among equally close points the lowest index wins.
+     */
+    int nearest(Scalar x, Scalar y, Scalar maxDistance = std::numeric_limits<Scalar>::max()) const
+    {
+        int best = -1;
+        Scalar bestDistance = maxDistance >= std::numeric_limits<Scalar>::max() ? maxDistance : maxDistance * maxDistance;
+        if (_nodes.empty()) { return best; }
+
+        std::vector<int> stack = {0};
+        while (!stack.empty())
+        {
+            const Node& node = _nodes[stack.back()];
+            stack.pop_back();
+            if (boxDistance(node, x, y) > bestDistance) { continue; }
+            if (node.left < 0)
+            {
+                for (int i = node.begin; i < node.end; i++)
+                {
+                    Scalar dx = _x[i] - x, dy = _y[i] - y;
+                    Scalar d = dx * dx + dy * dy;
+                    if (d < bestDistance || (d == bestDistance && (best < 0 || _index[i] < best)))
+                    {
+                        bestDistance = d;
+                        best = _index[i];
+                    }
+                }
+                continue;
+            }
+            // the closer child goes on top of the stack so it tightens the bound first
+            int nearChild = node.left, farChild = node.right;
+            if (boxDistance(_nodes[farChild], x, y) < boxDistance(_nodes[nearChild], x, y)) { std::swap(nearChild, farChild); }
+            stack.push_back(farChild);
+            stack.push_back(nearChild);
+        }
+        return best;
+    }
+
+    // indices of the points inside the closed rectangle, ascending
+    std::vector<int> inRect(Scalar minX, Scalar minY, Scalar maxX, Scalar maxY) const
+    {
+        std::vector<int> result;
+        collect(
+            [&](const Node& node) {
+                if (node.maxX < minX || node.minX > maxX || node.maxY < minY || node.minY > maxY) { return OUTSIDE; }
+                if (node.minX >= minX && node.maxX <= maxX && node.minY >= minY && node.maxY <= maxY) { return INSIDE; }
+                return PARTIAL;
+            },
+            [&](Scalar x, Scalar y) { return x >= minX && x <= maxX && y >= minY && y <= maxY; }, result);
+        return result;
+    }
+
+    // indices of the points inside the polygon (even-odd rule, vertices in order, closed implicitly), ascending
+    std::vector<int> inPolygon(const std::vector<Vertex>& polygon) const
+    {
+        std::vector<int> result;
+        if (polygon.size() < 3) { return result; }
+        Scalar minX = polygon[0].first, maxX = minX, minY = polygon[0].second, maxY = minY;
+        for (const Vertex& v: polygon)
+        {
+            minX = std::min(minX, v.first);
+            maxX = std::max(maxX, v.first);
+            minY = std::min(minY, v.second);
+            maxY = std::max(maxY, v.second);
+        }
+        collect(
+            [&](const Node& node) {
+                if (node.maxX < minX || node.minX > maxX || node.maxY < minY || node.minY > maxY) { return OUTSIDE; }
+                // a box with its corners inside and no polygon edge crossing it is entirely inside
+                if (!containsPoint(polygon, node.minX, node.minY) || !containsPoint(polygon, node.maxX, node.minY)
+                    || !containsPoint(polygon, node.minX, node.maxY) || !containsPoint(polygon, node.maxX, node.maxY))
+                {
+                    return PARTIAL;
+                }
+                for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++)
+                {
+                    if (segmentTouchesBox(polygon[j], polygon[i], node)) { return PARTIAL; }
+                }
+                return INSIDE;
+            },
+            [&](Scalar x, Scalar y) { return containsPoint(polygon, x, y); }, result);
+        return result;
+    }
+
+    // even-odd point in polygon test
+    static bool containsPoint(const std::vector<Vertex>& polygon, Scalar x, Scalar y)
+    {
+        bool inside = false;
+        for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++)
+        {
+            const Vertex& a = polygon[i];
+            const Vertex& b = polygon[j];
+            if ((a.second > y) != (b.second > y) && x < (b.first - a.first) * (y - a.second) / (b.second - a.second) + a.first)
+            {
+                inside = !inside;
+            }
+        }
+        return inside;
+    }
+
+protected:
+    struct Node
+    {
+        Scalar minX, minY, maxX, maxY;
+        int begin, end; // points [begin, end) in leaf order
+        int left, right;// children, -1 for a leaf
+    };
+    enum Overlap { OUTSIDE, PARTIAL, INSIDE };
+
+    std::vector<Scalar> _x;
+    std::vector<Scalar> _y;
+    std::vector<int> _index;// original index of every point in leaf order
+    std::vector<Node> _nodes;
+
+    // while building _x/_y are still in input order and _index is the permutation being partitioned
+    int buildNode(int begin, int end)
+    {
+        Node node = {_x[_index[begin]], _y[_index[begin]], _x[_index[begin]], _y[_index[begin]], begin, end, -1, -1};
+        for (int i = begin; i < end; i++)
+        {
+            node.minX = std::min(node.minX, _x[_index[i]]);
+            node.maxX = std::max(node.maxX, _x[_index[i]]);
+            node.minY = std::min(node.minY, _y[_index[i]]);
+            node.maxY = std::max(node.maxY, _y[_index[i]]);
+        }
+        int id = (int) _nodes.size();
+        _nodes.push_back(node);
+        if (end - begin <= LEAF_SIZE) { return id; }
+
+        const std::vector<Scalar>& axis = node.maxX - node.minX >= node.maxY - node.minY ? _x : _y;
+        int middle = begin + (end - begin) / 2;
+        std::nth_element(_index.begin() + begin, _index.begin() + middle, _index.begin() + end,
+                         [&axis](int a, int b) { return axis[a] < axis[b]; });
+        int left = buildNode(begin, middle);
+        int right = buildNode(middle, end);
+        _nodes[id].left = left;
+        _nodes[id].right = right;
+        return id;
+    }
+
+    // squared distance from (x, y) to the node's bounding box, 0 inside it
+    static Scalar boxDistance(const Node& node, Scalar x, Scalar y)
+    {
+        Scalar dx = x < node.minX ? node.minX - x : (x > node.maxX ? x - node.maxX : 0);
+        Scalar dy = y < node.minY ? node.minY - y : (y > node.maxY ? y - node.maxY : 0);
+        return dx * dx + dy * dy;
+    }
+
+    static bool segmentTouchesBox(const Vertex& a, const Vertex& b, const Node& node)
+    {
+        if (std::max(a.first, b.first) < node.minX || std::min(a.first, b.first) > node.maxX || std::max(a.second, b.second) < node.minY
+            || std::min(a.second, b.second) > node.maxY)
+        {
+            return false;
+        }
+        // the segment's bounding box overlaps the node: it touches it unless all corners are on one side of the line
+        auto side = [&](Scalar x, Scalar y) { return (b.first - a.first) * (y - a.second) - (b.second - a.second) * (x - a.first); };
+        Scalar s1 = side(node.minX, node.minY), s2 = side(node.maxX, node.minY), s3 = side(node.minX, node.maxY), s4 = side(node.maxX, node.maxY);
+        return !((s1 > 0 && s2 > 0 && s3 > 0 && s4 > 0) || (s1 < 0 && s2 < 0 && s3 < 0 && s4 < 0));
+    }
+
+    template <typename NodeTest, typename PointTest>
+    void collect(NodeTest overlap, PointTest contains, std::vector<int>& result) const
+    {
+        if (_nodes.empty()) { return; }
+        std::vector<int> stack = {0};
+        while (!stack.empty())
+        {
+            const Node& node = _nodes[stack.back()];
+            stack.pop_back();
+            Overlap o = overlap(node);
+            if (o == OUTSIDE) { continue; }
+            if (o == INSIDE) { result.insert(result.end(), _index.begin() + node.begin, _index.begin() + node.end); }
+            else if (node.left < 0)
+            {
+                for (int i = node.begin; i < node.end; i++)
+                {
+                    if (contains(_x[i], _y[i])) { result.push_back(_index[i]); }
+                }
+            }
+            else
+            {
+                stack.push_back(node.right);
+                stack.push_back(node.left);
+            }
+        }
+        std::sort(result.begin(), result.end());
+    }
+};
+
+typedef BasicKDTree2D<float> KDTree2D;
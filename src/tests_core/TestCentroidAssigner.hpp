@@ -0,0 +1,119 @@
+// TestCentroidAssigner.hpp
+#pragma once
+#include "../assign_core/CentroidAssigner.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+class TestCentroidAssigner
+{
+public:
+    static void runTests()
+    {
+        std::cout << "\nRunning CentroidAssigner tests..." << std::endl;
+        testPadding();
+        testAssignMatchesBruteForce();
+        testNextNearest();
+        testBatch();
+        testLatencyPercentiles();
+        testLatencyWindow();
+        testEmptyCentroids();
+        std::cout << "All CentroidAssigner tests passed." << std::endl;
+    }
+
+private:
+    static std::vector<Point> createSampleCentroids()
+    {
+        return {Point({0.0, 0.0, 0.0}, 0, 0), Point({5.0, 5.0, 5.0}, 1, 0), Point({10.0, 0.0, 0.0}, 2, 0), Point({0.0, 10.0, 3.0}, 3, 0)};
+    }
+
+    static void testPadding()
+    {
+        CentroidMatrix matrix(createSampleCentroids());
+        assert(matrix.rows() == 4);
+        assert(matrix.dimension() == 3);
+        assert(matrix.stride() == 8);
+        for (int j = 3; j < matrix.stride(); j++) { assert(matrix.row(1)[j] == 0.0); }
+        std::cout << "Test passed: Rows are zero padded." << std::endl;
+    }
+
+    static void testAssignMatchesBruteForce()
+    {
+        std::vector<Point> centroids = createSampleCentroids();
+        CentroidMatrix matrix(centroids);
+        std::vector<Point> queries = {Point({1.0, 1.0, 1.0}), Point({6.0, 4.0, 5.0}), Point({9.0, 1.0, 0.0}), Point({-1.0, 12.0, 2.0})};
+        for (const auto& query: queries)
+        {
+            int expected = 0;
+            for (size_t c = 1; c < centroids.size(); c++)
+            {
+                if (query.calcDist(centroids[c]) < query.calcDist(centroids[expected])) { expected = c; }
+            }
+            Assignment result = matrix.assign(query, 1);
+            assert(result.cluster() == expected);
+            assert(std::abs(result.distance() - query.calcDist(centroids[expected])) < 1e-9);
+        }
+        std::cout << "Test passed: Assignment matches brute force." << std::endl;
+    }
+
+    static void testNextNearest()
+    {
+        CentroidMatrix matrix(createSampleCentroids());
+        Assignment result = matrix.assign(Point({4.0, 4.0, 4.0}), 3);
+        assert(result.nearest.size() == 3);
+        assert(result.cluster() == 1);
+        assert(result.nearest[1].first == 0);
+        for (size_t i = 1; i < result.nearest.size(); i++) { assert(result.nearest[i - 1].second <= result.nearest[i].second); }
+
+        // asking for more neighbors than clusters returns every cluster
+        assert(matrix.assign(Point({4.0, 4.0, 4.0}), 10).nearest.size() == 4);
+        std::cout << "Test passed: Next-nearest clusters." << std::endl;
+    }
+
+    static void testBatch()
+    {
+        CentroidMatrix matrix(createSampleCentroids());
+        std::vector<double> queries(2 * matrix.stride(), 0.0);
+        queries[0] = 9.0;                  // first query  (9, 0, 0)
+        queries[matrix.stride() + 1] = 9.0;// second query (0, 9, 0)
+        std::vector<Assignment> result = matrix.assignBatch(queries.data(), 2, 2);
+        assert(result.size() == 2);
+        assert(result[0].cluster() == 2);
+        assert(result[1].cluster() == 3);
+        std::cout << "Test passed: Batched assignment." << std::endl;
+    }
+
+    static void testLatencyPercentiles()
+    {
+        LatencyStats stats;
+        assert(stats.percentile(50) == 0.0);
+        for (int i = 100; i >= 1; i--) { stats.add(i); }
+        assert(stats.count() == 100);
+        assert(stats.percentile(50) == 50);
+        assert(stats.percentile(99) == 99);
+        assert(stats.percentile(100) == 100);
+        assert(stats.percentile(0) == 1);
+        std::cout << "Test passed: Latency percentiles." << std::endl;
+    }
+
+    // only the last `capacity` samples count for the percentiles
+    static void testLatencyWindow()
+    {
+        LatencyStats stats(10);
+        for (int i = 1; i <= 1000; i++) { stats.add(i); }
+        assert(stats.count() == 1000);
+        assert(stats.percentile(0) == 991);
+        assert(stats.percentile(100) == 1000);
+        std::cout << "Test passed: Latency window." << std::endl;
+    }
+
+    static void testEmptyCentroids()
+    {
+        CentroidMatrix centroids(std::vector<Point>{});
+        double queries[2 * CentroidMatrix::ROW_ALIGNMENT] = {};
+        std::vector<Assignment> result = centroids.assignBatch(queries, 2, 3);
+        assert(result.size() == 2 && result[0].cluster() == -1 && result[1].nearest.empty());
+        std::cout << "Test passed: Empty centroids." << std::endl;
+    }
+};
@@ -3,6 +3,7 @@
 #include "../data_processing/Clusters.hpp"
 #include <cassert>
 #include <iostream>
+#include <random>
 #include <set>
 
 class TestClusterNeighbors {
@@ -14,6 +15,7 @@ public:
         testGetNeighbors4D();
         testDisjointChoose();
         testExtremeCases();
+        testMatchesFullRescan();
         std::cout << "All ClusterNeighbors tests passed." << std::endl;
     }
 
@@ -135,4 +137,40 @@ private:
             std::cout << "Test passed: Extreme case where there are no points in the cluster." << std::endl;
         }
     }
+
+    // getNeighbors keeps each point's distance to the selected ones up to date; the result must be the one of
+    // rescanning every selected neighbor in every round, on sorted copies of the points
+    static void testMatchesFullRescan() {
+        std::mt19937 gen(11);
+        std::normal_distribution<double> noise(0.0, 1.0);
+        std::vector<Point> points;
+        for (int i = 0; i < 500; i++) {
+            points.push_back(Point({noise(gen), noise(gen), noise(gen), noise(gen), noise(gen)}));
+        }
+        Point center({0.5, 0.0, -0.5, 0.0, 0.0});
+        int k = 12;
+
+        std::vector<Point> sortedPoints = points;
+        sortPointsByDistance(center, sortedPoints);
+        std::vector<Point> expected = {sortedPoints[0]};
+        while (expected.size() < k) {
+            double maxMinDist = -1.0;
+            Point bestCandidate;
+            for (const auto& point : sortedPoints) {
+                double minDist = __DBL_MAX__;
+                for (const auto& neighbor : expected) { minDist = std::min(minDist, point.calcDist(neighbor)); }
+                if (minDist > maxMinDist) {
+                    maxMinDist = minDist;
+                    bestCandidate = point;
+                }
+            }
+            expected.push_back(bestCandidate);
+        }
+
+        std::vector<Point> neighbors = getNeighbors(center, points, k);
+        assert(neighbors.size() == expected.size());
+        for (size_t i = 0; i < expected.size(); i++) { assert(neighbors[i].coords == expected[i].coords); }
+
+        std::cout << "Test passed: getNeighbors matches the full rescan." << std::endl;
+    }
 };
\ No newline at end of file
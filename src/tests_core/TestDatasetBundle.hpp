@@ -0,0 +1,116 @@
+// TestDatasetBundle.hpp
+#pragma once
+#include "../data_processing/DatasetBundleBuilder.hpp"
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+class TestDatasetBundle
+{
+public:
+    static void runTests()
+    {
+        std::cout << "\nRunning DatasetBundle tests..." << std::endl;
+        testColumnsRoundTrip();
+        testWithoutProjection();
+        testDetectsCorruption();
+        testRejectsInvalidBuffer();
+        std::cout << "All DatasetBundle tests passed." << std::endl;
+    }
+
+private:
+    static void createBundle(std::vector<char>& buffer, DatasetBundleView& view, bool withProjection)
+    {
+        std::vector<CommentInfo> comments = read_comments_csv("samples/sample_comments.csv");
+        std::vector<Point> clustered = {Point({}, 2, 0.5), Point({}, 0, 1.25), Point({}, -1, 0.0), Point({}, 1, 3.0)};
+        std::vector<Point> projected;
+        if (withProjection)
+        {
+            projected = {Point({1.0, -1.0}, 2, 0), Point({2.5, 0.0}, 0, 0), Point({-3.0, 4.0}, -1, 0), Point({0.0, 0.25}, 1, 0)};
+        }
+        save_dataset_bundle("output/sample.bundle", comments, clustered, projected);
+        load_dataset_bundle("output/sample.bundle", buffer, view);
+    }
+
+    static void testColumnsRoundTrip()
+    {
+        std::vector<char> buffer;
+        DatasetBundleView view;
+        createBundle(buffer, view, true);
+        assert(view.numRows() == 4);
+
+        const double* utc = view.column<double>(BUNDLE_UTC);
+        const float* score = view.column<float>(BUNDLE_SCORE);
+        const float* sentiment = view.column<float>(BUNDLE_SENTIMENT);
+        const int32_t* cluster = view.column<int32_t>(BUNDLE_CLUSTER_ID);
+        const float* distance = view.column<float>(BUNDLE_DISTANCE);
+        const float* x = view.column<float>(BUNDLE_X);
+        const float* y = view.column<float>(BUNDLE_Y);
+        assert(utc && score && sentiment && cluster && distance && x && y);
+        assert(utc[0] == 1661990368.0 && utc[3] == 1661990200.0);
+        assert(score[1] == 40.0f && score[2] == -3.0f);
+        assert(sentiment[1] == -0.9f);
+        assert(cluster[0] == 2 && cluster[2] == -1);
+        assert(distance[1] == 1.25f);
+        assert(x[2] == -3.0f && y[2] == 4.0f && y[3] == 0.25f);
+        // a column read as the wrong type is refused rather than reinterpreted
+        assert(view.column<double>(BUNDLE_SCORE) == nullptr);
+
+        assert(view.hasTexts());
+        assert(view.text(0) == "Plain comment");
+        assert(view.text(1) == "Has, a comma and \"quotes\"");
+        assert(view.text(2) == "Spans\ntwo lines");
+        assert(view.text(3) == "Unquoted");
+        assert(view.text(4).empty());
+        assert(view.textData().size() == view.textOffsets()[4]);
+        std::cout << "Test columns round trip passed." << std::endl;
+    }
+
+    static void testWithoutProjection()
+    {
+        std::vector<char> buffer;
+        DatasetBundleView view;
+        createBundle(buffer, view, false);
+        assert(view.column<float>(BUNDLE_X) == nullptr && view.column<float>(BUNDLE_Y) == nullptr);
+        assert(view.column<int32_t>(BUNDLE_CLUSTER_ID)[3] == 1);
+        assert(view.text(3) == "Unquoted");
+        std::cout << "Test without projection passed." << std::endl;
+    }
+
+    static void testDetectsCorruption()
+    {
+        std::vector<char> buffer;
+        DatasetBundleView view;
+        createBundle(buffer, view, true);
+        uint64_t checksum = view.checksum();
+
+        // one flipped bit in the text passes the structural checks but not the checksum
+        buffer[view.section(BUNDLE_TEXT_DATA)->offset + 3] ^= 0x10;
+        assert(view.open(buffer.data(), buffer.size()));
+        assert(!view.verifyChecksum());
+        buffer[view.section(BUNDLE_TEXT_DATA)->offset + 3] ^= 0x10;
+        assert(view.verifyChecksum() && view.checksum() == checksum);
+        std::cout << "Test detects corruption passed." << std::endl;
+    }
+
+    static void testRejectsInvalidBuffer()
+    {
+        DatasetBundleView view;
+        std::string garbage(64, 'x');
+        assert(!view.open(garbage.data(), garbage.size()));
+        assert(!view.isOpen() && view.numRows() == 0 && view.text(0).empty());
+        assert(view.column<float>(BUNDLE_SCORE) == nullptr);
+
+        std::vector<char> buffer;
+        createBundle(buffer, view, true);
+        assert(!view.open(buffer.data(), buffer.size() - 1));// the text section is cut short
+
+        // text offsets that go backwards
+        createBundle(buffer, view, true);
+        uint64_t* offsets = const_cast<uint64_t*>(view.textOffsets());
+        std::swap(offsets[1], offsets[2]);
+        assert(!view.open(buffer.data(), buffer.size()));
+        std::cout << "Test rejects invalid buffer passed." << std::endl;
+    }
+};
@@ -0,0 +1,127 @@
+// TestHNSWIndex.hpp
+#pragma once
+#include "../index_core/HNSWIndex.hpp"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <vector>
+
+class TestHNSWIndex
+{
+public:
+    static void runTests()
+    {
+        std::cout << "\nRunning HNSWIndex tests..." << std::endl;
+        testEmptyIndex();
+        testExactMatch();
+        testRecallSingleThread();
+        testRecallParallelBuild();
+        testSaveAndMap();
+        std::cout << "All HNSWIndex tests passed." << std::endl;
+    }
+
+private:
+    static std::vector<Point> createRandomPoints(int n, int dim)
+    {
+        std::mt19937 gen(7);
+        std::normal_distribution<double> normal(0.0, 1.0);
+        std::vector<Point> points;
+        for (int i = 0; i < n; i++)
+        {
+            std::vector<double> coords(dim);
+            for (auto& c: coords) { c = normal(gen); }
+            points.push_back(Point(coords));
+        }
+        return points;
+    }
+
+    static std::vector<int> bruteForce(const std::vector<Point>& points, const Point& query, int k)
+    {
+        std::vector<std::pair<double, int>> distances;
+        for (size_t i = 0; i < points.size(); i++) { distances.push_back({query.calcDist(points[i]), (int) i}); }
+        std::sort(distances.begin(), distances.end());
+        std::vector<int> ids;
+        for (int i = 0; i < k; i++) { ids.push_back(distances[i].second); }
+        return ids;
+    }
+
+    static double averageRecall(const HNSWIndex& index, const std::vector<Point>& points, int ef)
+    {
+        double recall = 0;
+        int queries = 0;
+        for (size_t q = 0; q < points.size(); q += 25, queries++)
+        {
+            std::vector<int> expected = bruteForce(points, points[q], 10);
+            for (const auto& hit: index.search(points[q], 10, ef))
+            {
+                if (std::find(expected.begin(), expected.end(), hit.first) != expected.end()) { recall += 0.1; }
+            }
+        }
+        return recall / queries;
+    }
+
+    static void testEmptyIndex()
+    {
+        HNSWIndex index;
+        index.build({});
+        assert(index.size() == 0);
+        assert(index.search(Point({1.0, 2.0}), 5, 10).empty());
+        std::cout << "Test passed: Empty index." << std::endl;
+    }
+
+    static void testExactMatch()
+    {
+        std::vector<Point> points = {Point({0.0, 0.0}), Point({1.0, 1.0}), Point({5.0, 5.0}), Point({9.0, 9.0})};
+        HNSWIndex index(4, 20);
+        index.build(points, 1);
+
+        std::vector<std::pair<int, double>> result = index.search(Point({5.1, 5.0}), 2, 10);
+        assert(result.size() == 2);
+        assert(result[0].first == 2);
+        assert(std::abs(result[0].second - 0.1) < 1e-9);
+        assert(result[0].second <= result[1].second);
+
+        // k larger than the index returns every point
+        assert(index.search(Point({0.0, 0.0}), 10, 10).size() == points.size());
+        std::cout << "Test passed: Exact match." << std::endl;
+    }
+
+    static void testRecallSingleThread()
+    {
+        std::vector<Point> points = createRandomPoints(1000, 8);
+        HNSWIndex index(8, 100);
+        index.build(points, 1);
+        assert(index.size() == points.size());
+        assert(averageRecall(index, points, 64) > 0.9);
+        std::cout << "Test passed: Recall (single thread build)." << std::endl;
+    }
+
+    static void testRecallParallelBuild()
+    {
+        std::vector<Point> points = createRandomPoints(1000, 8);
+        HNSWIndex index(8, 100);
+        index.build(points, 4);
+        assert(averageRecall(index, points, 64) > 0.9);
+        std::cout << "Test passed: Recall (parallel build)." << std::endl;
+    }
+
+    static void testSaveAndMap()
+    {
+        std::vector<Point> points = createRandomPoints(300, 5);
+        HNSWIndex index(8, 50);
+        index.build(points, 2);
+        index.save("output/sample_index.hnsw");
+
+        HNSWIndex mapped;
+        mapped.load("output/sample_index.hnsw");
+        assert(mapped.isMapped());
+        assert(mapped.size() == index.size());
+        assert(mapped.getDimension() == 5);
+        for (size_t q = 0; q < points.size(); q += 30)
+        {
+            assert(mapped.search(points[q], 5, 32) == index.search(points[q], 5, 32));
+        }
+        std::cout << "Test passed: Save and memory-map." << std::endl;
+    }
+};
@@ -0,0 +1,202 @@
+// TestKDTree2D.hpp
+#pragma once
+#include "../clustering_core/modules/kMeansLogic.hpp"
+#include "../index_core/KDTree2D.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+class TestKDTree2D
+{
+public:
+    static void runTests()
+    {
+        std::cout << "\nRunning KDTree2D tests..." << std::endl;
+        testEmptyTree();
+        testNearestMatchesBruteForce();
+        testNearestTiesAndRadius();
+        testRectMatchesBruteForce();
+        testPolygonMatchesBruteForce();
+        testAssignMatchesLinearScan();
+        std::cout << "All KDTree2D tests passed." << std::endl;
+    }
+
+private:
+    static void randomPoints(int count, unsigned seed, std::vector<float>& xs, std::vector<float>& ys)
+    {
+        std::mt19937 gen(seed);
+        std::normal_distribution<float> blob(0.0f, 1.0f);
+        std::uniform_real_distribution<float> center(-20.0f, 20.0f);
+        xs.clear();
+        ys.clear();
+        // a few dense blobs like a t-SNE map, with duplicated points mixed in
+        for (int b = 0; b < 8; b++)
+        {
+            float cx = center(gen), cy = center(gen);
+            for (int i = 0; i < count / 8; i++)
+            {
+                xs.push_back(cx + blob(gen));
+                ys.push_back(cy + blob(gen));
+                if (i % 50 == 0)
+                {
+                    xs.push_back(xs.back());
+                    ys.push_back(ys.back());
+                }
+            }
+        }
+    }
+
+    static int bruteNearest(const std::vector<float>& xs, const std::vector<float>& ys, float x, float y, float maxDistance)
+    {
+        int best = -1;
+        float bestDistance = maxDistance * maxDistance;
+        for (int i = 0; i < (int) xs.size(); i++)
+        {
+            float d = (xs[i] - x) * (xs[i] - x) + (ys[i] - y) * (ys[i] - y);
+            if (d < bestDistance || (d == bestDistance && best < 0))
+            {
+                bestDistance = d;
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    static void testEmptyTree()
+    {
+        KDTree2D tree;
+        assert(tree.size() == 0);
+        assert(tree.nearest(0, 0) == -1);
+        assert(tree.inRect(-1, -1, 1, 1).empty());
+        assert(tree.inPolygon({{-1, -1}, {1, -1}, {0, 1}}).empty());
+        std::cout << "Test empty tree passed." << std::endl;
+    }
+
+    static void testNearestMatchesBruteForce()
+    {
+        std::vector<float> xs, ys;
+        randomPoints(4000, 1, xs, ys);
+        KDTree2D tree(xs, ys);
+        assert(tree.size() == xs.size());
+
+        std::mt19937 gen(2);
+        std::uniform_real_distribution<float> query(-25.0f, 25.0f);
+        for (int q = 0; q < 500; q++)
+        {
+            float x = query(gen), y = query(gen);
+            assert(tree.nearest(x, y) == bruteNearest(xs, ys, x, y, 1e18f));
+            assert(tree.nearest(x, y, 0.5f) == bruteNearest(xs, ys, x, y, 0.5f));
+        }
+        // every point finds itself, or the lower index of its duplicate
+        for (int i = 0; i < (int) xs.size(); i += 7)
+        {
+            int found = tree.nearest(xs[i], ys[i]);
+            assert(found <= i && xs[found] == xs[i] && ys[found] == ys[i]);
+        }
+        std::cout << "Test nearest matches brute force passed." << std::endl;
+    }
+
+    static void testNearestTiesAndRadius()
+    {
+        std::vector<float> xs = {1, -1, 0, 0, 5};
+        std::vector<float> ys = {0, 0, 1, -1, 5};
+        KDTree2D tree(xs, ys);
+        assert(tree.nearest(0, 0) == 0);// four points at distance 1
+        assert(tree.nearest(0, 0, 1.0f) == 0);
+        assert(tree.nearest(0, 0, 0.99f) == -1);
+        assert(tree.nearest(4, 4.5f) == 4);
+        std::cout << "Test nearest ties and radius passed." << std::endl;
+    }
+
+    static void testRectMatchesBruteForce()
+    {
+        std::vector<float> xs, ys;
+        randomPoints(4000, 3, xs, ys);
+        KDTree2D tree(xs, ys);
+
+        std::mt19937 gen(4);
+        std::uniform_real_distribution<float> corner(-25.0f, 25.0f);
+        for (int q = 0; q < 100; q++)
+        {
+            float x0 = corner(gen), x1 = corner(gen), y0 = corner(gen), y1 = corner(gen);
+            float minX = std::min(x0, x1), maxX = std::max(x0, x1), minY = std::min(y0, y1), maxY = std::max(y0, y1);
+            std::vector<int> expected;
+            for (int i = 0; i < (int) xs.size(); i++)
+            {
+                if (xs[i] >= minX && xs[i] <= maxX && ys[i] >= minY && ys[i] <= maxY) { expected.push_back(i); }
+            }
+            assert(tree.inRect(minX, minY, maxX, maxY) == expected);
+        }
+        std::cout << "Test rect matches brute force passed." << std::endl;
+    }
+
+    static void testPolygonMatchesBruteForce()
+    {
+        std::vector<float> xs, ys;
+        randomPoints(4000, 5, xs, ys);
+        KDTree2D tree(xs, ys);
+
+        // a concave star, a thin band crossing the whole map and a self intersecting bow tie
+        std::vector<std::vector<KDTree2D::Vertex>> polygons;
+        std::vector<KDTree2D::Vertex> star;
+        for (int i = 0; i < 10; i++)
+        {
+            float r = i % 2 == 0 ? 18.0f : 4.0f;
+            star.push_back({r * std::cos(i * 0.6283f), r * std::sin(i * 0.6283f)});
+        }
+        polygons.push_back(star);
+        polygons.push_back({{-30, -0.5f}, {30, 0.5f}, {30, 1.5f}, {-30, 0.5f}});
+        polygons.push_back({{-15, -15}, {15, 15}, {15, -15}, {-15, 15}});
+
+        for (const auto& polygon: polygons)
+        {
+            std::vector<int> expected;
+            for (int i = 0; i < (int) xs.size(); i++)
+            {
+                if (KDTree2D::containsPoint(polygon, xs[i], ys[i])) { expected.push_back(i); }
+            }
+            assert(!expected.empty());
+            assert(tree.inPolygon(polygon) == expected);
+        }
+        assert(tree.inPolygon({{0, 0}, {1, 1}}).empty());
+        std::cout << "Test polygon matches brute force passed." << std::endl;
+    }
+
+    static void testAssignMatchesLinearScan()
+    {
+        std::mt19937 gen(6);
+        std::uniform_real_distribution<double> coord(-50.0, 50.0);
+        std::vector<Point> points, centroids;
+        for (int i = 0; i < 3000; i++) { points.push_back(Point({coord(gen), coord(gen)})); }
+        for (int j = 0; j < 200; j++) { centroids.push_back(Point({coord(gen), coord(gen)}, j, 0)); }
+        centroids.push_back(centroids[10]);// a duplicate centroid never wins over the first copy
+
+        std::vector<Point> treePoints = points;
+        int changed = assignPointsToCentroids2D(treePoints, centroids);
+        assert(changed == (int) points.size());
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            double min_dist = __DBL_MAX__;
+            int min_index = -1;
+            for (int j = 0; j < (int) centroids.size(); j++)
+            {
+                double dist = points[i].calcDist(centroids[j]);
+                if (dist < min_dist)
+                {
+                    min_dist = dist;
+                    min_index = j;
+                }
+            }
+            assert(treePoints[i].cluster_id == min_index);
+            assert(treePoints[i].distance == min_dist);
+        }
+        // the general entry point takes the same path for 2D data with many centroids
+        assert(assignPointsToCentroids(points, centroids) == (int) points.size());
+        for (size_t i = 0; i < points.size(); i++) { assert(points[i].cluster_id == treePoints[i].cluster_id); }
+        assert(assignPointsToCentroids2D(treePoints, centroids) == 0);
+        std::cout << "Test assign matches linear scan passed." << std::endl;
+    }
+};
@@ -1,6 +1,12 @@
 #include "../clustering_core/KmeansND.hpp"
+#include "../clustering_core/modules/parallel.hpp"
+#include <atomic>
 #include <cassert>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <random>
+#include <string>
 #include <vector>
 
 class TestKMeansND
@@ -18,6 +24,15 @@ public:
         testClustering3D();
         testCentroidCalculation3D();
         testCentroidCalculation3DComplex();
+        testIncrementalRunningMean();
+        testIncrementalDriftRecluster();
+        testIncrementalCountsRoundTrip();
+        testIncrementalDriftAcrossReloads();
+        testIterationMetrics();
+        testReproducibleAcrossThreads();
+        testWorkerPool();
+        testCheckpointRoundTrip();
+        testCheckpointResume();
         std::cout << "All KMeansND tests passed." << std::endl;
     }
 
@@ -327,6 +342,310 @@ private:
         std::cout << "Test Passed: testCentroidCalculation3DComplex" << std::endl;
     }
 
+    static void testIncrementalRunningMean()
+    {
+        KMeansND kmeans(2, 100);
+        kmeans.setCentroids({Point({0.0, 0.0}, 0, 0), Point({10.0, 10.0}, 1, 0)});
+        kmeans.loadClusterCounts("samples/sample_counts.csv");// 2 points in cluster 0, 3 in cluster 1
+
+        // new points close to the existing centroids: centroids move by the running mean only
+        bool reclustered = kmeans.ClusterIncremental({Point({3.0, 0.0}), Point({10.0, 14.0})}, 5.0);
+        assert(!reclustered);
+
+        std::vector<Point> centroids = kmeans.getCentroids();
+        assert(std::abs(centroids[0].coords[0] - 1.0) < 1e-9);// (0 * 2 + 3) / 3
+        assert(std::abs(centroids[1].coords[1] - 11.0) < 1e-9);// (10 * 3 + 14) / 4
+        assert(kmeans.getClusterCounts() == std::vector<int>({3, 4}));
+        assert(kmeans.getPoints().size() == 2);
+        assert(kmeans.getPoints()[0].cluster_id == 0);
+        assert(kmeans.getPoints()[1].cluster_id == 1);
+        assert(std::abs(kmeans.getCentroidDrift() - 1.0) < 1e-9);
+        std::cout << "Test Passed: testIncrementalRunningMean" << std::endl;
+    }
+
+    static void testIncrementalDriftRecluster()
+    {
+        std::vector<Point> points = {
+                Point({1.0, 2.0}), Point({1.5, 1.8}),
+                Point({2.0, 2.0}), Point({1.8, 1.5}),
+                Point({5.0, 5.0}), Point({5.5, 4.8}),
+                Point({5.0, 5.5}), Point({4.8, 5.2})};
+        KMeansND kmeans(2, 100, points);
+        kmeans.Cluster(false);
+        assert(kmeans.getCentroidDrift() == 0.0);
+
+        // a far away group pulls one centroid beyond the threshold and forces a full re-iteration
+        std::vector<Point> newPoints = {Point({20.0, 20.0}), Point({20.5, 20.0}), Point({20.0, 20.5}), Point({20.5, 20.5})};
+        bool reclustered = kmeans.ClusterIncremental(newPoints, 1.0);
+        assert(reclustered);
+        assert(kmeans.getPoints().size() == points.size() + newPoints.size());
+        assert(kmeans.getCentroidDrift() == 0.0);
+
+        std::vector<int> counts = kmeans.getClusterCounts();
+        assert(counts[0] + counts[1] == 12);
+        std::map<int, int> sizes = kmeans.getClustersSize();
+        assert(sizes[0] == counts[0] && sizes[1] == counts[1]);
+        std::cout << "Test Passed: testIncrementalDriftRecluster" << std::endl;
+    }
+
+    static void testIncrementalCountsRoundTrip()
+    {
+        std::vector<int> counts = {4, 0, 7};
+        save_cluster_counts("output/sample_counts.csv", counts);
+        assert(read_cluster_counts("output/sample_counts.csv") == counts);
+        assert(read_cluster_anchors("output/sample_counts.csv").empty());
+
+        std::vector<Point> anchors = {Point({0.1, 1.0 / 3}, 0, 0), Point({2.0, -4.5}, 1, 0), Point({1e-7, 3.0}, 2, 0)};
+        save_cluster_counts("output/sample_counts.csv", counts, anchors);
+        assert(read_cluster_counts("output/sample_counts.csv") == counts);
+        std::vector<Point> readAnchors = read_cluster_anchors("output/sample_counts.csv");
+        assert(readAnchors.size() == 3);
+        for (int i = 0; i < 3; i++) { assert(readAnchors[i].coords == anchors[i].coords && readAnchors[i].cluster_id == i); }
+        std::cout << "Test Passed: testIncrementalCountsRoundTrip" << std::endl;
+    }
+
+    // the drift of several daily runs adds up, because the anchors are saved with the counts and not reset on reload
+    static void testIncrementalDriftAcrossReloads()
+    {
+        std::vector<Point> points = {Point({0.0, 0.0}), Point({0.0, 1.0}), Point({1.0, 0.0}), Point({1.0, 1.0}),
+                                     Point({10.0, 10.0}), Point({10.0, 11.0}), Point({11.0, 10.0}), Point({11.0, 11.0})};
+        KMeansND first(2, 100, points);
+        first.Cluster(false);
+        first.setCentroidsPath("output/drift_centroids.csv");
+        first.setResultPath("output/drift_result.csv");
+        first.setCountsPath("output/drift_counts.csv");
+        first.save();
+
+        // every day moves a centroid by less than the threshold, the total is more
+        double total = 0;
+        bool reclustered = false;
+        for (int day = 0; day < 4 && !reclustered; day++)
+        {
+            KMeansND daily(2, 100);
+            daily.setCentroids(read_data("output/drift_centroids.csv"));
+            daily.loadClusterCounts("output/drift_counts.csv");
+            double before = daily.getCentroidDrift();
+            assert(std::abs(before - total) < 1e-4);// centroids are saved with 6 digits
+            std::vector<Point> centroids = daily.getCentroids();
+            int far = centroids[0].coords[0] > 5 ? 0 : 1;
+            Point newPoint = centroids[far];
+            newPoint.coords[0] += 6.0;
+            reclustered = daily.ClusterIncremental({newPoint}, 2.5);
+            total = daily.getCentroidDrift();
+            assert(reclustered || total > before);
+            daily.setCentroidsPath("output/drift_centroids.csv");
+            daily.setResultPath("output/drift_result.csv");
+            daily.save();
+        }
+        assert(reclustered);
+        std::cout << "Test Passed: testIncrementalDriftAcrossReloads" << std::endl;
+    }
+
+    static void testIterationMetrics()
+    {
+        std::vector<Point> points = {Point({1.0, 2.0}), Point({1.5, 1.8}), Point({2.0, 2.0}), Point({1.8, 1.5}), Point({5.0, 5.0}),
+                                     Point({5.5, 4.8}), Point({5.0, 5.5}), Point({4.8, 5.2}), Point({2.5, 2.0}), Point({2.0, 2.5})};
+        KMeansND kmeans(2, 100);
+        kmeans.setPoints(points);
+        kmeans.setCentroids({Point({1.0, 2.0}), Point({1.5, 1.8})});// a poor start that needs a few iterations
+        kmeans.setMetricsPath("output/metrics.jsonl");
+        kmeans.Cluster(false);
+
+        std::vector<IterationMetrics> metrics = kmeans.getIterationMetrics();
+        assert(metrics.size() >= 2);
+        assert(metrics[0].iteration == 0 && metrics[0].updateSeconds == 0 && metrics[0].centroidShift == 0);
+        assert(metrics[0].pointsChanged == (int) points.size());
+        assert(metrics[0].bytesRead == points.size() * 2 * sizeof(double));
+        assert(metrics.back().pointsChanged == 0);
+        for (size_t i = 0; i < metrics.size(); i++)
+        {
+            assert(metrics[i].run == 0 && metrics[i].iteration == (int) i);
+            assert(metrics[i].distanceEvaluations == (long long) points.size() * 2 + (i > 0 ? 2 : 0));
+            assert(metrics[i].seconds >= metrics[i].assignSeconds);
+            // Lloyd's iterations never increase the inertia
+            if (i > 0) { assert(metrics[i].inertia <= metrics[i - 1].inertia + 1e-9 && metrics[i].centroidShift > 0); }
+        }
+        assert(metrics[1].bytesRead == 2 * metrics[0].bytesRead);
+
+        // the last inertia is the one of the final assignment
+        double inertia = 0;
+        std::vector<Point> centroids = kmeans.getCentroids();
+        for (const Point& point: kmeans.getPoints())
+        {
+            double dist = point.calcDist(centroids[point.cluster_id]);
+            inertia += dist * dist;
+        }
+        assert(std::abs(metrics.back().inertia - inertia) < 1e-9);
+
+        // one JSON line per iteration; a second run appends its own
+        kmeans.Cluster(false);
+        assert(kmeans.getIterationMetrics().size() == 1 && kmeans.getIterationMetrics()[0].run == 1);
+        std::ifstream file("output/metrics.jsonl");
+        std::string line, last;
+        size_t lines = 0;
+        while (std::getline(file, line))
+        {
+            assert(line.front() == '{' && line.back() == '}');
+            assert(line.find("\"peak_rss_bytes\": ") != std::string::npos);
+            last = line;
+            lines++;
+        }
+        assert(lines == metrics.size() + 1);
+        assert(last.find("\"run\": 1, \"iteration\": 0") != std::string::npos);
+        std::cout << "Test Passed: testIterationMetrics" << std::endl;
+    }
+
+    static void testReproducibleAcrossThreads()
+    {
+        // several blocks of points, so the threads really split the work
+        std::mt19937 gen(3);
+        std::normal_distribution<double> noise(0.0, 1.0);
+        std::vector<Point> points, points2D;
+        for (int i = 0; i < 30000; i++)
+        {
+            std::vector<double> coords(8);
+            for (int j = 0; j < 8; j++) { coords[j] = noise(gen) + 4.0 * ((i + j) % 5); }
+            points.push_back(Point(coords));
+            points2D.push_back(Point({coords[0], coords[1]}));
+        }
+
+        auto run = [](const std::vector<Point>& points, int k, int threads, bool reproducible) {
+            KMeansND kmeans(k, 20);
+            kmeans.setThreads(threads);
+            kmeans.setReproducible(reproducible);
+            kmeans.setSeed(7);
+            kmeans.setPoints(points);
+            kmeans.Cluster(false);
+            return kmeans;
+        };
+        // 8 dimensions with the linear scan, 2 dimensions with k >= 64 through the k-d tree
+        for (auto [data, k]: {std::make_pair(&points, 5), std::make_pair(&points2D, KDTREE_MIN_CENTROIDS)})
+        {
+            KMeansND reference = run(*data, k, 1, true);
+            std::vector<Point> referencePoints = reference.getPoints();
+            for (int threads: {2, 3, 8})
+            {
+                KMeansND kmeans = run(*data, k, threads, true);
+                std::vector<Point> clustered = kmeans.getPoints();
+                for (int i = 0; i < k; i++) { assert(kmeans.getCentroids()[i].coords == reference.getCentroids()[i].coords); }
+                for (size_t i = 0; i < clustered.size(); i++) { assert(clustered[i].cluster_id == referencePoints[i].cluster_id); }
+                assert(kmeans.getIterationMetrics().size() == reference.getIterationMetrics().size());
+                assert(kmeans.getIterationMetrics().back().inertia == reference.getIterationMetrics().back().inertia);
+            }
+
+            // one leaf per thread rounds differently, but only in the last bits
+            KMeansND fast = run(*data, k, 3, false);
+            double inertia = reference.getIterationMetrics().back().inertia;
+            assert(std::abs(fast.getIterationMetrics().back().inertia - inertia) <= 1e-6 * inertia);
+        }
+        std::cout << "Test Passed: testReproducibleAcrossThreads" << std::endl;
+    }
+
+    static void testWorkerPool()
+    {
+        // many short loops on the same threads, every index runs exactly once per loop
+        WorkerPool pool(4);
+        assert(pool.threads() == 4);
+        for (size_t count: {0, 1, 3, 100, 5000})
+        {
+            for (int loop = 0; loop < 50; loop++)
+            {
+                std::vector<std::atomic<int>> visits(count);
+                pool.run(count, [&](size_t i) { visits[i]++; });
+                for (const auto& visit: visits) { assert(visit == 1); }
+            }
+        }
+        std::cout << "Test Passed: testWorkerPool" << std::endl;
+    }
+
+    static void testCheckpointRoundTrip()
+    {
+        KMeansCheckpoint state;
+        state.run = 2;
+        state.iteration = 5;
+        state.pointsChanged = 3;
+        state.seed = 1234567u;
+        state.k = 2;
+        state.dim = 3;
+        state.pointsHash = 0x0123456789abcdefULL;
+        state.centroids = {0.5, -1.25, 3.0, 1e-300, 7.0, -0.0};
+        state.distances = {0.1, 0.2, 0.3, 0.4};
+        state.labels = {0, 1, 1, -1};
+        save_checkpoint("output/roundtrip.checkpoint", state);
+
+        KMeansCheckpoint read = read_checkpoint("output/roundtrip.checkpoint");
+        assert(read.run == 2 && read.iteration == 5 && read.pointsChanged == 3 && read.seed == 1234567u);
+        assert(read.k == 2 && read.dim == 3 && read.pointsHash == state.pointsHash);
+        assert(read.centroids == state.centroids && read.distances == state.distances && read.labels == state.labels);
+        assert(!std::filesystem::exists("output/roundtrip.checkpoint.tmp"));
+
+        // a file that can not be written is reported, not fatal, so the writer thread can hand it on
+        std::string error;
+        assert(!try_save_checkpoint("output/missing_dir/roundtrip.checkpoint", state, &error) && !error.empty());
+
+        // the fingerprint sees a changed coordinate and a changed order
+        std::vector<Point> points = {Point({1.0, 2.0}), Point({3.0, 4.0})};
+        std::vector<Point> changed = {Point({1.0, 2.0}), Point({3.0, 4.5})};
+        std::vector<Point> swapped = {Point({3.0, 4.0}), Point({1.0, 2.0})};
+        assert(pointsFingerprint(points) == pointsFingerprint(std::vector<Point>(points)));
+        assert(pointsFingerprint(points) != pointsFingerprint(changed) && pointsFingerprint(points) != pointsFingerprint(swapped));
+        std::cout << "Test Passed: testCheckpointRoundTrip" << std::endl;
+    }
+
+    static void testCheckpointResume()
+    {
+        std::mt19937 gen(11);
+        std::normal_distribution<double> noise(0.0, 2.0);
+        std::vector<Point> points;
+        for (int i = 0; i < 5000; i++) { points.push_back(Point({noise(gen) + 3.0 * (i % 4), noise(gen), noise(gen) - 2.0 * (i % 3)})); }
+
+        KMeansND full(6, 500);
+        full.setSeed(5);
+        full.setPoints(points);
+        full.Cluster(false);
+        size_t iterations = full.getIterationMetrics().size() - 1;
+        assert(iterations > 3 && full.getIterationMetrics().back().pointsChanged == 0);
+
+        // a run stopped after 3 iterations leaves its last state in the checkpoint
+        KMeansND interrupted(6, 3);
+        interrupted.setSeed(5);
+        interrupted.setPoints(points);
+        interrupted.setCheckpointPath("output/resume.checkpoint", 2);
+        interrupted.Cluster(false);
+        KMeansCheckpoint state = read_checkpoint("output/resume.checkpoint");
+        assert(state.iteration == 3 && state.seed == 5 && state.labels.size() == points.size());
+
+        // a fresh object with another seed picks up the state and ends exactly like the uninterrupted run
+        KMeansND resumed(6, 500);
+        resumed.setSeed(99);
+        resumed.setPoints(points);
+        resumed.resume("output/resume.checkpoint");
+        assert(resumed.getSeed() == 5);
+        resumed.setMetricsPath("output/resume.metrics.jsonl");
+        resumed.setCheckpointPath("output/resume.checkpoint");
+        resumed.Cluster(false);
+        std::vector<IterationMetrics> metrics = resumed.getIterationMetrics();
+        assert(metrics.size() == iterations - 3 && metrics[0].iteration == 4);
+
+        std::vector<Point> fullPoints = full.getPoints(), resumedPoints = resumed.getPoints();
+        for (int i = 0; i < 6; i++) { assert(resumed.getCentroids()[i].coords == full.getCentroids()[i].coords); }
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            assert(resumedPoints[i].cluster_id == fullPoints[i].cluster_id);
+            assert(resumedPoints[i].distance == fullPoints[i].distance);
+        }
+
+        // the checkpoint of a finished run resumes to the same result without iterating
+        assert(read_checkpoint("output/resume.checkpoint").pointsChanged == 0);
+        KMeansND finished(6, 500);
+        finished.setPoints(points);
+        finished.resume("output/resume.checkpoint");
+        finished.Cluster(false);
+        assert(finished.getIterationMetrics().empty());
+        for (int i = 0; i < 6; i++) { assert(finished.getCentroids()[i].coords == full.getCentroids()[i].coords); }
+        std::cout << "Test Passed: testCheckpointResume" << std::endl;
+    }
+
     static void testExpectedClustering(const std::vector<Point> points, const std::vector<int> expectedClusterIds)
     {
         std::vector<int> ClusterIds(points.size(), -1);
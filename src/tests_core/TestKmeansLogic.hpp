@@ -2,6 +2,7 @@
 #include "../clustering_core/modules/kMeansLogic.hpp"
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <iostream>
 #include <set>
 // Prototype of the function to be tested
@@ -16,6 +17,7 @@ public:
         testReturnsCorrectNumberOfCentroids();
         testCentroidsAreUnique();
         testCentroidsAreFromInputPoints();
+        testSeededCentroidsRepeat();
         std::cout << "All tests for initialize_random_centroids passed.\n"
                   << std::endl;
     }
@@ -75,6 +77,17 @@ protected:
         }
         std::cout << "Test passed: Centroids are from input points." << std::endl;
     }
+
+    static void testSeededCentroidsRepeat()
+    {
+        std::vector<Point> points;
+        for (int i = 0; i < 100; i++) { points.push_back(Point({(double) i, (double) -i})); }
+        auto first = initialize_random_centroids(points, 10, 42);
+        auto second = initialize_random_centroids(points, 10, 42);
+        assert(first.size() == 10);
+        for (int i = 0; i < first.size(); i++) { assert(first[i].coords == second[i].coords); }
+        std::cout << "Test passed: Seeded centroids repeat." << std::endl;
+    }
 };
 
 
@@ -86,6 +99,7 @@ public:
         std::cout << "Running tests for recalculateCentroids..." << std::endl;
         testRecalculateCentroids2D();
         testRecalculateCentroids3D();
+        testRecalculateCentroidsBlocks();
         std::cout << "All tests for recalculateCentroids passed.\n"
                   << std::endl;
     }
@@ -145,6 +159,37 @@ private:
 
         std::cout << "Test passed: recalculateCentroids3D" << std::endl;
     }
+
+    // more points than one block: every thread count gives the same bits, and the mean of the points
+    static void testRecalculateCentroidsBlocks()
+    {
+        std::vector<Point> points;
+        std::vector<double> sums(6, 0.0), counts(3, 0.0);
+        for (int i = 0; i < 3 * (int) KMEANS_BLOCK_SIZE + 17; i++)
+        {
+            int cluster = (i * 7) % 3;
+            points.push_back(Point({0.1 * (i % 97), 1.0 / (i + 1)}, cluster));
+            sums[cluster * 2] += points.back().coords[0];
+            sums[cluster * 2 + 1] += points.back().coords[1];
+            counts[cluster]++;
+        }
+        std::vector<Point> reference = {Point({0, 0}), Point({0, 0}), Point({0, 0}), Point({0, 0})};
+        recalculateCentroids(points, reference, KMeansParallel{1, true});
+        for (int threads: {2, 3, 8})
+        {
+            std::vector<Point> centroids = {Point({0, 0}), Point({0, 0}), Point({0, 0}), Point({0, 0})};
+            recalculateCentroids(points, centroids, KMeansParallel{threads, true});
+            for (int i = 0; i < 4; i++) { assert(centroids[i].coords == reference[i].coords); }
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            assert(std::abs(reference[i].coords[0] - sums[i * 2] / counts[i]) < 1e-9);
+            assert(std::abs(reference[i].coords[1] - sums[i * 2 + 1] / counts[i]) < 1e-9);
+        }
+        // a centroid without points goes to the origin
+        assert(reference[3].coords[0] == 0 && reference[3].coords[1] == 0);
+        std::cout << "Test passed: recalculateCentroidsBlocks" << std::endl;
+    }
 };
 
 class TestAssignPointsToCentroids
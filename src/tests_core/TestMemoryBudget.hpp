@@ -0,0 +1,125 @@
+// TestMemoryBudget.hpp
+#pragma once
+#include "../clustering_core/KmeansND.hpp"
+#include "../clustering_core/include/npy.hpp"
+#include "../clustering_core/modules/memoryBudget.hpp"
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+class TestMemoryBudget
+{
+public:
+    static void runTests()
+    {
+        std::cout << "\nRunning MemoryBudget tests..." << std::endl;
+        size_t limit = MemoryBudget::limit();
+        testReservations();
+        testStageReports();
+        testKMeansAccounting();
+        testChunkedNpyRead();
+        MemoryBudget::setLimit(limit);
+        std::cout << "All MemoryBudget tests passed." << std::endl;
+    }
+
+private:
+    static const size_t MB = 1 << 20;
+
+    static void testReservations()
+    {
+        size_t before = MemoryBudget::used();
+        MemoryBudget::setLimit(before + 10 * MB);
+        {
+            MemoryReservation points("points", 4 * MB);
+            assert(MemoryBudget::used() == before + 4 * MB && MemoryBudget::available() == 6 * MB);
+            assert(MemoryBudget::fits(6 * MB) && !MemoryBudget::fits(7 * MB));
+
+            // a reservation that is not required is counted even beyond the budget
+            MemoryReservation labels("labels", 8 * MB, false);
+            assert(MemoryBudget::used() == before + 12 * MB && MemoryBudget::available() == 0);
+            labels.release();
+            assert(labels.bytes() == 0 && MemoryBudget::used() == before + 4 * MB);
+
+            MemoryReservation moved = std::move(points);
+            assert(points.bytes() == 0 && moved.bytes() == 4 * MB && MemoryBudget::used() == before + 4 * MB);
+        }
+        assert(MemoryBudget::used() == before);
+        MemoryBudget::setLimit(0);
+        assert(MemoryBudget::fits((size_t) 1 << 60));
+        std::cout << "Test Passed: testReservations" << std::endl;
+    }
+
+    static void testStageReports()
+    {
+        clearMemoryStageReports();
+        size_t before = MemoryBudget::used();
+        {
+            MemoryStage outer("outer");
+            MemoryReservation first("first", 3 * MB);
+            {
+                MemoryStage inner("inner");
+                inner.setStrategy("in place");
+                MemoryReservation second("second", 2 * MB);
+            }
+            MemoryReservation third("third", 1 * MB);
+        }
+        std::vector<MemoryStageReport> reports = memoryStageReports();
+        assert(reports.size() == 2);
+        // stages report when they close: the inner one first, its peak includes what was reserved before it
+        assert(reports[0].stage == "inner" && reports[0].strategy == "in place" && reports[0].peakBytes == before + 5 * MB);
+        assert(reports[1].stage == "outer" && reports[1].strategy.empty() && reports[1].peakBytes == before + 5 * MB);
+        std::string report = memoryReport();
+        assert(report.find("| inner | in place | ") != std::string::npos && report.find("| outer | - | ") != std::string::npos);
+        clearMemoryStageReports();
+        std::cout << "Test Passed: testStageReports" << std::endl;
+    }
+
+    static void testKMeansAccounting()
+    {
+        size_t before = MemoryBudget::used();
+        std::vector<Point> points;
+        for (int i = 0; i < 1000; i++) { points.push_back(Point({(double) (i % 10), (double) (i / 10), 1.0})); }
+        {
+            KMeansND kmeans(4, 10, points);
+            assert(MemoryBudget::used() >= before + pointsBytes(points.size(), 3));
+            kmeans.ClusterIncremental({Point({1.0, 2.0, 3.0})}, 1e9);
+            assert(MemoryBudget::used() >= before + pointsBytes(points.size() + 1, 3));
+        }
+        assert(MemoryBudget::used() == before);
+        std::cout << "Test Passed: testKMeansAccounting" << std::endl;
+    }
+
+    static void testChunkedNpyRead()
+    {
+        const size_t rows = 5000, dim = 16;
+        std::string path = "output/memory_budget.npy";
+        npy::npy_data<double> file;
+        file.shape = {rows, dim};
+        std::mt19937 gen(3);
+        std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+        for (size_t i = 0; i < rows * dim; i++) { file.data.push_back(uniform(gen)); }
+        npy::write_npy(path, file);
+
+        clearMemoryStageReports();
+        MemoryBudget::setLimit(0);
+        std::vector<Point> whole = read_data(path);
+        // room for the points and 64 kB more: the file is read in chunks of (64 kB / 2) / 128 bytes = 256 rows
+        MemoryBudget::setLimit(MemoryBudget::used() + pointsBytes(rows, dim) + 64 * 1024);
+        std::vector<Point> chunked = read_data(path);
+
+        assert(whole.size() == rows && chunked.size() == rows);
+        for (size_t i = 0; i < rows; i++)
+        {
+            assert(whole[i].coords == chunked[i].coords);
+            assert(whole[i].coords[5] == file.data[i * dim + 5]);
+        }
+        std::vector<MemoryStageReport> reports = memoryStageReports();
+        assert(reports.size() == 2 && reports[0].stage == "reading memory_budget.npy");
+        assert(reports[0].strategy == "whole file" && reports[1].strategy == "chunks of 256 rows");
+        assert(reports[1].peakBytes <= reports[1].limitBytes && reports[1].peakBytes < reports[0].peakBytes);
+        clearMemoryStageReports();
+        std::cout << "Test Passed: testChunkedNpyRead" << std::endl;
+    }
+};
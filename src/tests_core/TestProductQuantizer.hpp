@@ -0,0 +1,129 @@
+// TestProductQuantizer.hpp
+#pragma once
+#include "../data_processing/ProductQuantizer.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+class TestProductQuantizer
+{
+public:
+    static void runTests()
+    {
+        std::cout << "\nRunning ProductQuantizer tests..." << std::endl;
+        testSubspaceSplit();
+        testEncodeDecode();
+        testAsymmetricDistance();
+        testSearch();
+        testSaveLoad();
+        testTrainSampleSize();
+        std::cout << "All ProductQuantizer tests passed." << std::endl;
+    }
+
+private:
+    // 4 well separated groups in 4D, every subspace (2D) sees two groups
+    static std::vector<Point> createSampleData()
+    {
+        std::vector<Point> points;
+        for (int i = 0; i < 5; i++)
+        {
+            double eps = 0.01 * i;
+            points.push_back(Point({0.0 + eps, 0.0, 0.0 + eps, 0.0}));
+            points.push_back(Point({10.0 + eps, 10.0, 0.0 + eps, 0.0}));
+            points.push_back(Point({0.0 + eps, 0.0, 10.0 + eps, 10.0}));
+            points.push_back(Point({10.0 + eps, 10.0, 10.0 + eps, 10.0}));
+        }
+        return points;
+    }
+
+    static void testSubspaceSplit()
+    {
+        ProductQuantizer pq(10, 3, 4);
+        assert(pq.getCodeSize() == 3);
+        assert(pq.getNumSubspaces() == 3);
+        assert(!pq.isTrained());
+        std::cout << "Test passed: Subspace split." << std::endl;
+    }
+
+    static void testEncodeDecode()
+    {
+        std::vector<Point> points = createSampleData();
+        ProductQuantizer pq(4, 2, 2);
+        pq.train(points);
+        assert(pq.isTrained());
+
+        PQCodes codes = pq.encodeAll(points);
+        assert(codes.size() == points.size());
+        assert(codes.codes.size() == points.size() * 2);
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            // reconstruction error is bounded by the spread inside a group
+            assert(pq.decode(codes[i]).calcDist(points[i]) < 0.1);
+            assert(pq.encode(points[i]) == std::vector<uint8_t>(codes[i], codes[i] + 2));
+        }
+        std::cout << "Test passed: Encode and decode." << std::endl;
+    }
+
+    static void testAsymmetricDistance()
+    {
+        std::vector<Point> points = createSampleData();
+        ProductQuantizer pq(4, 2, 2);
+        pq.train(points);
+        PQCodes codes = pq.encodeAll(points);
+
+        Point query({3.0, 1.0, 7.0, 9.0});
+        std::vector<double> table = pq.distanceTable(query);
+        for (size_t i = 0; i < codes.size(); i++)
+        {
+            // table lookups must equal the exact distance to the reconstructed point
+            assert(std::abs(pq.asymmetricDistance(table, codes[i]) - query.calcDist(pq.decode(codes[i]))) < 1e-9);
+        }
+        std::cout << "Test passed: Asymmetric distance." << std::endl;
+    }
+
+    static void testSearch()
+    {
+        std::vector<Point> points = createSampleData();
+        ProductQuantizer pq(4, 2, 2);
+        pq.train(points);
+        PQCodes codes = pq.encodeAll(points);
+
+        std::vector<std::pair<int, double>> result = pq.search(Point({10.0, 10.0, 0.0, 0.0}), codes, 5);
+        assert(result.size() == 5);
+        for (const auto& hit: result)
+        {
+            assert(points[hit.first].coords[0] >= 10.0 && points[hit.first].coords[2] < 1.0);
+        }
+        for (size_t i = 1; i < result.size(); i++) { assert(result[i - 1].second <= result[i].second); }
+        std::cout << "Test passed: Search." << std::endl;
+    }
+
+    static void testSaveLoad()
+    {
+        std::vector<Point> points = createSampleData();
+        ProductQuantizer pq(4, 2, 2);
+        pq.train(points);
+        pq.save("output/pq_codebook.bin");
+
+        ProductQuantizer loaded;
+        loaded.load("output/pq_codebook.bin");
+        assert(loaded.getDimension() == 4);
+        assert(loaded.getNumSubspaces() == 2);
+        assert(loaded.getNumCentroids() == 2);
+        for (const auto& point: points) { assert(loaded.encode(point) == pq.encode(point)); }
+        std::cout << "Test passed: Save and load codebooks." << std::endl;
+    }
+
+    // the sample has exactly the requested size: with fewer points than centroids, the codebook shrinks to it
+    static void testTrainSampleSize()
+    {
+        std::vector<Point> points;
+        for (int i = 0; i < 100; i++) { points.push_back(Point({(double) i, (double) (i % 7)})); }
+        ProductQuantizer pq(2, 1, 256);
+        pq.setTrainSampleSize(30);
+        pq.train(points);
+        assert(pq.getNumCentroids() == 30);
+        std::cout << "Test passed: Train sample size." << std::endl;
+    }
+};
@@ -0,0 +1,88 @@
+// TestProgress.hpp
+#pragma once
+#include "../clustering_core/modules/progress.hpp"
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TestProgress
+{
+public:
+    static void runTests()
+    {
+        std::cout << "\nRunning Progress tests..." << std::endl;
+        testFormatting();
+        testThreadsAndFinalLine();
+        testQuietStages();
+        std::cout << "All Progress tests passed." << std::endl;
+    }
+
+private:
+    static void testFormatting()
+    {
+        assert(Progress::formatCount(850) == "850");
+        assert(Progress::formatCount(12345) == "12.3k");
+        assert(Progress::formatCount(850000) == "850k");
+        assert(Progress::formatCount(1.2e6) == "1.2M");
+        assert(Progress::formatDuration(2.06) == "2.1s");
+        assert(Progress::formatDuration(125) == "2m05s");
+        assert(Progress::formatDuration(3720) == "1h02m");
+
+        Progress progress("stage", 200, 0);
+        progress.add(50, 4000);
+        assert(progress.status(2.0) == "50 / 200 rows (25%), 25 rows/s, 0 MB/s, ETA 6.0s");
+        progress.finish();
+        std::cout << "Test Passed: testFormatting" << std::endl;
+    }
+
+    static void testThreadsAndFinalLine()
+    {
+        std::ostringstream output;
+        Progress::setOutput(&output);
+        Progress::setInterval(0);
+        {
+            Progress progress("parallel stage", 4000);
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 4; t++)
+            {
+                threads.emplace_back([&progress]() {
+                    for (int i = 0; i < 1000; i++) { progress.add(1, 8); }
+                });
+            }
+            for (auto& thread: threads) { thread.join(); }
+            assert(progress.rows() == 4000 && progress.bytes() == 32000);
+        }
+        std::string text = output.str();
+        assert(text.rfind("parallel stage: ", 0) == 0);
+        assert(text.find("4k / 4k rows (100%)") != std::string::npos && text.find("done in") != std::string::npos);
+        Progress::setOutput(nullptr);
+        Progress::setInterval(1);
+        std::cout << "Test Passed: testThreadsAndFinalLine" << std::endl;
+    }
+
+    static void testQuietStages()
+    {
+        std::ostringstream output;
+        Progress::setOutput(&output);
+        {
+            // shorter than the interval: nothing, not even the last line
+            Progress progress("short stage", 10);
+            for (int i = 0; i < 10; i++) { progress.add(1); }
+            assert(!progress.printed());
+        }
+        Progress::setInterval(0);
+        Progress::setEnabled(false);
+        {
+            Progress progress("silenced stage", 10);
+            for (int i = 0; i < 10; i++) { progress.add(1); }
+        }
+        assert(output.str().empty());
+        Progress::setEnabled(true);
+        Progress::setInterval(1);
+        Progress::setOutput(nullptr);
+        std::cout << "Test Passed: testQuietStages" << std::endl;
+    }
+};
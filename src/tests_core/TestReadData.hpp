@@ -1,6 +1,6 @@
 #pragma once
 
-#include "../clustering_core/modules/readData.hpp"// Include the header file for the read_data function
+#include "../clustering_core/modules/ReadData.hpp"// Include the header file for the read_data function
 #include <cassert>
 #include <filesystem>
 #include <iostream>
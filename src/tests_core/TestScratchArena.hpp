@@ -0,0 +1,111 @@
+// TestScratchArena.hpp
+#pragma once
+#include "../clustering_core/modules/scratchArena.hpp"
+#include "../clustering_core/modules/structPoint.hpp"
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class TestScratchArena
+{
+public:
+    static void runTests()
+    {
+        std::cout << "\nRunning ScratchArena tests..." << std::endl;
+        testBufferIsReused();
+        testNestedScopes();
+        testThreadsHaveOwnBuffers();
+        testPointMoves();
+        std::cout << "All ScratchArena tests passed." << std::endl;
+    }
+
+private:
+    static void fill(ScratchArena& arena, size_t count)
+    {
+        ScratchVector<double> values(count, 1.0, arena.resource());
+        ScratchVector<int> more(count / 2, 2, arena.resource());
+        assert(values.back() == 1.0 && more.back() == 2);
+    }
+
+    // the first scope of a size may take from the heap, the next ones of the same size fit in the grown buffer
+    static void testBufferIsReused()
+    {
+        const size_t count = 200000;
+        {
+            ScratchArena arena;
+            fill(arena, count);
+        }
+        size_t buffer = ScratchArena::threadBufferBytes();
+        assert(buffer >= count * (sizeof(double) + sizeof(int) / 2));
+        for (int round = 0; round < 3; round++)
+        {
+            ScratchArena arena;
+            fill(arena, count);
+            assert(arena.overflowBytes() == 0);
+        }
+        assert(ScratchArena::threadBufferBytes() == buffer);
+        std::cout << "Test Passed: testBufferIsReused" << std::endl;
+    }
+
+    static void testNestedScopes()
+    {
+        size_t outerBuffer = ScratchArena::threadBufferBytes(0);
+        {
+            ScratchArena outer;
+            ScratchVector<int> kept(1000, 7, outer.resource());
+            {
+                ScratchArena inner;
+                ScratchVector<int> temporary(50000, 3, inner.resource());
+                assert(temporary[49999] == 3);
+            }
+            // the inner scope has its own buffer, the outer vector is untouched
+            assert(kept.front() == 7 && kept.back() == 7);
+            assert(ScratchArena::threadBufferBytes(1) >= 50000 * sizeof(int));
+        }
+        assert(ScratchArena::threadBufferBytes(0) == outerBuffer);
+        std::cout << "Test Passed: testNestedScopes" << std::endl;
+    }
+
+    static void testThreadsHaveOwnBuffers()
+    {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++)
+        {
+            threads.emplace_back([t]() {
+                for (int round = 0; round < 50; round++)
+                {
+                    ScratchArena arena;
+                    ScratchVector<int> values(10000, t, arena.resource());
+                    std::this_thread::yield();
+                    for (int value: values) { assert(value == t); }
+                }
+                assert(ScratchArena::threadBufferBytes() >= 10000 * sizeof(int));
+            });
+        }
+        for (auto& thread: threads) { thread.join(); }
+        std::cout << "Test Passed: testThreadsHaveOwnBuffers" << std::endl;
+    }
+
+    // moving a Point hands over its coordinates instead of copying them
+    static void testPointMoves()
+    {
+        Point point({1.0, 2.0, 3.0});
+        const double* coords = point.coords.data();
+        Point moved = std::move(point);
+        assert(moved.coords.data() == coords && point.coords.empty());
+
+        std::vector<double> values = {4.0, 5.0};
+        const double* data = values.data();
+        Point fromValues(std::move(values));
+        assert(fromValues.coords.data() == data && fromValues.cluster_id == -1);
+
+        std::vector<Point> points;
+        points.push_back(std::move(moved));
+        for (int i = 0; i < 100; i++) { points.push_back(Point({(double) i})); }
+        // growing the vector moved the first point along
+        assert(points[0].coords.data() == coords);
+        std::cout << "Test Passed: testPointMoves" << std::endl;
+    }
+};
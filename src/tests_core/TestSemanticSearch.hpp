@@ -0,0 +1,160 @@
+// TestSemanticSearch.hpp
+#pragma once
+#include "../data_processing/SemanticSearch.hpp"
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+class TestSemanticSearch
+{
+public:
+    static void runTests()
+    {
+        std::cout << "\nRunning SemanticSearch tests..." << std::endl;
+        testGroupsRowsByCluster();
+        testFullProbeMatchesBruteForce();
+        testSingleProbeStaysInCluster();
+        testSaveLoad();
+        testTryLoadRejectsDamagedFiles();
+        std::cout << "All SemanticSearch tests passed." << std::endl;
+    }
+
+private:
+    struct Sample {
+        std::vector<Point> points;
+        std::vector<int> cluster_ids;
+        std::vector<Point> centroids;
+    };
+
+    // 3 blobs in 4D; centroid ids are not positions to check the id -> slot mapping
+    static Sample createSample()
+    {
+        Sample s;
+        s.centroids = {Point({0.0, 0.0, 0.0, 0.0}, 7, 0), Point({10.0, 0.0, 0.0, 0.0}, 2, 0), Point({0.0, 10.0, 10.0, 0.0}, 5, 0)};
+        std::mt19937 gen(3);
+        std::normal_distribution<double> noise(0.0, 1.0);
+        for (int i = 0; i < 300; i++)
+        {
+            const Point& c = s.centroids[i % 3];
+            std::vector<double> coords(4);
+            for (int j = 0; j < 4; j++) { coords[j] = c.coords[j] + noise(gen); }
+            s.points.push_back(Point(coords));
+            s.cluster_ids.push_back(c.cluster_id);
+        }
+        return s;
+    }
+
+    static std::vector<int> bruteForce(const std::vector<Point>& points, const Point& query, int k)
+    {
+        std::vector<std::pair<double, int>> distances;
+        for (size_t i = 0; i < points.size(); i++) { distances.push_back({query.calcDist(points[i]), (int) i}); }
+        std::sort(distances.begin(), distances.end());
+        std::vector<int> ids;
+        for (int i = 0; i < k; i++) { ids.push_back(distances[i].second); }
+        return ids;
+    }
+
+    static void testGroupsRowsByCluster()
+    {
+        Sample s = createSample();
+        SemanticIndex index(s.points, s.cluster_ids, s.centroids);
+        assert(index.size() == 300);
+        assert(index.dimension() == 4);
+        assert(index.numClusters() == 3);
+        for (int slot = 0; slot < 3; slot++) { assert(index.clusterSize(slot) == 100); }
+        std::cout << "Test groups rows by cluster passed." << std::endl;
+    }
+
+    static void testFullProbeMatchesBruteForce()
+    {
+        Sample s = createSample();
+        SemanticIndex index(s.points, s.cluster_ids, s.centroids);
+        Point query({4.0, 4.0, 3.0, 0.5});
+        std::vector<std::pair<int, double>> found = index.search(query, 15, 3);
+        std::vector<int> expected = bruteForce(s.points, query, 15);
+        assert(found.size() == 15);
+        for (size_t i = 0; i < found.size(); i++)
+        {
+            assert(found[i].first == expected[i]);
+            assert(std::abs(found[i].second - query.calcDist(s.points[expected[i]])) < 1e-4);
+        }
+        std::cout << "Test full probe matches brute force passed." << std::endl;
+    }
+
+    static void testSingleProbeStaysInCluster()
+    {
+        Sample s = createSample();
+        SemanticIndex index(s.points, s.cluster_ids, s.centroids);
+        Point query({9.0, 0.5, 0.0, 0.0});
+        std::vector<std::pair<int, double>> found = index.search(query, 200, 1);
+        assert(found.size() == 100);
+        for (size_t i = 0; i < found.size(); i++)
+        {
+            assert(s.cluster_ids[found[i].first] == 2);
+            if (i > 0) { assert(found[i - 1].second <= found[i].second); }
+        }
+        std::cout << "Test single probe stays in cluster passed." << std::endl;
+    }
+
+    static void testSaveLoad()
+    {
+        Sample s = createSample();
+        SemanticIndex index(s.points, s.cluster_ids, s.centroids);
+        index.save("output/sample_index.sem");
+
+        SemanticIndex loaded;
+        loaded.load("output/sample_index.sem");
+        assert(loaded.size() == index.size());
+        assert(loaded.numClusters() == 3);
+        Point query({1.0, 8.0, 9.0, 0.0});
+        std::vector<std::pair<int, double>> a = index.search(query, 10, 2);
+        std::vector<std::pair<int, double>> b = loaded.search(query, 10, 2);
+        assert(a == b);
+        std::cout << "Test save/load passed." << std::endl;
+    }
+
+    // a damaged file leaves the index as it was, and search never reads outside the stored rows
+    static void testTryLoadRejectsDamagedFiles()
+    {
+        Sample s = createSample();
+        SemanticIndex index(s.points, s.cluster_ids, s.centroids);
+        index.save("output/sample_index.sem");
+        std::ifstream in("output/sample_index.sem", std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        auto write = [](const std::string& data) {
+            std::ofstream out("output/damaged_index.sem", std::ios::binary);
+            out.write(data.data(), data.size());
+        };
+        SemanticIndex loaded;
+        std::string error;
+        assert(loaded.tryLoad("output/sample_index.sem", &error) && loaded.size() == 300);
+
+        write(bytes.substr(0, bytes.size() - 1));
+        assert(!loaded.tryLoad("output/damaged_index.sem", &error) && !error.empty());
+        assert(loaded.size() == 300 && loaded.numClusters() == 3);
+
+        // offsets start after the header and 3 centroids of id + 4 doubles; make the second one run past the rows
+        size_t offsetsAt = 4 + 2 * sizeof(int32_t) + sizeof(int64_t) + 3 * (sizeof(int32_t) + 4 * sizeof(double));
+        std::string damaged = bytes;
+        int64_t past = 1000;
+        std::memcpy(&damaged[offsetsAt + sizeof(int64_t)], &past, sizeof(past));
+        write(damaged);
+        assert(!loaded.tryLoad("output/damaged_index.sem", &error));
+
+        damaged = bytes;
+        int32_t negative = -1;
+        std::memcpy(&damaged[4 + 2 * sizeof(int32_t) + sizeof(int64_t)], &negative, sizeof(negative));
+        write(damaged);
+        assert(!loaded.tryLoad("output/damaged_index.sem", &error));
+
+        assert(!loaded.tryLoad("output/missing_index.sem", &error));
+        assert(loaded.size() == 300);
+        std::cout << "Test tryLoad rejects damaged files passed." << std::endl;
+    }
+};
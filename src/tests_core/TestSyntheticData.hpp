@@ -0,0 +1,66 @@
+// TestSyntheticData.hpp
+#pragma once
+#include "../benchmarks_core/SyntheticData.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+class TestSyntheticData
+{
+public:
+    static void runTests()
+    {
+        std::cout << "\nRunning SyntheticData tests..." << std::endl;
+        testSameSeedSameData();
+        testPointsAroundTheirBlob();
+        std::cout << "All SyntheticData tests passed." << std::endl;
+    }
+
+private:
+    static void testSameSeedSameData()
+    {
+        std::vector<Point> a = gaussian_blobs(200, 3, 4, 1.0, 7);
+        std::vector<Point> b = gaussian_blobs(200, 3, 4, 1.0, 7);
+        std::vector<Point> c = gaussian_blobs(200, 3, 4, 1.0, 8);
+        assert(a.size() == 200 && a[0].coords.size() == 3);
+        bool differs = false;
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            assert(a[i].coords == b[i].coords);
+            assert(a[i].cluster_id == -1);
+            differs = differs || a[i].coords != c[i].coords;
+        }
+        assert(differs);
+        std::cout << "Test same seed same data passed." << std::endl;
+    }
+
+    static void testPointsAroundTheirBlob()
+    {
+        std::vector<Point> centers;
+        std::vector<Point> points = gaussian_blobs(4000, 2, 5, 0.1, 42, &centers);
+        assert(centers.size() == 5);
+        for (int b = 0; b < 5; b++)
+        {
+            assert(centers[b].cluster_id == b);
+            for (double coord: centers[b].coords) { assert(coord >= -10.0 && coord <= 10.0); }
+        }
+
+        // point i belongs to blob i % 5: the mean of its points is the center, their spread the requested one
+        for (int b = 0; b < 5; b++)
+        {
+            double sumX = 0, sumSquares = 0;
+            int count = 0;
+            for (size_t i = b; i < points.size(); i += 5)
+            {
+                double dx = points[i].coords[0] - centers[b].coords[0];
+                sumX += dx;
+                sumSquares += dx * dx;
+                count++;
+            }
+            assert(std::abs(sumX / count) < 0.02);
+            assert(std::abs(std::sqrt(sumSquares / count) - 0.1) < 0.01);
+        }
+        std::cout << "Test points around their blob passed." << std::endl;
+    }
+};
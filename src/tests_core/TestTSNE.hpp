@@ -0,0 +1,233 @@
+// TestTSNE.hpp
+#pragma once
+#include "../benchmarks_core/SyntheticData.hpp"
+#include "../tsne_core/BarnesHutTSNE.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+class TestTSNE
+{
+public:
+    static void runTests()
+    {
+        std::cout << "\nRunning t-SNE tests..." << std::endl;
+        testPerplexityCalibration();
+        testAffinitiesAreSymmetric();
+        testThetaZeroIsExact();
+        testSeparatesBlobs();
+        testSameLayoutForAnyThreadCount();
+        testHNSWNeighbors();
+        std::cout << "All t-SNE tests passed." << std::endl;
+    }
+
+private:
+    static TSNEOptions quickOptions(int iterations)
+    {
+        TSNEOptions options;
+        options.iterations = iterations;
+        options.exaggerationIterations = std::min(iterations / 2, 250);
+        return options;
+    }
+
+    // fraction of points whose nearest other point in the layout comes from the same blob (blob = index % blobs)
+    static double sameBlobNeighbors(const std::vector<Point>& layout, int blobs)
+    {
+        int same = 0;
+        for (size_t i = 0; i < layout.size(); i++)
+        {
+            double best = __DBL_MAX__;
+            size_t nearest = i;
+            for (size_t j = 0; j < layout.size(); j++)
+            {
+                double d = layout[i].calcDist(layout[j]);
+                if (j != i && d < best)
+                {
+                    best = d;
+                    nearest = j;
+                }
+            }
+            same += nearest % blobs == i % blobs;
+        }
+        return (double) same / layout.size();
+    }
+
+    static void testPerplexityCalibration()
+    {
+        std::mt19937 gen(3);
+        std::uniform_real_distribution<double> uniform(0.0, 50.0);
+        for (double perplexity: {3.0, 10.0, 30.0})
+        {
+            std::vector<double> distances(100), probabilities(100);
+            for (double& d: distances) { d = uniform(gen); }
+            BarnesHutTSNE::calibrateRow(distances.data(), 100, perplexity, probabilities.data());
+            double sum = 0, entropy = 0;
+            for (double p: probabilities)
+            {
+                sum += p;
+                if (p > 0) { entropy -= p * log(p); }
+            }
+            assert(fabs(sum - 1.0) < 1e-12);
+            assert(fabs(exp(entropy) - perplexity) < 1e-3 * perplexity);
+        }
+        // far neighbors only: without the shift by the minimum, exp(-beta * d) would be 0 for all of them
+        std::vector<double> far = {1e6, 1e6 + 1, 1e6 + 2, 1e6 + 4, 1e6 + 8}, probabilities(5);
+        BarnesHutTSNE::calibrateRow(far.data(), 5, 3.0, probabilities.data());
+        assert(probabilities[0] > probabilities[1] && probabilities[4] > 0);
+        std::cout << "Test Passed: testPerplexityCalibration" << std::endl;
+    }
+
+    static void testAffinitiesAreSymmetric()
+    {
+        std::vector<Point> points = gaussian_blobs(120, 8, 3, 1.0, 11);
+        BarnesHutTSNE tsne;
+        tsne.computeAffinities(points);
+        std::vector<size_t> rows = tsne.getRowStarts();
+        std::vector<int> columns = tsne.getColumns();
+        std::vector<double> p = tsne.getAffinities();
+        double total = 0;
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            // at least the 10 = 3 * 3 + 1 own neighbors, sorted, never the point itself
+            assert(rows[i + 1] - rows[i] >= 10);
+            for (size_t e = rows[i]; e < rows[i + 1]; e++)
+            {
+                int j = columns[e];
+                assert(j != (int) i);
+                assert(e == rows[i] || columns[e - 1] < j);
+                bool mirrored = false;
+                for (size_t f = rows[j]; f < rows[j + 1]; f++) { mirrored |= columns[f] == (int) i && p[f] == p[e]; }
+                assert(mirrored);
+                total += p[e];
+            }
+        }
+        assert(fabs(total - 1.0) < 1e-12);
+        std::cout << "Test Passed: testAffinitiesAreSymmetric" << std::endl;
+    }
+
+    // with theta = 0 the quadtree opens every cell, the gradient must equal the O(n^2) formula
+    static void testThetaZeroIsExact()
+    {
+        std::vector<Point> points = gaussian_blobs(80, 5, 2, 1.0, 5);
+        std::mt19937 gen(9);
+        std::normal_distribution<double> normal(0.0, 3.0);
+        std::vector<double> y(2 * points.size());
+        for (double& c: y) { c = normal(gen); }
+        // two points on the same place, which share a leaf
+        y[2] = y[0];
+        y[3] = y[1];
+
+        TSNEOptions options;
+        options.theta = 0;
+        BarnesHutTSNE tsne(options);
+        tsne.computeAffinities(points);
+        std::vector<double> grad;
+        double kl = 0;
+        tsne.gradient(y, 4.0, grad, &kl);
+
+        size_t n = points.size();
+        std::vector<double> dense(n * n, 0.0);
+        std::vector<size_t> rows = tsne.getRowStarts();
+        std::vector<int> columns = tsne.getColumns();
+        std::vector<double> p = tsne.getAffinities();
+        for (size_t i = 0; i < n; i++)
+        {
+            for (size_t e = rows[i]; e < rows[i + 1]; e++) { dense[i * n + columns[e]] = p[e]; }
+        }
+        double z = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            for (size_t j = 0; j < n; j++)
+            {
+                double dx = y[2 * i] - y[2 * j], dy = y[2 * i + 1] - y[2 * j + 1];
+                if (i != j) { z += 1.0 / (1.0 + dx * dx + dy * dy); }
+            }
+        }
+        double expectedKL = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            double gx = 0, gy = 0;
+            for (size_t j = 0; j < n; j++)
+            {
+                if (i == j) { continue; }
+                double dx = y[2 * i] - y[2 * j], dy = y[2 * i + 1] - y[2 * j + 1];
+                double q = 1.0 / (1.0 + dx * dx + dy * dy);
+                gx += 4 * (4.0 * dense[i * n + j] - q / z) * q * dx;
+                gy += 4 * (4.0 * dense[i * n + j] - q / z) * q * dy;
+                if (dense[i * n + j] > 0) { expectedKL += dense[i * n + j] * log(dense[i * n + j] / (q / z)); }
+            }
+            assert(fabs(grad[2 * i] - gx) < 1e-9 * (1 + fabs(gx)));
+            assert(fabs(grad[2 * i + 1] - gy) < 1e-9 * (1 + fabs(gy)));
+        }
+        assert(fabs(kl - expectedKL) < 1e-9);
+        std::cout << "Test Passed: testThetaZeroIsExact" << std::endl;
+    }
+
+    static void testSeparatesBlobs()
+    {
+        std::vector<Point> points = gaussian_blobs(300, 20, 3, 1.0, 7);
+        BarnesHutTSNE tsne(quickOptions(400));
+        std::vector<Point> layout = tsne.run(points);
+        assert(layout.size() == points.size() && layout[0].coords.size() == 2);
+        assert(sameBlobNeighbors(layout, 3) > 0.98);
+
+        // the divergence goes down once the exaggeration is over
+        std::vector<std::pair<int, double>> errors = tsne.getErrors();
+        assert(errors.size() == 8 && errors.back().first == 400);
+        assert(errors.back().second < errors[4].second);
+        std::cout << "Test Passed: testSeparatesBlobs" << std::endl;
+    }
+
+    // same neighbors and sums in index order: the threads only change the speed
+    static void testSameLayoutForAnyThreadCount()
+    {
+        std::vector<Point> points = gaussian_blobs(600, 10, 4, 1.0, 13);
+        TSNEOptions options = quickOptions(60);
+        options.threads = 1;
+        std::vector<Point> single = BarnesHutTSNE(options).run(points);
+        options.threads = 4;
+        std::vector<Point> parallel = BarnesHutTSNE(options).run(points);
+        for (size_t i = 0; i < points.size(); i++) { assert(single[i].coords == parallel[i].coords); }
+
+        // HNSW neighbors too, the graph is built on one thread unless reproducible is turned off
+        options.exactNeighborsBelow = 0;
+        options.threads = 1;
+        single = BarnesHutTSNE(options).run(points);
+        options.threads = 4;
+        parallel = BarnesHutTSNE(options).run(points);
+        for (size_t i = 0; i < points.size(); i++) { assert(single[i].coords == parallel[i].coords); }
+        std::cout << "Test Passed: testSameLayoutForAnyThreadCount" << std::endl;
+    }
+
+    static void testHNSWNeighbors()
+    {
+        std::vector<Point> points = gaussian_blobs(400, 16, 4, 1.0, 17);
+        BarnesHutTSNE exact;
+        exact.computeAffinities(points);
+
+        TSNEOptions options;
+        options.exactNeighborsBelow = 0;
+        options.threads = 1;
+        BarnesHutTSNE approximate(options);
+        approximate.computeAffinities(points);
+
+        // nearly all pairs of P are found through the graph too
+        std::vector<size_t> rows = exact.getRowStarts(), approximateRows = approximate.getRowStarts();
+        std::vector<int> columns = exact.getColumns(), approximateColumns = approximate.getColumns();
+        size_t found = 0;
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            for (size_t e = rows[i]; e < rows[i + 1]; e++)
+            {
+                found += std::binary_search(approximateColumns.begin() + approximateRows[i], approximateColumns.begin() + approximateRows[i + 1], columns[e]);
+            }
+        }
+        assert(found > 0.95 * columns.size());
+
+        std::vector<Point> layout = approximate.run(points);
+        assert(sameBlobNeighbors(layout, 4) > 0.98);
+        std::cout << "Test Passed: testHNSWNeighbors" << std::endl;
+    }
+};
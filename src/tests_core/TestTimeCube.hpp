@@ -0,0 +1,138 @@
+// TestTimeCube.hpp
+#pragma once
+#include "../data_processing/TimeCubeBuilder.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+class TestTimeCube
+{
+public:
+    static void runTests()
+    {
+        std::cout << "\nRunning TimeCube tests..." << std::endl;
+        testCivilDays();
+        testReadUtc();
+        testRangeTotals();
+        testTopClusters();
+        testRejectsInvalidBuffer();
+        testSkipsMissingUtc();
+        std::cout << "All TimeCube tests passed." << std::endl;
+    }
+
+private:
+    static double utcOf(int year, int month, int day, int hour) { return daysFromCivil(year, month, day) * 86400.0 + hour * 3600.0; }
+
+    static void testCivilDays()
+    {
+        assert(daysFromCivil(1970, 1, 1) == 0);
+        assert(daysFromCivil(2000, 3, 1) == 11017);
+        assert(daysFromCivil(2022, 8, 31) == 19235);
+        assert(daysFromCivil(1969, 12, 31) == -1);
+        for (int days = -1000; days < 30000; days += 37)
+        {
+            int year, month, day;
+            civilFromDays(days, year, month, day);
+            assert(daysFromCivil(year, month, day) == days);
+        }
+        std::cout << "Test civil days passed." << std::endl;
+    }
+
+    static void testReadUtc()
+    {
+        std::vector<CommentInfo> comments = read_comments_csv("samples/sample_comments.csv");
+        assert(comments[0].utc == 1661990368.0);
+        // 1661990368 is 2022-08-31 23:59:28 UTC
+        assert((int) std::floor(comments[0].utc / 86400.0) == daysFromCivil(2022, 8, 31));
+        std::cout << "Test read utc passed." << std::endl;
+    }
+
+    static void createCube(std::vector<char>& buffer, TimeCubeView& view)
+    {
+        std::vector<CommentInfo> comments = {
+            CommentInfo{10, 0.5, "a", utcOf(2021, 12, 31, 23)},
+            CommentInfo{2, -0.5, "b", utcOf(2022, 1, 1, 0)},
+            CommentInfo{3, 0.25, "c", utcOf(2022, 1, 15, 12)},
+            CommentInfo{4, 0.0, "d", utcOf(2022, 2, 1, 5)},
+            CommentInfo{5, 1.0, "e", utcOf(2022, 2, 1, 6)},
+            CommentInfo{6, 0.0, "f", utcOf(2022, 3, 3, 3)},
+            CommentInfo{7, 0.0, "g", utcOf(2022, 3, 4, 3)},
+        };
+        std::vector<int> cluster_ids = {0, 1, 1, 2, 1, 0, -1};
+        save_time_cube("output/sample_time_cube.bin", comments, cluster_ids);
+        load_time_cube("output/sample_time_cube.bin", buffer, view);
+    }
+
+    static void testRangeTotals()
+    {
+        std::vector<char> buffer;
+        TimeCubeView view;
+        createCube(buffer, view);
+        assert(view.numClusters() == 3);
+        assert(view.firstDay() == daysFromCivil(2021, 12, 31));
+        assert(view.numDays() == daysFromCivil(2022, 3, 3) - daysFromCivil(2021, 12, 31) + 1);
+
+        TimeCubeCell year2022 = view.total(TimeCubeView::yearStart(2022), TimeCubeView::yearStart(2023), 1);
+        assert(year2022.count == 3 && year2022.scoreSum == 10 && year2022.sentimentSum == 0.75);
+        assert(view.total(TimeCubeView::yearStart(2021), TimeCubeView::yearStart(2022), 0).count == 1);
+
+        TimeCubeCell january = view.total(TimeCubeView::monthStart(2022, 1), TimeCubeView::monthStart(2022, 2), 1);
+        assert(january.count == 2 && january.scoreSum == 5);
+        assert(view.total(TimeCubeView::monthStart(2022, 12), TimeCubeView::monthStart(2022, 13), 1).count == 0);
+
+        int feb1 = daysFromCivil(2022, 2, 1);
+        assert(view.total(feb1, feb1 + 1, 2).count == 1 && view.total(feb1, feb1 + 1, 1).count == 1);
+        // ranges reaching outside the cube are clamped, unknown clusters are empty
+        assert(view.total(-100000, 100000, 0).count == 2);
+        assert(view.total(feb1, feb1, 1).count == 0);
+        assert(view.total(0, 100000, 7).count == 0);
+        std::cout << "Test range totals passed." << std::endl;
+    }
+
+    static void testTopClusters()
+    {
+        std::vector<char> buffer;
+        TimeCubeView view;
+        createCube(buffer, view);
+        std::vector<int> top = view.topClusters(TimeCubeView::yearStart(2022), TimeCubeView::yearStart(2023), 5);
+        assert(top == std::vector<int>({1, 0, 2}));// 3 comments, then a tie of 1 and 1
+        assert(view.topClusters(TimeCubeView::yearStart(2022), TimeCubeView::yearStart(2023), 1) == std::vector<int>({1}));
+        assert(view.topClusters(TimeCubeView::yearStart(2030), TimeCubeView::yearStart(2031), 5).empty());
+        std::cout << "Test top clusters passed." << std::endl;
+    }
+
+    static void testRejectsInvalidBuffer()
+    {
+        TimeCubeView view;
+        std::string garbage(64, 'x');
+        assert(!view.open(garbage.data(), garbage.size()));
+        assert(view.total(0, 100000, 0).count == 0);
+
+        std::vector<char> buffer;
+        createCube(buffer, view);
+        assert(!view.open(buffer.data(), buffer.size() - 1));
+        std::cout << "Test rejects invalid buffer passed." << std::endl;
+    }
+
+    // a row without a time would otherwise stretch the cube back to 1970-01-01
+    static void testSkipsMissingUtc()
+    {
+        std::vector<CommentInfo> comments = {
+            CommentInfo{1, 0.5, "a", utcOf(2022, 1, 1, 12)},
+            CommentInfo{2, 0.5, "b", 0.0},
+            CommentInfo{3, 0.5, "c", utcOf(2022, 1, 3, 12)},
+            CommentInfo{4, 0.5, "d", -5.0},
+        };
+        save_time_cube("output/sample_time_cube_utc.bin", comments, {0, 1, 0, 0});
+        std::vector<char> buffer;
+        TimeCubeView view;
+        load_time_cube("output/sample_time_cube_utc.bin", buffer, view);
+        assert(view.firstDay() == daysFromCivil(2022, 1, 1) && view.numDays() == 3);
+        assert(view.numClusters() == 1);
+        TimeCubeCell all = view.total(-100000, 100000, 0);
+        assert(all.count == 2 && all.scoreSum == 4);
+        std::cout << "Test skips missing utc passed." << std::endl;
+    }
+};
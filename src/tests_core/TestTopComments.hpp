@@ -0,0 +1,118 @@
+// TestTopComments.hpp
+#pragma once
+#include "../data_processing/TopCommentsBuilder.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+class TestTopComments
+{
+public:
+    static void runTests()
+    {
+        std::cout << "\nRunning TopComments tests..." << std::endl;
+        testReadCommentsCsv();
+        testListsAreRanked();
+        testTextsAreShared();
+        testRejectsInvalidBuffer();
+        std::cout << "All TopComments tests passed." << std::endl;
+    }
+
+private:
+    static void testReadCommentsCsv()
+    {
+        std::vector<CommentInfo> comments = read_comments_csv("samples/sample_comments.csv");
+        assert(comments.size() == 4);
+        assert(comments[0].text == "Plain comment");
+        assert(comments[1].text == "Has, a comma and \"quotes\"");
+        assert(comments[1].sentiment == -0.9 && comments[1].score == 40.0);
+        assert(comments[2].text == "Spans\ntwo lines");
+        assert(comments[3].text == "Unquoted" && comments[3].score == 7.0);
+        std::cout << "Test read comments csv passed." << std::endl;
+    }
+
+    // rows 0..5 in cluster 0 or 1 with known distance, score and sentiment
+    static void createSample(std::vector<Point>& combined, std::vector<CommentInfo>& comments)
+    {
+        int clusters[] = {0, 1, 0, 1, 0, 0};
+        double distances[] = {3.0, 1.0, 1.0, 2.0, 2.0, 0.5};
+        double scores[] = {10, 5, -4, 50, 100, 1};
+        double sentiments[] = {0.9, 0.2, -0.8, 0.0, 0.1, 0.3};
+        for (int i = 0; i < 6; i++)
+        {
+            combined.push_back(Point({0.0, 0.0}, clusters[i], distances[i]));
+            comments.push_back(CommentInfo{scores[i], sentiments[i], "comment " + std::to_string(i)});
+        }
+    }
+
+    static std::vector<int> rowsOf(const TopCommentsView& view, int cluster, TopCommentsOrder order)
+    {
+        std::vector<int> rows;
+        for (int i = 0; i < view.count(cluster, order); i++) { rows.push_back(view.entry(cluster, order, i).row); }
+        return rows;
+    }
+
+    static void testListsAreRanked()
+    {
+        std::vector<Point> combined;
+        std::vector<CommentInfo> comments;
+        createSample(combined, comments);
+        save_top_comments("output/sample_top_comments.bin", combined, comments, 3);
+
+        std::vector<char> buffer;
+        TopCommentsView view;
+        load_top_comments("output/sample_top_comments.bin", buffer, view);
+        assert(view.numClusters() == 2 && view.topN() == 3);
+
+        assert(rowsOf(view, 0, BY_DISTANCE) == std::vector<int>({5, 2, 4}));
+        assert(rowsOf(view, 0, BY_SCORE) == std::vector<int>({4, 0, 5}));
+        // |sentiment| * log(1 + |score|): row 0 = 2.16, row 2 = 1.29, row 4 = 0.46, row 5 = 0.21
+        assert(rowsOf(view, 0, BY_CONTROVERSY) == std::vector<int>({0, 2, 4}));
+        assert(rowsOf(view, 1, BY_DISTANCE) == std::vector<int>({1, 3}));
+        assert(view.count(2, BY_SCORE) == 0);
+
+        assert(view.entry(0, BY_DISTANCE, 0).value == 0.5);
+        assert(view.entry(0, BY_SCORE, 2).value == 1.0);
+        assert(std::abs(view.entry(0, BY_CONTROVERSY, 0).value - 0.9 * std::log(11.0)) < 1e-12);
+        assert(view.text(view.entry(1, BY_SCORE, 0)) == "comment 3");
+        std::cout << "Test lists are ranked passed." << std::endl;
+    }
+
+    static void testTextsAreShared()
+    {
+        std::vector<Point> combined;
+        std::vector<CommentInfo> comments;
+        createSample(combined, comments);
+        save_top_comments("output/sample_top_comments.bin", combined, comments, 3);
+
+        std::vector<char> buffer;
+        TopCommentsView view;
+        load_top_comments("output/sample_top_comments.bin", buffer, view);
+        // row 4 is in all three lists of cluster 0 but its text is stored once
+        const TopCommentEntry& a = view.entry(0, BY_DISTANCE, 2);
+        const TopCommentEntry& b = view.entry(0, BY_SCORE, 0);
+        assert(a.row == 4 && b.row == 4 && a.textOffset == b.textOffset);
+        assert(view.text(a) == "comment 4");
+        std::cout << "Test texts are shared passed." << std::endl;
+    }
+
+    static void testRejectsInvalidBuffer()
+    {
+        TopCommentsView view;
+        std::string garbage(100, 'x');
+        assert(!view.open(garbage.data(), garbage.size()));
+        assert(!view.isOpen());
+        assert(view.count(0, BY_SCORE) == 0);
+
+        std::vector<Point> combined;
+        std::vector<CommentInfo> comments;
+        createSample(combined, comments);
+        save_top_comments("output/sample_top_comments.bin", combined, comments, 3);
+        std::vector<char> buffer;
+        load_top_comments("output/sample_top_comments.bin", buffer, view);
+        assert(!view.open(buffer.data(), buffer.size() - 1));// truncated text section
+        std::cout << "Test rejects invalid buffer passed." << std::endl;
+    }
+};
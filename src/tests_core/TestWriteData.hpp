@@ -1,6 +1,6 @@
 #pragma once
 #include "../clustering_core/modules/kMeansLogic.hpp"
-#include "../clustering_core/modules/readData.hpp"
+#include "../clustering_core/modules/ReadData.hpp"
 #include "../clustering_core/modules/structPoint.hpp"
 #include "../clustering_core/modules/writeData.hpp"
 #include <cassert>
@@ -20,6 +20,7 @@ public:
         std::cout << "Running TestWriteData tests..." << std::endl;
         testWriteToCSV();
         testWriteToTXT();
+        testSavePoints();
         std::cout << "All TestWriteData tests passed.\n" << std::endl;
     }
 
@@ -68,6 +69,26 @@ private:
         std::cout << "Test passed: Write to TXT." << std::endl;
     }
 
+    // bare points, e.g. a t-SNE projection, read back unchanged from every format
+    static void testSavePoints()
+    {
+        std::vector<Point> points = {Point({1.5, -2.25}), Point({0.0, 3.0}), Point({-7.125, 8.5})};
+        for (std::string path: {"output/projection.csv", "output/projection.txt", "output/projection.npy"})
+        {
+            save_points(path, points);
+            std::vector<Point> read = read_data(path);
+            assert(read.size() == points.size());
+            for (size_t i = 0; i < points.size(); i++)
+            {
+                assert(read[i].coords == points[i].coords && read[i].cluster_id == -1);
+            }
+        }
+        std::ifstream csv("output/projection.csv");
+        std::string header;
+        std::getline(csv, header);
+        assert(header == "x,y");
+        std::cout << "Test passed: Save points." << std::endl;
+    }
 
     static std::vector<Point> CreateSampleData()
     {
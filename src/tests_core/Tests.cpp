@@ -6,6 +6,19 @@
 #include "TestClusters.hpp"
 #include "TestClusterRelevantInfo.hpp"
 #include "TestReduceClusterSizes.hpp"
+#include "TestProductQuantizer.hpp"
+#include "TestHNSWIndex.hpp"
+#include "TestCentroidAssigner.hpp"
+#include "TestSemanticSearch.hpp"
+#include "TestTopComments.hpp"
+#include "TestTimeCube.hpp"
+#include "TestKDTree2D.hpp"
+#include "TestDatasetBundle.hpp"
+#include "TestSyntheticData.hpp"
+#include "TestProgress.hpp"
+#include "TestMemoryBudget.hpp"
+#include "TestScratchArena.hpp"
+#include "TestTSNE.hpp"
 
 int main()
 {
@@ -23,6 +36,19 @@ int main()
     TestClusterSort().runTests();
     TestClusterNeighbors().runTests();
     TestReadCentroids().runTests();
+    TestProductQuantizer().runTests();
+    TestHNSWIndex().runTests();
+    TestCentroidAssigner().runTests();
+    TestSemanticSearch().runTests();
+    TestTopComments().runTests();
+    TestTimeCube().runTests();
+    TestKDTree2D().runTests();
+    TestDatasetBundle().runTests();
+    TestSyntheticData().runTests();
+    TestProgress().runTests();
+    TestMemoryBudget().runTests();
+    TestScratchArena().runTests();
+    TestTSNE().runTests();
 
 
     std::cout << "\n=========================\n";
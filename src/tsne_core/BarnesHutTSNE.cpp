@@ -0,0 +1,458 @@
+#include "BarnesHutTSNE.hpp"
+#include "../clustering_core/modules/parallel.hpp"
+#include "../clustering_core/modules/progress.hpp"
+#include "../clustering_core/modules/scratchArena.hpp"
+#include "../index_core/HNSWIndex.hpp"
+#include <cmath>
+#include <random>
+
+void TSNEQuadTree::build(const double* y, size_t n)
+{
+    _y = y;
+    _cells.clear();
+    if (n == 0) { return; }
+    double minX = y[0], maxX = y[0], minY = y[1], maxY = y[1];
+    for (size_t i = 1; i < n; i++)
+    {
+        minX = std::min(minX, y[2 * i]);
+        maxX = std::max(maxX, y[2 * i]);
+        minY = std::min(minY, y[2 * i + 1]);
+        maxY = std::max(maxY, y[2 * i + 1]);
+    }
+    Cell root;
+    root.centerX = (minX + maxX) / 2;
+    root.centerY = (minY + maxY) / 2;
+    root.halfWidth = std::max(maxX - minX, maxY - minY) / 2 * (1 + 1e-6) + 1e-12;
+    // cells this small are not split any further, their points are kept together; bounds the depth to ~35
+    _minHalfWidth = root.halfWidth * 1e-10;
+    _cells.push_back(root);
+    _leafOf.resize(n);
+    for (size_t i = 0; i < n; i++) { insert((int) i); }
+    for (Cell& cell: _cells)
+    {
+        if (cell.count == 0) { continue; }
+        cell.massX /= cell.count;
+        cell.massY /= cell.count;
+    }
+
+    // rank of every leaf in a depth-first walk, the points are sorted by the rank of their leaf
+    std::vector<int> rank(_cells.size(), 0), stack = {0};
+    int next = 0;
+    while (!stack.empty())
+    {
+        int cell = stack.back();
+        stack.pop_back();
+        if (_cells[cell].firstChild < 0) { rank[cell] = next++; }
+        else
+        {
+            for (int c = 3; c >= 0; c--) { stack.push_back(_cells[cell].firstChild + c); }
+        }
+    }
+    std::vector<std::pair<int, int>> keyed(n);
+    for (size_t i = 0; i < n; i++) { keyed[i] = {rank[_leafOf[i]], (int) i}; }
+    std::sort(keyed.begin(), keyed.end());
+    _order.resize(n);
+    for (size_t i = 0; i < n; i++) { _order[i] = keyed[i].second; }
+}
+
+void TSNEQuadTree::insert(int point)
+{
+    double x = _y[2 * point], y = _y[2 * point + 1];
+    int cell = 0;
+    while (true)
+    {
+        if (_cells[cell].count == 0)
+        {
+            _cells[cell].point = point;
+        }
+        else if (_cells[cell].firstChild < 0)
+        {
+            const Cell& leaf = _cells[cell];
+            bool samePlace = _y[2 * leaf.point] == x && _y[2 * leaf.point + 1] == y;
+            if (!samePlace && leaf.halfWidth > _minHalfWidth) { split(cell); }
+        }
+        Cell& current = _cells[cell];
+        current.massX += x;
+        current.massY += y;
+        current.count++;
+        if (current.firstChild < 0)
+        {
+            _leafOf[point] = cell;
+            return;
+        }
+        cell = childFor(current, x, y);
+    }
+}
+
+// turns a leaf into an inner cell, its points move to the child that contains them
+void TSNEQuadTree::split(int cell)
+{
+    int first = (int) _cells.size();
+    double quarter = _cells[cell].halfWidth / 2;
+    for (int c = 0; c < 4; c++)
+    {
+        Cell child;
+        child.centerX = _cells[cell].centerX + (c & 1 ? quarter : -quarter);
+        child.centerY = _cells[cell].centerY + (c & 2 ? quarter : -quarter);
+        child.halfWidth = quarter;
+        _cells.push_back(child);
+    }
+    Cell& parent = _cells[cell];
+    parent.firstChild = first;
+    Cell& child = _cells[childFor(parent, _y[2 * parent.point], _y[2 * parent.point + 1])];
+    child.massX = parent.massX;
+    child.massY = parent.massY;
+    child.count = parent.count;
+    child.point = parent.point;
+    parent.point = -1;
+}
+
+void TSNEQuadTree::repulsion(double x, double y, double theta, double& forceX, double& forceY, double& sumQ) const
+{
+    if (!_cells.empty()) { repulsion(0, x, y, theta * theta, forceX, forceY, sumQ); }
+}
+
+void TSNEQuadTree::repulsion(int index, double x, double y, double theta2, double& forceX, double& forceY, double& sumQ) const
+{
+    const Cell& cell = _cells[index];
+    if (cell.count == 0) { return; }
+    double dx = x - cell.massX;
+    double dy = y - cell.massY;
+    double d2 = dx * dx + dy * dy;
+    double width = 2 * cell.halfWidth;
+    if (cell.firstChild < 0 || width * width < theta2 * d2)
+    {
+        double q = 1.0 / (1.0 + d2);
+        sumQ += cell.count * q;
+        double mult = cell.count * q * q;
+        forceX += mult * dx;
+        forceY += mult * dy;
+        return;
+    }
+    for (int c = 0; c < 4; c++) { repulsion(cell.firstChild + c, x, y, theta2, forceX, forceY, sumQ); }
+}
+
+std::vector<Point> BarnesHutTSNE::run(const std::vector<Point>& points)
+{
+    MemoryStage stage("t-SNE");
+    _errors.clear();
+    computeAffinities(points);
+    std::vector<double> y = optimize();
+
+    std::vector<Point> layout;
+    layout.reserve(_n);
+    for (size_t i = 0; i < _n; i++) { layout.push_back(Point(std::vector<double>{y[2 * i], y[2 * i + 1]})); }
+    return layout;
+}
+
+void BarnesHutTSNE::computeAffinities(const std::vector<Point>& points)
+{
+    _n = points.size();
+    _memory.release();
+    _rowStarts.assign(_n + 1, 0);
+    _columns.clear();
+    _affinities.clear();
+    if (_n < 2) { return; }
+
+    int k = neighborCount();
+    // neighbors, their distances and conditional probabilities, P with up to 2k entries per row, and about
+    // 16 doubles per point for the layout, the optimizer state, the per-point forces and the quadtree
+    _memory = MemoryReservation("the t-SNE affinities", _n * (k * (sizeof(int) + 2 * sizeof(double)) + 2 * k * (sizeof(int) + sizeof(double)) + 16 * sizeof(double)));
+
+    std::vector<int> neighbors;
+    std::vector<double> distances;
+    nearestNeighbors(points, k, neighbors, distances);
+
+    std::vector<double> conditional(_n * k);
+    runParallel(_options.threads, (_n + TSNE_BLOCK_SIZE - 1) / TSNE_BLOCK_SIZE, [&](size_t b) {
+        for (size_t i = b * TSNE_BLOCK_SIZE; i < std::min(_n, (b + 1) * TSNE_BLOCK_SIZE); i++)
+        {
+            calibrateRow(&distances[i * k], k, _options.perplexity, &conditional[i * k]);
+        }
+    });
+    symmetrize(k, neighbors, conditional);
+}
+
+// the k nearest other points of every point as indices and squared distances, closest first
+void BarnesHutTSNE::nearestNeighbors(const std::vector<Point>& points, int k, std::vector<int>& neighbors, std::vector<double>& distances) const
+{
+    neighbors.assign(_n * k, 0);
+    distances.assign(_n * k, 0.0);
+    size_t blocks = (_n + TSNE_BLOCK_SIZE - 1) / TSNE_BLOCK_SIZE;
+    Progress progress("t-SNE neighbors", _n);
+
+    // the k nearest other points of row i by a scan over all points
+    auto exactRow = [&](size_t i, ScratchVector<std::pair<double, int>>& candidates) {
+        candidates.clear();
+        for (size_t j = 0; j < _n; j++)
+        {
+            if (j == i) { continue; }
+            double d = points[i].calcDist(points[j]);
+            candidates.push_back({d * d, (int) j});
+        }
+        // ties go to the lower index, so the neighbors do not depend on the order of the scan
+        std::partial_sort(candidates.begin(), candidates.begin() + k, candidates.end());
+        for (int m = 0; m < k; m++)
+        {
+            distances[i * k + m] = candidates[m].first;
+            neighbors[i * k + m] = candidates[m].second;
+        }
+    };
+
+    if (_n < _options.exactNeighborsBelow)
+    {
+        runParallel(_options.threads, blocks, [&](size_t b) {
+            ScratchArena arena;
+            ScratchVector<std::pair<double, int>> candidates(arena.resource());
+            size_t end = std::min(_n, (b + 1) * TSNE_BLOCK_SIZE);
+            for (size_t i = b * TSNE_BLOCK_SIZE; i < end; i++) { exactRow(i, candidates); }
+            progress.add(end - b * TSNE_BLOCK_SIZE);
+        });
+        return;
+    }
+
+    HNSWIndex index(_options.hnswM, _options.hnswEf, _options.seed);
+    // the graph depends on the order of the insertions, which is only fixed on one thread
+    index.build(points, _options.reproducible ? 1 : _options.threads);
+    runParallel(_options.threads, blocks, [&](size_t b) {
+        ScratchArena arena;
+        ScratchVector<std::pair<double, int>> candidates(arena.resource());
+        size_t end = std::min(_n, (b + 1) * TSNE_BLOCK_SIZE);
+        for (size_t i = b * TSNE_BLOCK_SIZE; i < end; i++)
+        {
+            // the point itself is usually the first hit, one more is asked for to leave k others
+            int m = 0;
+            for (const auto& hit: index.search(points[i], k + 1, std::max(_options.hnswEf, k + 1)))
+            {
+                if (hit.first == (int) i || m == k) { continue; }
+                distances[i * k + m] = hit.second * hit.second;
+                neighbors[i * k + m] = hit.first;
+                m++;
+            }
+            // without a single other hit the row would keep its zero defaults, a self-pair for row 0
+            if (m == 0)
+            {
+                exactRow(i, candidates);
+                continue;
+            }
+            // a graph that gave fewer hits repeats the farthest one, which only sharpens its weight a little
+            for (; m < k; m++)
+            {
+                distances[i * k + m] = distances[i * k + m - 1];
+                neighbors[i * k + m] = neighbors[i * k + m - 1];
+            }
+        }
+        progress.add(end - b * TSNE_BLOCK_SIZE);
+    });
+}
+
+/**
+ * Binary search of beta as in sklearn's _binary_search_perplexity: the entropy of exp(-beta * d) / sum is
+ * matched to log(perplexity) within 1e-5, in at most 100 steps. The distances are shifted by their minimum,
+ * which leaves the probabilities unchanged and keeps exp from underflowing for far neighbors.
+ */
+double BarnesHutTSNE::calibrateRow(const double* distances, int count, double perplexity, double* probabilities)
+{
+    if (count <= 0) { return 1.0; }
+    double minDistance = *std::min_element(distances, distances + count);
+    double desiredEntropy = log(perplexity);
+    double beta = 1.0, betaMin = -INFINITY, betaMax = INFINITY;
+    for (int step = 0; step < 100; step++)
+    {
+        double sum = 0;
+        for (int j = 0; j < count; j++)
+        {
+            probabilities[j] = exp(-(distances[j] - minDistance) * beta);
+            sum += probabilities[j];
+        }
+        double weighted = 0;
+        for (int j = 0; j < count; j++)
+        {
+            probabilities[j] /= sum;
+            weighted += (distances[j] - minDistance) * probabilities[j];
+        }
+        double difference = log(sum) + beta * weighted - desiredEntropy;
+        if (fabs(difference) <= 1e-5) { break; }
+        if (difference > 0)
+        {
+            betaMin = beta;
+            beta = betaMax == INFINITY ? beta * 2 : (beta + betaMax) / 2;
+        }
+        else
+        {
+            betaMax = beta;
+            beta = betaMin == -INFINITY ? beta / 2 : (beta + betaMin) / 2;
+        }
+    }
+    return beta;
+}
+
+// P = (P_cond + P_cond^T) / sum, with the entries of both directions of a pair merged
+void BarnesHutTSNE::symmetrize(int k, const std::vector<int>& neighbors, const std::vector<double>& conditional)
+{
+    std::vector<size_t> counts(_n + 1, 0);
+    for (size_t i = 0; i < _n; i++)
+    {
+        counts[i + 1] += k;
+        for (int m = 0; m < k; m++) { counts[neighbors[i * k + m] + 1]++; }
+    }
+    for (size_t i = 0; i < _n; i++) { counts[i + 1] += counts[i]; }
+    std::vector<std::pair<int, double>> entries(counts[_n]);
+    std::vector<size_t> fill(counts.begin(), counts.end() - 1);
+    for (size_t i = 0; i < _n; i++)
+    {
+        for (int m = 0; m < k; m++)
+        {
+            int j = neighbors[i * k + m];
+            double p = conditional[i * k + m];
+            entries[fill[i]++] = {j, p};
+            entries[fill[j]++] = {(int) i, p};
+        }
+    }
+
+    // rows sorted by column, duplicates added up; the merged rows are compacted afterwards in index order
+    std::vector<size_t> merged(_n, 0);
+    runParallel(_options.threads, (_n + TSNE_BLOCK_SIZE - 1) / TSNE_BLOCK_SIZE, [&](size_t b) {
+        for (size_t i = b * TSNE_BLOCK_SIZE; i < std::min(_n, (b + 1) * TSNE_BLOCK_SIZE); i++)
+        {
+            auto first = entries.begin() + counts[i], last = entries.begin() + counts[i + 1];
+            std::sort(first, last);
+            auto out = first;
+            for (auto entry = first; entry != last; ++entry)
+            {
+                if (out != first && (out - 1)->first == entry->first) { (out - 1)->second += entry->second; }
+                else { *out++ = *entry; }
+            }
+            merged[i] = out - first;
+        }
+    });
+
+    double total = 0;
+    for (size_t i = 0; i < _n; i++)
+    {
+        for (size_t e = counts[i]; e < counts[i] + merged[i]; e++) { total += entries[e].second; }
+    }
+    _rowStarts.assign(_n + 1, 0);
+    for (size_t i = 0; i < _n; i++) { _rowStarts[i + 1] = _rowStarts[i] + merged[i]; }
+    _columns.resize(_rowStarts[_n]);
+    _affinities.resize(_rowStarts[_n]);
+    for (size_t i = 0; i < _n; i++)
+    {
+        for (size_t e = 0; e < merged[i]; e++)
+        {
+            _columns[_rowStarts[i] + e] = entries[counts[i] + e].first;
+            _affinities[_rowStarts[i] + e] = entries[counts[i] + e].second / std::max(total, 1e-300);
+        }
+    }
+}
+
+/**
+ * grad_i = 4 * (exaggeration * sum_j p_ij q_ij (y_i - y_j) - sum_j q_ij^2 (y_i - y_j) / Z), q_ij = 1 / (1 + |y_i - y_j|^2)
+ * and Z = sum over all pairs of q_ij. The attractive part runs over the sparse P, the repulsive part and Z over
+ * the quadtree. The per-point parts of Z are added in index order.
+ */
+void BarnesHutTSNE::gradient(const std::vector<double>& y, double exaggeration, std::vector<double>& grad, double* kl)
+{
+    grad.assign(2 * _n, 0.0);
+    if (_n < 2) { return; }
+    _tree.build(y.data(), _n);
+
+    // the per-point parts live for this gradient only, they come from the thread's scratch buffer
+    ScratchArena arena;
+    ScratchVector<double> repulsive(2 * _n, arena.resource()), pointQ(_n, arena.resource());
+    // the points are taken in the order of the tree: one after another they open mostly the same cells, which
+    // stay in cache; every point is still computed on its own
+    const std::vector<int>& order = _tree.order();
+    runParallel(_options.threads, (_n + TSNE_BLOCK_SIZE - 1) / TSNE_BLOCK_SIZE, [&](size_t b) {
+        for (size_t r = b * TSNE_BLOCK_SIZE; r < std::min(_n, (b + 1) * TSNE_BLOCK_SIZE); r++)
+        {
+            size_t i = order[r];
+            double xi = y[2 * i], yi = y[2 * i + 1];
+            double attractX = 0, attractY = 0;
+            for (size_t e = _rowStarts[i]; e < _rowStarts[i + 1]; e++)
+            {
+                int j = _columns[e];
+                double dx = xi - y[2 * j], dy = yi - y[2 * j + 1];
+                double mult = _affinities[e] / (1.0 + dx * dx + dy * dy);
+                attractX += mult * dx;
+                attractY += mult * dy;
+            }
+            grad[2 * i] = exaggeration * attractX;
+            grad[2 * i + 1] = exaggeration * attractY;
+
+            double forceX = 0, forceY = 0, sumQ = 0;
+            _tree.repulsion(xi, yi, _options.theta, forceX, forceY, sumQ);
+            repulsive[2 * i] = forceX;
+            repulsive[2 * i + 1] = forceY;
+            // the point itself was counted at distance 0 (for theta < 1/sqrt(2) it is always in a leaf)
+            pointQ[i] = sumQ - 1.0;
+        }
+    });
+    double z = 0;
+    for (double q: pointQ) { z += q; }
+    z = std::max(z, 1e-300);
+    for (size_t c = 0; c < 2 * _n; c++) { grad[c] = 4 * (grad[c] - repulsive[c] / z); }
+
+    if (kl)
+    {
+        ScratchVector<double> rowKL(_n, arena.resource());
+        runParallel(_options.threads, (_n + TSNE_BLOCK_SIZE - 1) / TSNE_BLOCK_SIZE, [&](size_t b) {
+            for (size_t i = b * TSNE_BLOCK_SIZE; i < std::min(_n, (b + 1) * TSNE_BLOCK_SIZE); i++)
+            {
+                double sum = 0;
+                for (size_t e = _rowStarts[i]; e < _rowStarts[i + 1]; e++)
+                {
+                    int j = _columns[e];
+                    double dx = y[2 * i] - y[2 * j], dy = y[2 * i + 1] - y[2 * j + 1];
+                    double q = 1.0 / (1.0 + dx * dx + dy * dy) / z;
+                    sum += _affinities[e] * log(std::max(_affinities[e], 1e-12) / std::max(q, 1e-12));
+                }
+                rowKL[i] = sum;
+            }
+        });
+        *kl = 0;
+        for (double value: rowKL) { *kl += value; }
+    }
+}
+
+std::vector<double> BarnesHutTSNE::optimize()
+{
+    std::vector<double> y(2 * _n);
+    std::mt19937 gen(_options.seed);
+    std::normal_distribution<double> normal(0.0, 1e-4);
+    for (double& c: y) { c = normal(gen); }
+    if (_n < 2) { return y; }
+
+    double learningRate = _options.learningRate > 0 ? _options.learningRate : std::max(_n / _options.earlyExaggeration / 4, 50.0);
+    std::vector<double> grad, update(2 * _n, 0.0), gains(2 * _n, 1.0);
+    Progress progress("t-SNE", _options.iterations * _n);
+    for (int iteration = 0; iteration < _options.iterations; iteration++)
+    {
+        bool early = iteration < _options.exaggerationIterations;
+        double momentum = early ? 0.5 : 0.8;
+        bool report = (iteration + 1) % 50 == 0 || iteration + 1 == _options.iterations;
+        double kl = 0;
+        gradient(y, early ? _options.earlyExaggeration : 1.0, grad, report ? &kl : nullptr);
+
+        // gains grow where the gradient keeps its direction against the last update and shrink where it flips
+        double meanX = 0, meanY = 0;
+        for (size_t c = 0; c < 2 * _n; c++)
+        {
+            gains[c] = update[c] * grad[c] < 0 ? gains[c] + 0.2 : std::max(gains[c] * 0.8, 0.01);
+            update[c] = momentum * update[c] - learningRate * gains[c] * grad[c];
+            y[c] += update[c];
+            (c % 2 ? meanY : meanX) += y[c];
+        }
+        // the layout is kept centered, t-SNE is invariant to shifts
+        meanX /= _n;
+        meanY /= _n;
+        for (size_t i = 0; i < _n; i++)
+        {
+            y[2 * i] -= meanX;
+            y[2 * i + 1] -= meanY;
+        }
+        if (report) { _errors.push_back({iteration + 1, kl}); }
+        progress.add(_n);
+    }
+    return y;
+}
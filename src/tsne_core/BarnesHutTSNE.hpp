@@ -0,0 +1,116 @@
+// BarnesHutTSNE.hpp
+#pragma once
+#include "../clustering_core/modules/memoryBudget.hpp"
+#include "../clustering_core/modules/structPoint.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// points per task of the parallel loops; every point is computed on its own, so the result does not depend on it
+const size_t TSNE_BLOCK_SIZE = 256;
+
+struct TSNEOptions
+{
+    double perplexity = 3;             ///< effective number of neighbors, 3 as in reduceDimentions.py
+    int iterations = 1000;
+    double theta = 0.5;                ///< Barnes-Hut accuracy: a cell is summarized if width / distance < theta, 0 is exact
+    double learningRate = 0;           ///< <= 0: max(n / earlyExaggeration / 4, 50), sklearn's "auto"
+    double earlyExaggeration = 12;
+    int exaggerationIterations = 250;  ///< also the iterations with momentum 0.5 instead of 0.8
+    unsigned seed = 42;                ///< of the initial layout and of the HNSW levels
+    int threads = 0;                   ///< <= 0: one per core
+    size_t exactNeighborsBelow = 5000; ///< fewer points: exact neighbors by brute force, otherwise through an HNSWIndex
+    int hnswM = 16;
+    int hnswEf = 64;                   ///< efConstruction of the index and ef of the neighbor queries
+    bool reproducible = true;          ///< builds the HNSW graph on one thread, so the layout does not depend on `threads`
+};
+
+/**
+ * Quadtree over the 2D layout for the repulsive forces. Leaves hold one point, or several at the same place.
+ * Cells keep the center of mass of their points, so a far cell acts as `count` points there.
+ */
+class TSNEQuadTree
+{
+public:
+    void build(const double* y, size_t n);
+    // repulsion of all points, the point itself included, on a point at (x, y): adds q = 1 / (1 + d^2) of every
+    // point to sumQ and q^2 * (x - other) to (forceX, forceY)
+    void repulsion(double x, double y, double theta, double& forceX, double& forceY, double& sumQ) const;
+    size_t cells() const { return _cells.size(); }
+    // the points leaf by leaf, depth first: points close in the layout are close in this order
+    const std::vector<int>& order() const { return _order; }
+
+private:
+    struct Cell
+    {
+        double centerX, centerY, halfWidth;
+        double massX = 0, massY = 0;// sum of the coordinates while building, then the center of mass
+        int count = 0;
+        int firstChild = -1;// the 4 children are consecutive, -1 for a leaf
+        int point = -1;     // first point of a leaf
+    };
+    std::vector<Cell> _cells;// kept between builds, the next layout reuses the capacity
+    std::vector<int> _leafOf;
+    std::vector<int> _order;
+    const double* _y = nullptr;
+    double _minHalfWidth = 0;
+
+    void insert(int point);
+    void split(int cell);
+    int childFor(const Cell& cell, double x, double y) const { return cell.firstChild + (x >= cell.centerX) + 2 * (y >= cell.centerY); }
+    void repulsion(int cell, double x, double y, double theta2, double& forceX, double& forceY, double& sumQ) const;
+};
+
+/**
+ * @class BarnesHutTSNE
+ * @brief t-SNE projection of N-dimensional points to 2D, O(n log n) per iteration.
+ *
+ * The input affinities only use the 3 * perplexity nearest neighbors of every point (exact or HNSW), the
+ * repulsive forces are approximated with a quadtree (Barnes-Hut). The optimization is the one of sklearn's
+ * TSNE(init="random", learning_rate="auto"): early exaggeration, momentum and per-coordinate gains.
+ *
+ * Neighbor search, affinities and the gradient run on `threads` threads. Each point is computed on its own and
+ * the sums over points are taken in index order, so the layout is the same for every thread count, as long as
+ * the neighbors are: exact ones, or an HNSWIndex built on one thread (`reproducible`, the default). Built on
+ * `threads` threads, the graph and so the layout depend on the thread count.
+ */
+class BarnesHutTSNE
+{
+public:
+    explicit BarnesHutTSNE(TSNEOptions options = TSNEOptions()) : _options(options) {}
+
+    // the 2D layout of `points`, in their order
+    std::vector<Point> run(const std::vector<Point>& points);
+
+    // the steps of run, public for the tests
+    void computeAffinities(const std::vector<Point>& points);
+    // gradient of the KL divergence at the layout y (x0, y0, x1, y1, ...), with P multiplied by `exaggeration`;
+    // `kl`, if given, receives the divergence of the layout from the unexaggerated P
+    void gradient(const std::vector<double>& y, double exaggeration, std::vector<double>& grad, double* kl = nullptr);
+    // finds the precision beta of exp(-beta * d) with the given perplexity over `count` squared distances and
+    // writes the normalized probabilities to `probabilities`
+    static double calibrateRow(const double* distances, int count, double perplexity, double* probabilities);
+
+    // symmetric P in compressed rows: the neighbors of i are _columns[_rowStarts[i] .. _rowStarts[i + 1])
+    std::vector<size_t> getRowStarts() const { return _rowStarts; }
+    std::vector<int> getColumns() const { return _columns; }
+    std::vector<double> getAffinities() const { return _affinities; }
+    // (iteration, KL divergence) every 50 iterations and after the last one
+    std::vector<std::pair<int, double>> getErrors() const { return _errors; }
+
+private:
+    TSNEOptions _options;
+    size_t _n = 0;
+    std::vector<size_t> _rowStarts;
+    std::vector<int> _columns;
+    std::vector<double> _affinities;
+    std::vector<std::pair<int, double>> _errors;
+    TSNEQuadTree _tree;// rebuilt for every gradient
+    MemoryReservation _memory;// the affinities, the layout and the optimizer state
+
+    int neighborCount() const { return (int) std::min<size_t>(_n - 1, (size_t) (3 * _options.perplexity + 1)); }
+    void nearestNeighbors(const std::vector<Point>& points, int k, std::vector<int>& neighbors, std::vector<double>& distances) const;
+    void symmetrize(int k, const std::vector<int>& neighbors, const std::vector<double>& conditional);
+    std::vector<double> optimize();
+};
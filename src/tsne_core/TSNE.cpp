@@ -0,0 +1,66 @@
+#include "../clustering_core/modules/ReadData.hpp"
+#include "../clustering_core/modules/progress.hpp"
+#include "../clustering_core/modules/writeData.hpp"
+#include "BarnesHutTSNE.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// usage: TSNE [--quiet] [--memory-budget=MB] [--theta=T] [--parallel-neighbors] [embeddings] [projection] [perplexity] [iterations] [threads] [seed]
+// Writes the 2D t-SNE layout of the embeddings in the order of their rows. A .csv projection has the "x,y" header
+// of reduceDimentions.py, so `CLustering --tsne` and the plots read it as before; .txt and .npy work as well.
+// --parallel-neighbors builds the HNSW graph of large inputs on all threads: faster, but the layout then depends
+// on the thread count.
+int main(int argc, char* argv[])
+{
+    TSNEOptions options;
+    bool quiet = false;
+    int first = 1;
+    for (; first < argc && std::string(argv[first]).rfind("--", 0) == 0; first++)
+    {
+        std::string flag = argv[first];
+        if (flag == "--quiet")
+        {
+            quiet = true;
+            Progress::setEnabled(false);
+        }
+        else if (flag.rfind("--memory-budget=", 0) == 0) { MemoryBudget::setLimit((size_t) (std::stod(flag.substr(16)) * (1 << 20))); }
+        else if (flag.rfind("--theta=", 0) == 0) { options.theta = std::stod(flag.substr(8)); }
+        else if (flag == "--parallel-neighbors") { options.reproducible = false; }
+        else
+        {
+            std::cout << "Unknown option " << flag << std::endl;
+            exit(1);
+        }
+    }
+    std::string embPath = argc > first ? argv[first] : "../../data/big_data/embeddings.npy";
+    std::string projectionPath = argc > first + 1 ? argv[first + 1] : "../../data/big_data/t-SNE_projected.csv";
+    if (argc > first + 2) { options.perplexity = std::stod(argv[first + 2]); }
+    if (argc > first + 3) { options.iterations = std::stoi(argv[first + 3]); }
+    if (argc > first + 4) { options.threads = std::stoi(argv[first + 4]); }
+    if (argc > first + 5) { options.seed = (unsigned) std::stoul(argv[first + 5]); }
+
+    std::vector<Point> points = read_data(embPath);
+    std::cout << "Read " << points.size() << " points of dimension " << (points.empty() ? 0 : points[0].coords.size()) << std::endl;
+
+    if (!options.reproducible && options.threads != 1 && points.size() >= options.exactNeighborsBelow)
+    {
+        std::cout << "Note: the HNSW graph is built on several threads, the layout depends on the thread count" << std::endl;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    BarnesHutTSNE tsne(options);
+    std::vector<Point> layout = tsne.run(points);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!quiet)
+    {
+        for (const auto& error: tsne.getErrors()) { std::cout << "iteration " << error.first << ": KL divergence " << error.second << std::endl; }
+    }
+    std::cout << "t-SNE done in " << seconds << " s" << std::endl;
+
+    save_points(projectionPath, layout);
+    std::cout << "saved to " << projectionPath << std::endl;
+    if (!quiet) { std::cout << "Memory per stage:" << std::endl << memoryReport(); }
+    return 0;
+}
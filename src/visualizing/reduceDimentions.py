@@ -1,3 +1,5 @@
+# The TSNE tool (src/tsne_core, documentation/TSNE.md) computes the same projection natively and writes the same
+# t-SNE_projected.csv; this script is kept for comparison.
 from sklearn.manifold import TSNE  # for t-SNE
 import pandas as pd
 import numpy as np